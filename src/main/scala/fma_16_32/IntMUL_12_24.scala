@@ -18,6 +18,8 @@ class IntMUL_12_24 extends Module {
     val is_16 = Input(Bool())
     val valid_out = Output(Bool())
     val res_out = Output(UInt(48.W))
+    // Carry-save pipeline registers (debugMode only, for switching-activity probes)
+    val dbg_wallace = Option.when(debugMode)(Output(Vec(2, UInt(48.W))))
   })
 
   val vs2 = io.a_in
@@ -147,4 +149,5 @@ class IntMUL_12_24 extends Module {
 
   io.valid_out := RegNext(io.valid_in, init = false.B)
   io.res_out := Cat(highSum24, lowSum25(23, 0))
+  io.dbg_wallace.foreach(_ := VecInit(wallaceOutReg))
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+package race.vpu.exu.laneexu.fp
+
+import chisel3._
+import chisel3.util._
+import race.vpu._
+import VParams._
+
+/**
+  * Ready/valid variant of VFMA_16_32.
+  *   The pipeline itself cannot stall: every stage register advances on its own valid.
+  *   The variant keeps the pipeline as it is and adds backpressure around it:
+  *   - results are written to a skid queue, and in.ready is given by credits (ops in flight +
+  *     queued results must fit in the queue), so nothing is dropped while out.ready is low
+  *   - out is a PipeConnect stage; flush empties it, the queue and the ops still in flight
+  *   - S2/S3 sample the mode ports one and two cycles after issue, so an op whose mode differs
+  *     from an op still in S1/S2 is held back, and the mode ports keep the last issued mode while idle
+  */
+class VFMAReq extends Bundle {
+  val is_bf16, is_fp16, is_fp32 = Bool()
+  val is_widen = Bool()
+  val a_in, b_in, c_in = UInt(32.W)  // VFMA_16_32 core inputs (two 16-bit operands packed as high, low)
+}
+
+/**
+  * Skid queue and issue credits behind a fixed-latency pipeline.
+  *   `latency + 2` entries sustain one op per cycle while out.ready is high:
+  *   `latency` ops in flight, one result queued and one being dequeued.
+  */
+class FixedLatencySkid[T <: Data](gen: T, val latency: Int) extends Module {
+  val entries = latency + 2
+  val io = IO(new Bundle {
+    val issue = Input(Bool())      // an op enters the pipeline this cycle
+    val can_issue = Output(Bool())
+    val result = Input(gen)        // pipeline output, `latency` cycles after issue
+    val out = DecoupledIO(gen)
+    val flush = Input(Bool())
+  })
+
+  // ops issued before a flush still come out of the pipeline, live marks the ones to keep
+  val live = RegInit(VecInit(Seq.fill(latency)(false.B)))
+  live(0) := io.issue && !io.flush
+  for (i <- 1 until latency) {
+    live(i) := live(i - 1) && !io.flush
+  }
+
+  val queue = Module(new Queue(gen, entries, hasFlush = true))
+  queue.io.enq.valid := live(latency - 1) && !io.flush
+  queue.io.enq.bits := io.result
+  queue.io.flush.get := io.flush
+  assert(!queue.io.enq.valid || queue.io.enq.ready, "FixedLatencySkid: result arrived with the queue full")
+
+  io.can_issue := (PopCount(live) +& queue.io.count) < entries.U && !io.flush
+  PipeConnect(queue.io.deq, io.out, io.flush)
+}
+
+class VFMA_16_32_Decoupled extends Module {
+  val io = IO(new Bundle {
+    val in = Flipped(DecoupledIO(new VFMAReq))
+    val out = DecoupledIO(UInt(32.W))
+    val flush = Input(Bool())
+  })
+
+  val fma = Module(new VFMA_16_32)
+  val skid = Module(new FixedLatencySkid(UInt(32.W), latency = fmaDelay - delayBias))
+
+  val req = io.in.bits
+  val mode_in = Cat(req.is_bf16, req.is_fp16, req.is_fp32, req.is_widen)
+  val mode_q = RegEnable(mode_in, 0.U, io.in.fire)  // mode of the last issued op
+  val mode_hazard = (fma.io.valid_S1 || fma.io.valid_S2) && mode_in =/= mode_q
+  io.in.ready := skid.io.can_issue && !mode_hazard
+
+  val mode = Mux(io.in.fire, mode_in, mode_q)
+  fma.io.valid_in := io.in.fire
+  fma.io.is_bf16 := mode(3)
+  fma.io.is_fp16 := mode(2)
+  fma.io.is_fp32 := mode(1)
+  fma.io.is_widen := mode(0)
+  fma.io.a_in := req.a_in
+  fma.io.b_in := req.b_in
+  fma.io.c_in := req.c_in
+
+  skid.io.issue := io.in.fire
+  skid.io.result := fma.io.res_out
+  skid.io.flush := io.flush
+  io.out <> skid.io.out
+}
@@ -50,12 +50,11 @@ class VFMAWrapper extends Module {
   //  ----   ----   ----   ----
   //   16     16     16     16
   def widen_sel(vs: UInt): UInt = {  // vs is 64 bits
-    val (fma1_high, fma1_low, fma0_high, fma0_low) = (vs(63, 48), vs(47, 32), vs(31, 16), vs(15, 0))
+    val (fma1_low, fma0_low) = (vs(47, 32), vs(15, 0))
     val vs_32b = Mux(uop.uopIdx(0), vs(63, 32), vs(31, 0))
-    when (uop.ctrl.widen) {
-      fma0_high := vs_32b(15, 0)
-      fma1_high := vs_32b(31, 16)
-    }
+    // Bit slices are read-only, so select the high halves instead of assigning them
+    val fma0_high = Mux(uop.ctrl.widen, vs_32b(15, 0), vs(31, 16))
+    val fma1_high = Mux(uop.ctrl.widen, vs_32b(31, 16), vs(63, 48))
     Cat(fma1_high, fma1_low, fma0_high, fma0_low)
   }
   
@@ -24,6 +24,29 @@ import race.vpu._
 import VParams._
 import race.vpu.yunsuan.util._
 
+/**
+  * Stage probes (debugMode only): selected pipeline registers of VFMA_16_32,
+  *   exported so the testbench can localize a wrong result to S1/S2/S3 without waveforms
+  */
+class VFMAStageProbes(wResMul32: Int) extends Bundle {
+  // S1: integer multiplier result, exponent of a*b
+  val res_intMul_S1 = UInt(48.W)
+  val exp_res_adjsubn_low_S1, exp_res_adjsubn_high_S1 = UInt(10.W)
+  // S2: significand/exponent of a*b after (partial) normalization
+  val sig_resMul_low_S2 = UInt((wResMul32/2).W)
+  val sig_resMul_whole_S2 = UInt(wResMul32.W)
+  val exp_resMul_low_S2, exp_resMul_high_S2 = UInt(8.W)
+  // S3: adder output before normalization and rounding
+  val adderOut_low_S3, adderOut_high_S3 = UInt((wResMul32/2).W)
+  val adderOut_sign_low_S3, adderOut_sign_high_S3 = Bool()
+  val exp_adderOut_low_S3, exp_adderOut_high_S3 = UInt(8.W)
+  // Switching activity only (not compared with the stage model): multiplier operands,
+  //   carry-save registers of IntMUL_12_24 and the c_in pipeline registers
+  val mul_a_in, mul_b_in = UInt(24.W)
+  val mul_sum_S1, mul_carry_S1 = UInt(48.W)
+  val c_in_S1, c_in_S2, c_in_S3 = UInt(32.W)
+}
+
 class VFMA_16_32 extends Module {
   val wResMul32 = 48  // Bits to reserve for the significand of the a*b (range: 28 ~ 48)
   val wResMul16 = wResMul32 / 2  // Bits (FP/BF16) to reserve for the significand of the a*b
@@ -39,6 +62,7 @@ class VFMA_16_32 extends Module {
     val res_out = Output(UInt(32.W))
     val valid_out = Output(Bool())
     val valid_S1, valid_S2 = Output(Bool())
+    val dbg = Option.when(debugMode)(Output(new VFMAStageProbes(wResMul32)))
   })
 
   val (is_bf16, is_fp16, is_fp32) = (io.is_bf16, io.is_fp16, io.is_fp32)
@@ -752,6 +776,29 @@ class VFMA_16_32 extends Module {
   io.valid_S1 := valid_S1
   io.valid_S2 := valid_S2
 
+  io.dbg.foreach { dbg =>
+    dbg.res_intMul_S1 := res_intMul_S1
+    dbg.exp_res_adjsubn_low_S1 := exp_res_adjsubn_low_S1
+    dbg.exp_res_adjsubn_high_S1 := exp_res_adjsubn_high_S1
+    dbg.sig_resMul_low_S2 := sig_resMul_low_S2
+    dbg.sig_resMul_whole_S2 := sig_resMul_whole_S2
+    dbg.exp_resMul_low_S2 := exp_resMul_low_S2
+    dbg.exp_resMul_high_S2 := exp_resMul_high_S2
+    dbg.adderOut_low_S3 := adderOut_low_S3
+    dbg.adderOut_high_S3 := adderOut_high_S3
+    dbg.adderOut_sign_low_S3 := adderOut_sign_low_S3
+    dbg.adderOut_sign_high_S3 := adderOut_sign_high_S3
+    dbg.exp_adderOut_low_S3 := exp_adderOut_low
+    dbg.exp_adderOut_high_S3 := exp_adderOut_high
+    dbg.mul_a_in := intMul_12_24.io.a_in
+    dbg.mul_b_in := intMul_12_24.io.b_in
+    dbg.mul_sum_S1 := intMul_12_24.io.dbg_wallace.get(0)
+    dbg.mul_carry_S1 := intMul_12_24.io.dbg_wallace.get(1)
+    dbg.c_in_S1 := c_in_S1
+    dbg.c_in_S2 := c_in_S2
+    dbg.c_in_S3 := c_in_S3
+  }
+
 
   def shift(data: UInt, shift_amount: UInt, shift_right: Bool): UInt = {
     // Reverse the data when shifting left
@@ -6,8 +6,10 @@ import scala.collection.mutable.ListBuffer
 import Vreduction.Params._
 
 object Params {
-    val VLEN = 512
+    // Reduction width; elaboration can override it with the vred.vlen system property (topReduMain --vlen=N)
+    val VLEN = sys.props.get("vred.vlen").map(_.toInt).getOrElse(512)
     val XLEN = 32
+    require(VLEN >= 128 && (VLEN & (VLEN - 1)) == 0, s"Vreduction VLEN must be a power of 2 >= 128, got $VLEN")
 }
 
 class VredInput extends Bundle {
@@ -0,0 +1,29 @@
+// src/main/scala/top_decoupled.scala
+package topdecoupled
+
+import chisel3._
+import chisel3.util._
+import chisel3.stage._
+import race.vpu.exu.laneexu.fp._
+
+/**
+  * VFMA_16_32_Decoupled with its ready/valid ports exposed for the backpressure harness.
+  *   in.bits are the VFMA_16_32 core inputs (see top_wide.scala for the packing),
+  *   out.bits is res_out. flush drops every op that has not left through out yet.
+  */
+class topDecoupled extends Module {
+  val io = IO(new Bundle {
+    val in = Flipped(DecoupledIO(new VFMAReq))
+    val out = DecoupledIO(UInt(32.W))
+    val flush = Input(Bool())
+  })
+
+  val fma = Module(new VFMA_16_32_Decoupled)
+  fma.io.in <> io.in
+  io.out <> fma.io.out
+  fma.io.flush := io.flush
+}
+
+object topDecoupledMain extends App {
+  (new ChiselStage).emitVerilog(new topDecoupled, args)
+}
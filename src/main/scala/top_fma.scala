@@ -8,6 +8,20 @@ import race.vpu._
 import race.vpu.VParams._
 import race.vpu.exu.laneexu.fp._
 
+/**
+  * Occupancy counters (debugMode only): cycles each VFMA_16_32 stage holds a valid op and
+  *   issued ops per mode, sampled from valid_in/valid_S1/valid_S2/valid_out.
+  *   Each count is a plain register: it covers the clock edges taken so far outside reset, not the
+  *   cycle in progress, so a snapshot read right before reset holds everything reset will clear
+  */
+class VFMAPerfCounters extends Bundle {
+  val cycles = UInt(64.W)
+  val active = UInt(64.W)  // cycles with at least one stage valid
+  val busy_S1, busy_S2, busy_S3 = UInt(64.W)
+  // fp16/bf16 (non-widen) use both 16-bit halves, widen only the high half
+  val issue_fp32, issue_fp16, issue_bf16, issue_widen = UInt(64.W)
+}
+
 class top extends Module{
   val io = IO(new Bundle {
     val valid_in = Input(Bool())
@@ -45,8 +59,36 @@ class top extends Module{
   io.res_out_32 := fma.io.res_out
   io.res_out_16 := VecInit(fma.io.res_out(15, 0), fma.io.res_out(31, 16))
   io.valid_out := fma.io.valid_out
+
+  // Stage probes for the testbench (ports dbg_*, only when debugMode)
+  val dbg = fma.io.dbg.map(d => IO(Output(chiselTypeOf(d))).suggestName("dbg"))
+  dbg.zip(fma.io.dbg).foreach { case (out, d) => out := d }
+
+  // Occupancy counters for the testbench (ports perf_*, only when debugMode)
+  val perf = Option.when(debugMode)(IO(Output(new VFMAPerfCounters)).suggestName("perf"))
+  perf.foreach { p =>
+    def count(cond: Bool): UInt = {
+      val cnt = RegInit(0.U(64.W))
+      when(cond) { cnt := cnt + 1.U }
+      cnt
+    }
+    val (valid_S1, valid_S2, valid_S3) = (fma.io.valid_S1, fma.io.valid_S2, fma.io.valid_out)
+    p.cycles := count(true.B)
+    p.active := count(valid_S1 || valid_S2 || valid_S3)
+    p.busy_S1 := count(valid_S1)
+    p.busy_S2 := count(valid_S2)
+    p.busy_S3 := count(valid_S3)
+    p.issue_fp32 := count(io.valid_in && io.is_fp32)
+    p.issue_fp16 := count(io.valid_in && io.is_fp16 && !io.is_widen)
+    p.issue_bf16 := count(io.valid_in && io.is_bf16 && !io.is_widen)
+    p.issue_widen := count(io.valid_in && io.is_widen)
+  }
 }
 
 object topMain extends App {
-  (new ChiselStage).emitVerilog(new top, args)
+  // --split is consumed here: one <Module>.v per module in the target dir instead of one
+  // file for the design (hierarchical build, make hier). The rest goes to ChiselStage
+  val (splitArgs, stageArgs) = args.partition(_ == "--split")
+  if (splitArgs.isEmpty) (new ChiselStage).emitVerilog(new top, stageArgs)
+  else (new ChiselStage).execute(Array("-e", "verilog") ++ stageArgs, Seq(ChiselGeneratorAnnotation(() => new top)))
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+// src/main/scala/top_kernel.scala
+package topkernel
+
+import chisel3._
+import chisel3.util._
+import chisel3.stage._
+import race.vpu._
+import race.vpu.exu.laneexu.fp._
+import Vreduction.{Vfreduction, VfaddOpCode}
+
+/**
+  * Kernel-level test top: NLanes VFMAWrapper lanes (one VLEN-wide FMA uop per cycle)
+  * next to one Vfreduction (Vreduction.Params.VLEN wide). There is no register file here,
+  * the testbench models it and hands vd from the FMA lanes to the reduction unit.
+  *   fma_*: the vector FMA uop, only the VUop fields VFMAWrapper looks at are exposed
+  *   red_*: same as topRedu, with vs2/mask flattened
+  */
+class topKernel extends Module {
+  val VLEN = VParams.VLEN
+  val LaneWidth = VParams.LaneWidth
+  val NLanes = VParams.NLanes
+  val RedVLEN = Vreduction.Params.VLEN
+  val RedXLEN = Vreduction.Params.XLEN
+
+  val io = IO(new Bundle {
+    val fma_valid_in = Input(Bool())
+    val fma_sew_oh = Input(UInt(4.W))   // SewFpOH: bf16, fp16, fp32, fp64
+    val fma_funct6 = Input(UInt(6.W))
+    val fma_funct3 = Input(UInt(3.W))   // OPFVV / OPFVF
+    val fma_widen = Input(Bool())
+    val fma_vd_val = Input(Bool())      // lsrcVal(2): c comes from vd/vs2 (0: vfmul)
+    val fma_uop_idx = Input(UInt(3.W))
+    val fma_vs1 = Input(UInt(VLEN.W))
+    val fma_vs2 = Input(UInt(VLEN.W))
+    val fma_vs3 = Input(UInt(VLEN.W))   // old vd
+    val fma_rs1 = Input(UInt(VParams.xLen.W))
+    val fma_vd = Output(UInt(VLEN.W))
+    val fma_valid_out = Output(Bool())
+
+    val red_fire = Input(Bool())
+    val red_is_vfredsum = Input(Bool())
+    val red_index = Input(UInt(3.W))
+    val red_vlmul = Input(UInt(3.W))
+    val red_mask = Input(UInt(RedVLEN.W))
+    val red_round_mode = Input(UInt(3.W))
+    val red_fp_format = Input(UInt(2.W))
+    val red_is_vec = Input(Bool())
+    val red_vs2 = Input(UInt(RedVLEN.W))
+    val red_vs1 = Input(UInt(RedXLEN.W))
+    val red_vd = Output(UInt(RedXLEN.W))
+    val red_fflags = Output(UInt(5.W))
+    val red_finish = Output(Bool())
+  })
+
+  // FMA lanes: lane k works on bits (64k+63, 64k) of the vector operands
+  val uop = WireDefault(0.U.asTypeOf(new VUop))
+  uop.ctrl.funct6 := io.fma_funct6
+  uop.ctrl.funct3 := io.fma_funct3
+  uop.ctrl.widen := io.fma_widen
+  uop.ctrl.lsrcVal(2) := io.fma_vd_val
+  uop.uopIdx := io.fma_uop_idx
+
+  val sewIn = Wire(new SewFpOH)
+  sewIn.oneHot := io.fma_sew_oh
+
+  val lanes = Seq.fill(NLanes)(Module(new VFMAWrapper))
+  for ((lane, k) <- lanes.zipWithIndex) {
+    lane.io.in.valid := io.fma_valid_in
+    lane.io.in.bits.uop := uop
+    lane.io.in.bits.vs1 := io.fma_vs1(LaneWidth*k + LaneWidth-1, LaneWidth*k)
+    lane.io.in.bits.vs2 := io.fma_vs2(LaneWidth*k + LaneWidth-1, LaneWidth*k)
+    lane.io.in.bits.vs3 := io.fma_vs3(LaneWidth*k + LaneWidth-1, LaneWidth*k)
+    lane.io.in.bits.rs1 := io.fma_rs1
+    lane.io.sewIn := sewIn
+  }
+  io.fma_vd := Cat(lanes.reverse.map(_.io.out.bits.vd))
+  io.fma_valid_out := lanes.head.io.out.valid
+
+  // Reduction unit
+  val vfred = Module(new Vfreduction)
+  vfred.io.fire := io.red_fire
+  vfred.io.in.vlmul := io.red_vlmul
+  vfred.io.in.mask := io.red_mask
+  vfred.io.in.round_mode := io.red_round_mode
+  vfred.io.in.fp_format := io.red_fp_format
+  vfred.io.in.op_code := Mux(io.red_is_vfredsum, VfaddOpCode.fadd, VfaddOpCode.fmax)
+  vfred.io.in.is_vec := io.red_is_vec
+  vfred.io.in.index := io.red_index
+  vfred.io.in.vs1 := io.red_vs1
+  vfred.io.in.vs2 := io.red_vs2
+
+  io.red_vd := vfred.io.out.result
+  io.red_fflags := vfred.io.out.fflags
+  io.red_finish := vfred.io.finish
+}
+
+object topKernelMain extends App {
+  (new ChiselStage).emitVerilog(new topKernel, args)
+}
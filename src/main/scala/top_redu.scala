@@ -14,12 +14,12 @@ class topRedu extends Module{
     val index         = Input(UInt(3.W))  
     val is_vfredmax   = Input(Bool())
     val vlmul         = Input(UInt(3.W))
-    val mask          = Input(Vec(VLEN/XLEN, UInt(XLEN.W)))
+    val mask          = Input(UInt(VLEN.W))
     val round_mode    = Input(UInt(3.W))
     val fp_format     = Input(UInt(2.W))
     val is_vec        = Input(Bool())
-    val vs2           = Input(Vec(VLEN/XLEN, UInt(XLEN.W)))
-    val vs1           = Input(Vec(VLEN/XLEN, UInt(XLEN.W)))
+    val vs2           = Input(UInt(VLEN.W))   // flattened, so the port names do not depend on VLEN
+    val vs1           = Input(UInt(XLEN.W))
     
     val vd            = Output(UInt(XLEN.W))
     val fflags        = Output(UInt(5.W))
@@ -31,14 +31,14 @@ class topRedu extends Module{
   val vfred = Module(new Vfreduction)
   vfred.io.fire      := io.fire      
   vfred.io.in.vlmul     := io.vlmul     
-  vfred.io.in.mask      := io.mask.asTypeOf(vfred.io.in.mask)      
+  vfred.io.in.mask      := io.mask
   vfred.io.in.round_mode:= io.round_mode
   vfred.io.in.fp_format := io.fp_format 
   vfred.io.in.op_code   := opcode   
   vfred.io.in.is_vec    := io.is_vec    
   vfred.io.in.index     := io.index     
-  vfred.io.in.vs1       := io.vs1(0)  
-  vfred.io.in.vs2       := io.vs2.asTypeOf(vfred.io.in.vs2)
+  vfred.io.in.vs1       := io.vs1
+  vfred.io.in.vs2       := io.vs2
 
   io.vd := vfred.io.out.result.asTypeOf(io.vd)
   io.fflags := vfred.io.out.fflags     
@@ -46,5 +46,8 @@ class topRedu extends Module{
 }
 
 object topReduMain extends App {
-  (new ChiselStage).emitVerilog(new topRedu, args)
+  // --vlen=N selects Vreduction.Params.VLEN (default 512), the rest goes to ChiselStage
+  val (vlenArgs, stageArgs) = args.partition(_.startsWith("--vlen="))
+  vlenArgs.lastOption.foreach(a => sys.props("vred.vlen") = a.stripPrefix("--vlen="))
+  (new ChiselStage).emitVerilog(new topRedu, stageArgs)
 }
\ No newline at end of file
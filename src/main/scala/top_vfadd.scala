@@ -0,0 +1,72 @@
+// src/main/scala/top_vfadd.scala
+package topvfadd
+
+import chisel3._
+import chisel3.util._
+import chisel3.stage._
+import Vreduction._
+
+/**
+  * One 64-bit lane of the vector FP adder (VectorFloatAdder_Width64).
+  *   fp_format: 0 bf16 (4 elements), 1 fp16 (4 elements), 2 fp32 (2 elements)
+  *   vs2 -> fp_a, vs1 -> fp_b; frs1 replaces every element of vs1 when is_frs1
+  *   Widening (fp16 -> fp32, fp_format = 2): res_widening, plus opb_widening for .wv;
+  *   uop_idx selects elements 0/1 or 2/3 of the fp16 source.
+  * VectorExuFloatAdder is XLEN (32) wide and only reaches half of the lane, so the
+  * lane is instantiated directly. Reduction inputs (maskForReduction, fold) are tied off.
+  * Latency is 1: result/fflags are valid the cycle after fire.
+  */
+class topVfadd extends Module {
+  val io = IO(new Bundle {
+    val fire         = Input(Bool())
+    val vs1, vs2     = Input(UInt(64.W))
+    val frs1         = Input(UInt(64.W))
+    val is_frs1      = Input(Bool())
+    val mask         = Input(UInt(4.W))
+    val uop_idx      = Input(Bool())
+    val is_vec       = Input(Bool())
+    val round_mode   = Input(UInt(3.W))
+    val fp_format    = Input(UInt(2.W))
+    val opb_widening = Input(Bool())
+    val res_widening = Input(Bool())
+    val op_code      = Input(UInt(5.W))
+
+    val result       = Output(UInt(64.W))
+    val fflags       = Output(UInt(20.W))
+    val valid_out    = Output(Bool())
+  })
+
+  val vfa = Module(new VectorFloatAdder_Width64)
+  vfa.io.fire         := io.fire
+  vfa.io.fp_a         := io.vs2
+  vfa.io.fp_b         := io.vs1
+  vfa.io.widen_a      := io.vs2
+  vfa.io.widen_b      := io.vs1
+  vfa.io.frs1         := io.frs1
+  vfa.io.is_frs1      := io.is_frs1
+  vfa.io.mask         := io.mask
+  vfa.io.uop_idx      := io.uop_idx
+  vfa.io.is_vec       := io.is_vec
+  vfa.io.round_mode   := io.round_mode
+  vfa.io.fp_format    := io.fp_format
+  vfa.io.opb_widening := io.opb_widening
+  vfa.io.res_widening := io.res_widening
+  vfa.io.op_code      := io.op_code
+  vfa.io.fp_aIsFpCanonicalNAN := false.B
+  vfa.io.fp_bIsFpCanonicalNAN := false.B
+  vfa.io.maskForReduction := Fill(8, 1.U(1.W))
+  vfa.io.is_vfwredosum := false.B
+  vfa.io.is_fold      := 0.U
+  vfa.io.vs2_fold     := 0.U
+
+  io.result    := vfa.io.fp_result
+  io.fflags    := vfa.io.fflags
+  io.valid_out := RegNext(io.fire, false.B)
+}
+
+object topVfaddMain extends App {
+  // --split: one <Module>.v per module, as in topMain (make hier_vfadd)
+  val (splitArgs, stageArgs) = args.partition(_ == "--split")
+  if (splitArgs.isEmpty) (new ChiselStage).emitVerilog(new topVfadd, stageArgs)
+  else (new ChiselStage).execute(Array("-e", "verilog") ++ stageArgs, Seq(ChiselGeneratorAnnotation(() => new topVfadd)))
+}
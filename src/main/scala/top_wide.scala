@@ -0,0 +1,51 @@
+// src/main/scala/top_wide.scala
+package topwide
+
+import chisel3._
+import chisel3.util._
+import chisel3.stage._
+import race.vpu.exu.laneexu.fp._
+
+/**
+  * N independent VFMA_16_32 lanes behind flattened ports, so that one eval() of the
+  * Verilated model retires up to N operations per clock edge.
+  *   Lane k uses bit k of the 1-bit signals and bits (32k+31, 32k) of the 32-bit signals.
+  *   a/b/c are the VFMA_16_32 core inputs: fp32, or two bf/fp16 packed as (high, low);
+  *   for widen, a/b hold the 16-bit operand in the high half and c is fp32.
+  */
+class topWide(val nLanes: Int) extends Module {
+  val io = IO(new Bundle {
+    val valid_in = Input(UInt(nLanes.W))
+    val is_bf16, is_fp16, is_fp32 = Input(UInt(nLanes.W))
+    val is_widen = Input(UInt(nLanes.W))
+    val a_in = Input(UInt((32 * nLanes).W))
+    val b_in = Input(UInt((32 * nLanes).W))
+    val c_in = Input(UInt((32 * nLanes).W))
+
+    val res_out = Output(UInt((32 * nLanes).W))
+    val valid_out = Output(UInt(nLanes.W))
+  })
+
+  val fma = Seq.fill(nLanes)(Module(new VFMA_16_32))
+  for (k <- 0 until nLanes) {
+    fma(k).io.valid_in := io.valid_in(k)
+    fma(k).io.is_bf16 := io.is_bf16(k)
+    fma(k).io.is_fp16 := io.is_fp16(k)
+    fma(k).io.is_fp32 := io.is_fp32(k)
+    fma(k).io.is_widen := io.is_widen(k)
+    fma(k).io.a_in := io.a_in(32*k+31, 32*k)
+    fma(k).io.b_in := io.b_in(32*k+31, 32*k)
+    fma(k).io.c_in := io.c_in(32*k+31, 32*k)
+  }
+
+  io.res_out := Cat(fma.reverse.map(_.io.res_out))
+  io.valid_out := Cat(fma.reverse.map(_.io.valid_out))
+}
+
+object topWideMain extends App {
+  // --lanes=N (default 8) is consumed here, the rest goes to ChiselStage
+  val (laneArgs, stageArgs) = args.partition(_.startsWith("--lanes="))
+  val nLanes = laneArgs.lastOption.map(_.stripPrefix("--lanes=").toInt).getOrElse(8)
+  require(Seq(4, 8, 16).contains(nLanes), s"topWide supports 4/8/16 lanes, got $nLanes")
+  (new ChiselStage).emitVerilog(new topWide(nLanes), stageArgs)
+}
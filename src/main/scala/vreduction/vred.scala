@@ -34,6 +34,7 @@ class Vfreduction extends Module{
 
   // if input is 16bits, calculate the result in 32bits(fp19 inside)
   val fp19tofp32_res = Wire(Vec(VLEN/32, UInt(32.W)))
+  val fp19_fflags    = Wire(Vec(VLEN/32, UInt(5.W)))
 
   for (i <- 0 until (VLEN / 32)) {
       val fp_a = io.in.vs2(16-1+i*32, 0+i*32)
@@ -50,8 +51,20 @@ class Vfreduction extends Module{
       vfadd_fp16mixedbf16.io.fp_aIsFpCanonicalNAN := 0.U
       vfadd_fp16mixedbf16.io.fp_bIsFpCanonicalNAN := 0.U
       fp19tofp32_res(i) := vfadd_fp16mixedbf16.io.fp_result
+      fp19_fflags(i)    := vfadd_fp16mixedbf16.io.fflags(4, 0)
   }
 
+  // the scalar operand of a 16-bit reduction is widened to fp32 here, the whole tree works in fp32
+  val vs1_fp16_to_fp32 = Module(new FloatAdderRandomWidenFormat(
+    src_exponentWidth = 5,
+    src_significandWidth = 11,
+    dst_exponentWidth = 8,
+    dst_significandWidth = 24
+  ))
+  vs1_fp16_to_fp32.io.widen_src := io.in.vs1(15, 0)
+  val vs1_fp32 = Mux(is_fp16, vs1_fp16_to_fp32.io.widen_dst,
+                   Mux(is_bf16, Cat(io.in.vs1(15, 0), 0.U(16.W)), io.in.vs1))
+
   val vctrl_input = Wire(new Vfredctrl)
   vctrl_input.fire      := io.fire      
   vctrl_input.vlmul     := io.in.vlmul     
@@ -61,7 +74,7 @@ class Vfreduction extends Module{
   vctrl_input.op_code   := io.in.op_code   
   vctrl_input.is_vec    := io.in.is_vec    
   vctrl_input.index     := io.in.index     
-  vctrl_input.vs1       := io.in.vs1       
+  vctrl_input.vs1       := vs1_fp32
 
   val vctrl_fp19 = RegNext(RegNext(Mux(io.fire && (is_fp16 || is_bf16), vctrl_input, 0.U.asTypeOf(new Vfredctrl))))
 
@@ -73,15 +86,21 @@ class Vfreduction extends Module{
   }
 
 
+  // a 16-bit uop enters the fp32 tree two cycles after fire, with the fp19 pair sums;
+  // an fp32 uop fired in that same cycle would collide with it, so the issuer must not do that
+  val fire_fp19 = RegNext(RegNext(io.fire && (is_fp16 || is_bf16), false.B), false.B)
+
   for (i <- 0 until stages) {
     if (i == 0) {
-      vredu_pipes(i).io.vctrl_pipe_in.valid     := Mux(is_fp32, io.fire, RegNext(RegNext((io.fire && (is_fp16 || is_bf16)))))
-      vredu_pipes(i).io.vctrl_pipe_in.bits      := Mux(is_fp32, vctrl_input, vctrl_fp19)
-      vredu_pipes(i).io.vd_pipe_in              := io.in.vs2
+      vredu_pipes(i).io.vctrl_pipe_in.valid     := fire_fp19 || (io.fire && is_fp32)
+      vredu_pipes(i).io.vctrl_pipe_in.bits      := Mux(fire_fp19, vctrl_fp19, vctrl_input)
+      vredu_pipes(i).io.vd_pipe_in              := Mux(fire_fp19, fp19tofp32_res.asUInt, io.in.vs2)
+      vredu_pipes(i).io.fflags_pipe_in          := Mux(fire_fp19, fp19_fflags.reduce(_ | _), 0.U)
     } else {
       vredu_pipes(i).io.vctrl_pipe_in.bits      := vredu_pipes(i - 1).io.vctrl_pipe_out.bits
       vredu_pipes(i).io.vctrl_pipe_in.valid     := vredu_pipes(i - 1).io.vctrl_pipe_out.valid
       vredu_pipes(i).io.vd_pipe_in              := vredu_pipes(i - 1).io.vd_pipe_out
+      vredu_pipes(i).io.fflags_pipe_in          := vredu_pipes(i - 1).io.fflags_pipe_out
     }
   }
 
@@ -89,24 +108,31 @@ class Vfreduction extends Module{
   // with one reg for accumulating the result
   val vctrl_pipe_last_stage   = vredu_pipes(stages-1).io.vctrl_pipe_out
   val vd_pipe_last_stage      = vredu_pipes(stages-1).io.vd_pipe_out
+  val fflags_pipe_last_stage  = vredu_pipes(stages-1).io.fflags_pipe_out
 
   val vfred_pipe_fp32       = Module(new VfredFP32_Pipelined(num = 1))
   val vfred_fp32_result     = vfred_pipe_fp32.io.vd_pipe_out
-  // val fp32_fflags = vfred_pipe_fp32.io.fflags
-  val fp32_fflags = 0.U(5.W)
+  val vfred_fp32_fflags     = vfred_pipe_fp32.io.fflags_pipe_out
 
   val reg_res1 = vfred_fp32_result
   val reg_res2 = RegEnable(vfred_fp32_result, vfred_pipe_fp32.io.vctrl_pipe_out.bits.index(0) === 0.U(1.W))
+  val reg_fflags2 = RegEnable(vfred_fp32_fflags, vfred_pipe_fp32.io.vctrl_pipe_out.bits.index(0) === 0.U(1.W))
 
-  val vs1 = Mux(vctrl_pipe_last_stage.bits.fp_format === "b01".U, Cat(Fill(16, 0.U), vctrl_pipe_last_stage.bits.vs1(15, 0)), 
-                            Mux(vctrl_pipe_last_stage.bits.fp_format === "b10".U, vctrl_pipe_last_stage.bits.vs1(31, 0), 0.U(32.W)))
+  // vs1 is already in fp32 (widened at the input for 16-bit uops)
+  val vs1 = vctrl_pipe_last_stage.bits.vs1
+  
+  // uop 1 starts the odd chain from the identity of the operation (-0.0 for sum, -inf for max)
+  val chain_identity = Mux(vctrl_pipe_last_stage.bits.op_code === VfaddOpCode.fmax, "hff800000".U(32.W), "h80000000".U(32.W))
   
   val fp32_fp_a   = vd_pipe_last_stage
   val fp32_fp_b   = Mux(vctrl_pipe_last_stage.bits.index === 0.U, vs1, 
-                      Mux(vctrl_pipe_last_stage.bits.index === "b001".U, 0.U(32.W), vfred_fp32_result))
+                      Mux(vctrl_pipe_last_stage.bits.index === "b001".U, chain_identity, vfred_fp32_result))
+  // the flags follow the data: uops 2.. accumulate onto the chain result of uop index-2
+  val fp32_fflags_b = Mux(vctrl_pipe_last_stage.bits.index(2, 1) === 0.U, 0.U, vfred_fp32_fflags)
           
   vfred_pipe_fp32.io.vctrl_pipe_in        := vctrl_pipe_last_stage
   vfred_pipe_fp32.io.vd_pipe_in           := Cat(fp32_fp_a, fp32_fp_b)
+  vfred_pipe_fp32.io.fflags_pipe_in       := fflags_pipe_last_stage | fp32_fflags_b
   
   val vlmul_pipe_fp32_cvt = MuxLookup(vfred_pipe_fp32.io.vctrl_pipe_out.bits.vlmul, "b000".U, Seq(
     "b000".U -> "b000".U,   // LMUL = 1 → 000
@@ -119,6 +145,7 @@ class Vfreduction extends Module{
   adder_for_lmul.io.vctrl_pipe_in :=  Mux(vfred_pipe_fp32.io.vctrl_pipe_out.bits.index === vlmul_pipe_fp32_cvt, 
                                           vfred_pipe_fp32.io.vctrl_pipe_out, 0.U.asTypeOf(ValidIO(new Vfredctrl)))
   adder_for_lmul.io.vd_pipe_in := Cat(reg_res1, reg_res2)
+  adder_for_lmul.io.fflags_pipe_in := vfred_fp32_fflags | reg_fflags2
   
 
   // arbitrate the result
@@ -128,15 +155,17 @@ class Vfreduction extends Module{
   val is_res_fp16 = uop.fp_format === "b01".U
   val is_res_bf16 = uop.fp_format === "b00".U
 
-  // here need narrow the result to fp16 and bf16
+  // 16-bit results: the fp32 accumulator is rounded once more to fp16 / bf16 with the uop's round_mode
   val fp32_result = Mux(vfred_pipe_fp32.io.vctrl_pipe_out.bits.vlmul === 0.U, vfred_fp32_result, adder_for_lmul.io.vd_pipe_out)
-  val fp16_result = Cat(Fill(16, 0.U), Fill(16, 0.U))
-  val bf16_result = Cat(Fill(16, 0.U), Fill(16, 0.U))
+  val fp32_fflags = Mux(vfred_pipe_fp32.io.vctrl_pipe_out.bits.vlmul === 0.U, vfred_fp32_fflags, adder_for_lmul.io.fflags_pipe_out)
+  val (fp16_result, fp16_fflags) = NarrowFP32(fp32_result, 5, 11, uop.round_mode)
+  val (bf16_result, bf16_fflags) = NarrowFP32(fp32_result, 8, 8, uop.round_mode)
 
   io.out.result := Mux(is_res_fp32 && fp_finish, fp32_result,
-  Mux(is_res_fp16 && fp_finish, Cat(Fill(16, 0.U), fp16_result), 0.U))
+  Mux(is_res_fp16 && fp_finish, Cat(Fill(16, 0.U), fp16_result),
+  Mux(is_res_bf16 && fp_finish, Cat(Fill(16, 0.U), bf16_result), 0.U)))
 
-  io.out.fflags := Mux(fp_finish, fp32_fflags, 0.U)
+  io.out.fflags := Mux(fp_finish, fp32_fflags | Mux(is_res_fp16, fp16_fflags, Mux(is_res_bf16, bf16_fflags, 0.U)), 0.U)
 
   io.finish := fp_finish
 }
@@ -148,6 +177,9 @@ class VfredFP32_Pipelined(val num: Int = 0) extends Module {
     val vctrl_pipe_out = Output(ValidIO(new Vfredctrl))
     val vd_pipe_in = Input(UInt((num*32*2).W))
     val vd_pipe_out = Output(UInt((num*32).W))
+    // exception flags accumulated along the tree, aligned with vd_pipe_in / vd_pipe_out
+    val fflags_pipe_in = Input(UInt(5.W))
+    val fflags_pipe_out = Output(UInt(5.W))
   })
 
   val result_pipe_out  = Wire(Vec(num, UInt(32.W)))
@@ -180,6 +212,68 @@ class VfredFP32_Pipelined(val num: Int = 0) extends Module {
   io.vd_pipe_out    := result_pipe_out.asTypeOf(io.vd_pipe_out)
   io.vctrl_pipe_out := vctrl_pipe_out
   io.vctrl_pipe_out.valid := RegNext(RegNext(io.vctrl_pipe_in.valid))
+  io.fflags_pipe_out := Mux(io.vctrl_pipe_out.valid, RegNext(RegNext(io.fflags_pipe_in)) | fflags_pipe_out.reduce(_ | _), 0.U)
+}
+
+// Round an fp32 value to a narrower format with the same exponent bias rules
+// (fp16: expWidth = 5, sigWidth = 11; bf16: 8, 8). Returns (result, fflags), RISC-V semantics:
+// canonical NaN, tininess detected after rounding
+object NarrowFP32 {
+  def apply(in: UInt, expWidth: Int, sigWidth: Int, round_mode: UInt): (UInt, UInt) = {
+    val fracWidth = sigWidth - 1
+    val bias = (1 << (expWidth - 1)) - 1
+    val maxExp = (1 << expWidth) - 1
+
+    val sign = in(31)
+    val exp  = in(30, 23)
+    val frac = in(22, 0)
+    val is_nan  = exp.andR && frac.orR
+    val is_snan = is_nan && !frac(22)
+    val is_inf  = exp.andR && !frac.orR
+    val sig = Cat(exp.orR, frac)
+
+    def round_up(lsb: Bool, guard: Bool, sticky: Bool): Bool = MuxLookup(round_mode, guard && (sticky || lsb), Seq(
+      "b001".U -> false.B,                        // RTZ
+      "b010".U -> (sign && (guard || sticky)),    // RDN
+      "b011".U -> (!sign && (guard || sticky)),   // RUP
+      "b100".U -> guard                           // RMM
+    ))
+
+    // target biased exponent; fp32 denormals share the exponent of exp = 1
+    val exp_dst = Mux(exp === 0.U, 1.U, exp).zext - (127 - bias).S
+    val denorm_shift = Mux(exp_dst < 1.S, 1.S - exp_dst, 0.S).asUInt
+    val shift = Mux(denorm_shift > (fracWidth + 2).U, 25.U, (23 - fracWidth).U + denorm_shift)
+    val shifted = Cat(sig, 0.U(25.W)) >> shift
+    val kept    = shifted(48, 25)
+    val guard   = shifted(24)
+    val sticky  = shifted(23, 0).orR
+    val inexact = guard || sticky
+
+    val exp_field = Mux(exp_dst < 1.S, 0.S, exp_dst - 1.S).asUInt
+    val encoded   = (exp_field << fracWidth) + kept
+    val rounded   = encoded +& round_up(kept(0), guard, sticky)
+    val overflow  = !is_nan && !is_inf && rounded >= (maxExp << fracWidth).U
+
+    // tininess after rounding: round to sigWidth bits with an unbounded exponent, compare with the minimum normal
+    val sig_norm = Mux(exp === 0.U, Cat(frac, 0.U(1.W)), sig)
+    val kept_u   = sig_norm(23, 23 - fracWidth)
+    val carry_u  = kept_u.andR && round_up(kept_u(0), sig_norm(22 - fracWidth), sig_norm(21 - fracWidth, 0).orR)
+    val tiny     = exp.zext - (127 - bias).S + carry_u.zext < 1.S
+
+    val max_finite = Cat(sign, (maxExp - 1).U(expWidth.W), Fill(fracWidth, 1.U))
+    val infinity   = Cat(sign, Fill(expWidth, 1.U), 0.U(fracWidth.W))
+    val to_max     = round_mode === "b001".U || (round_mode === "b010".U && !sign) || (round_mode === "b011".U && sign)
+
+    val result = Mux(is_nan, Cat(0.U(1.W), Fill(expWidth, 1.U), 1.U(1.W), 0.U((fracWidth - 1).W)),
+                 Mux(is_inf, infinity,
+                 Mux(overflow, Mux(to_max, max_finite, infinity),
+                     Cat(sign, rounded(expWidth + fracWidth - 1, 0)))))
+    val fflags = Mux(is_nan, Cat(is_snan, 0.U(4.W)),
+                 Mux(is_inf, 0.U(5.W),
+                 Mux(overflow, "b00101".U(5.W),
+                     Cat(0.U(3.W), tiny && inexact, inexact))))
+    (result, fflags)
+  }
 }
 
 // latency + 1 = 2
@@ -365,15 +459,15 @@ class FloatAdderMixedFP16BF16_Wrapped() extends Module {
 
   fp16_to_fp19_fpa.io.widen_src := io.fp_a
   val fp16_a_as_fp19 = fp16_to_fp19_fpa.io.widen_dst
-  fp16_to_fp19_fpb.io.widen_src := io.fp_a
+  fp16_to_fp19_fpb.io.widen_src := io.fp_b
   val fp16_b_as_fp19 = fp16_to_fp19_fpb.io.widen_dst
   fp16_to_fp19_frs1.io.widen_src := io.fp_a
   val fp16_frs1_as_fp19 = fp16_to_fp19_frs1.io.widen_dst
   
   val fire = io.fire
-  val fp_format_reg = RegEnable(io.fp_format, fire)
-  val is_bf16 = fp_format_reg === 0.U
-  val is_fp16 = fp_format_reg === 1.U
+  // the operands are selected in the fire cycle, so use the live format
+  val is_bf16 = io.fp_format === 0.U
+  val is_fp16 = io.fp_format === 1.U
 
   val bf16_a_as_fp19 = Cat(io.fp_a(15), io.fp_a.tail(1).head(exponentWidthBF16), Cat(io.fp_a(significandWidthBF16-2,0),0.U((significandWidthFP16 - significandWidthBF16).W)))
   val bf16_b_as_fp19 = Cat(io.fp_b(15), io.fp_b.tail(1).head(exponentWidthBF16), Cat(io.fp_b(significandWidthBF16-2,0),0.U((significandWidthFP16 - significandWidthBF16).W)))
@@ -701,10 +795,12 @@ class FloatAdderRandomWidenFormat(
     )
     val const_1 =  if (in.getWidth == 16) "b1000".U else "b1000".U
     val const_0 =  if (in.getWidth == 16) "b0111".U else "b0111".U
+    val fp_a_is_inf_nan = in(w-2,sig_w-1).andR
     val fp_a_widen_exp = Mux(
       fp_a_is_denormal,
       fp_a_is_denormal_to_widen_exp,
-      Mux(in(w-2), Cat(const_1,in(w-3,w-1-exp_w)), Cat(const_0,in(w-3,w-1-exp_w)))
+      Mux(fp_a_is_inf_nan, Fill(dest_exp_w, 1.U),
+        Mux(in(w-2), Cat(const_1,in(w-3,w-1-exp_w)), Cat(const_0,in(w-3,w-1-exp_w))))
     )
     Cat(in(w-1), fp_a_widen_exp, fp_a_widen_mantissa)
   }
@@ -0,0 +1,161 @@
+// 仿真速度基准历史: 追加一次 make bench 的结果, 与滚动基线比较, 有指标退化超过阈值时返回非零
+//
+// 历史文件每行一条记录 (只追加, 不改写):
+//   <unix 时间> <git 提交> <顶层> <指标>=<值> ...
+// 基线为同一顶层最近 --window 条记录中每个指标的中位数. 名字以 _per_s 结尾的指标越大越好
+// (ops_per_s, cycles_per_s), 其余越小越好 (compile_s, binary_bytes)
+//
+// 用法: bench_history --history=FILE --commit=SHA [--window=5] [--threshold=PCT] [--threshold=METRIC:PCT]
+//                     "<顶层> <指标>=<值> ..." ...
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Record {
+    string top;
+    vector<pair<string, double>> metrics; // 保持命令行中的顺序
+};
+
+// "<顶层> k=v k=v ..."
+static bool parse_record(const string& text, Record& r) {
+    istringstream ss(text);
+    if (!(ss >> r.top)) return false;
+    string kv;
+    while (ss >> kv) {
+        size_t eq = kv.find('=');
+        if (eq == string::npos || eq == 0) return false;
+        char* end;
+        double v = strtod(kv.c_str() + eq + 1, &end);
+        if (*end != '\0' || end == kv.c_str() + eq + 1) return false;
+        r.metrics.emplace_back(kv.substr(0, eq), v);
+    }
+    return !r.metrics.empty();
+}
+
+static bool higher_is_better(const string& metric) {
+    return metric.size() > 6 && metric.compare(metric.size() - 6, 6, "_per_s") == 0;
+}
+
+static double median(vector<double> v) {
+    sort(v.begin(), v.end());
+    size_t n = v.size();
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+int main(int argc, char* argv[]) {
+    string history, commit;
+    size_t window = 5;
+    double threshold = 10.0;
+    map<string, double> metric_threshold;
+    vector<Record> records;
+    for (int i = 1; i < argc; ++i) {
+        if (!strncmp(argv[i], "--history=", 10)) {
+            history = argv[i] + 10;
+        } else if (!strncmp(argv[i], "--commit=", 9)) {
+            commit = argv[i] + 9;
+        } else if (!strncmp(argv[i], "--window=", 9)) {
+            window = strtoul(argv[i] + 9, nullptr, 0);
+        } else if (!strncmp(argv[i], "--threshold=", 12)) {
+            const char* p = argv[i] + 12;
+            const char* colon = strchr(p, ':');
+            if (colon) {
+                metric_threshold[string(p, colon)] = atof(colon + 1);
+            } else {
+                threshold = atof(p);
+            }
+        } else if (argv[i][0] == '-') {
+            printf("ERROR: unknown option %s\n", argv[i]);
+            return 2;
+        } else {
+            Record r;
+            if (!parse_record(argv[i], r)) {
+                printf("ERROR: bad record '%s' (expected '<top> <metric>=<value> ...')\n", argv[i]);
+                return 2;
+            }
+            records.push_back(r);
+        }
+    }
+    if (history.empty() || commit.empty() || records.empty() || window < 1) {
+        printf("usage: bench_history --history=FILE --commit=SHA [--window=N] [--threshold=PCT] "
+               "[--threshold=METRIC:PCT] \"<top> <metric>=<value> ...\" ...\n");
+        return 2;
+    }
+
+    // 1. 读取历史: 顶层 -> 指标 -> 按时间顺序的值
+    map<string, map<string, vector<double>>> past;
+    {
+        ifstream f(history);
+        string line;
+        while (getline(f, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            istringstream ls(line);
+            string when, sha, rest;
+            if (!(ls >> when >> sha)) continue;
+            getline(ls, rest);
+            Record r;
+            if (!parse_record(rest, r)) {
+                printf("WARNING: skipping malformed history line: %s\n", line.c_str());
+                continue;
+            }
+            for (const auto& [k, v] : r.metrics) past[r.top][k].push_back(v);
+        }
+    }
+
+    // 2. 与滚动基线比较
+    bool regressed = false;
+    printf("%-10s %-14s %14s %14s %9s %7s  %s\n", "top", "metric", "value", "baseline", "change", "limit",
+           "status");
+    for (const Record& r : records) {
+        for (const auto& [k, v] : r.metrics) {
+            const double limit = metric_threshold.count(k) ? metric_threshold[k] : threshold;
+            const vector<double>& hist = past[r.top][k];
+            if (hist.empty()) {
+                printf("%-10s %-14s %14.6g %14s %9s %6.1f%%  no baseline yet\n", r.top.c_str(), k.c_str(), v, "-",
+                       "-", limit);
+                continue;
+            }
+            vector<double> recent(hist.end() - min(window, hist.size()), hist.end());
+            const double base = median(recent);
+            const double change = base != 0 ? 100.0 * (v - base) / base : 0.0;
+            // 退化: 越大越好的指标下降超过 limit%, 越小越好的指标上升超过 limit%
+            const double loss = higher_is_better(k) ? -change : change;
+            const bool bad = loss > limit;
+            regressed |= bad;
+            printf("%-10s %-14s %14.6g %14.6g %+8.1f%% %6.1f%%  %s\n", r.top.c_str(), k.c_str(), v, base, change, limit,
+                   bad ? "REGRESSION" : "ok");
+        }
+    }
+
+    // 3. 追加本次结果 (退化的结果也记录, 基线取中位数, 单次异常不会改变它)
+    FILE* fp = fopen(history.c_str(), "a");
+    if (!fp) {
+        printf("ERROR: cannot append to %s\n", history.c_str());
+        return 2;
+    }
+    const long now = (long)time(nullptr);
+    for (const Record& r : records) {
+        fprintf(fp, "%ld %s %s", now, commit.c_str(), r.top.c_str());
+        for (const auto& [k, v] : r.metrics) fprintf(fp, " %s=%.6g", k.c_str(), v);
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+
+    printf("Recorded %zu result(s) for %s in %s (baseline: median of the last %zu runs per top)\n", records.size(),
+           commit.c_str(), history.c_str(), window);
+    if (regressed) {
+        printf("Benchmark FAILED: simulation speed regression\n");
+        return 1;
+    }
+    printf("Benchmark PASSED\n");
+    return 0;
+}
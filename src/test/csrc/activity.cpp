@@ -0,0 +1,268 @@
+#include "include/activity.h"
+
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+static const char* kGroupNames[ACT_GROUPS] = {"mul_in", "mul_S1", "S1", "S2", "S3"};
+static const char* kModeNames[FmaActivity::kModes] = {"fp32", "fp16", "bf16", "fp16w", "bf16w", "idle"};
+
+// 统计的信号: SAIF 中的实例路径 (相对 top) 和网名与 Chisel 生成的 Verilog 一致
+struct ActivitySignal {
+    const char* instance;
+    const char* name;
+    int width;
+    ActivityGroup group;
+    uint64_t (*get)(const FmaStageProbes& p);
+};
+
+static const ActivitySignal kSignals[] = {
+    {"fma/intMul_12_24", "io_a_in", 24, ACT_MUL_IN, [](const FmaStageProbes& p) -> uint64_t { return p.mul_a_in; }},
+    {"fma/intMul_12_24", "io_b_in", 24, ACT_MUL_IN, [](const FmaStageProbes& p) -> uint64_t { return p.mul_b_in; }},
+    {"fma/intMul_12_24", "wallaceOutReg_0", 48, ACT_MUL_S1, [](const FmaStageProbes& p) { return p.mul_sum_S1; }},
+    {"fma/intMul_12_24", "wallaceOutReg_1", 48, ACT_MUL_S1, [](const FmaStageProbes& p) { return p.mul_carry_S1; }},
+    {"fma", "exp_res_adjsubn_low_S1", 10, ACT_S1,
+     [](const FmaStageProbes& p) -> uint64_t { return p.exp_res_adjsubn_low_S1; }},
+    {"fma", "exp_res_adjsubn_high_S1", 10, ACT_S1,
+     [](const FmaStageProbes& p) -> uint64_t { return p.exp_res_adjsubn_high_S1; }},
+    {"fma", "c_in_S1", 32, ACT_S1, [](const FmaStageProbes& p) -> uint64_t { return p.c_in_S1; }},
+    {"fma", "sig_resMul_low_S2", 24, ACT_S2, [](const FmaStageProbes& p) -> uint64_t { return p.sig_resMul_low_S2; }},
+    {"fma", "sig_resMul_whole_S2", 48, ACT_S2, [](const FmaStageProbes& p) { return p.sig_resMul_whole_S2; }},
+    {"fma", "exp_resMul_low_S2", 8, ACT_S2, [](const FmaStageProbes& p) -> uint64_t { return p.exp_resMul_low_S2; }},
+    {"fma", "exp_resMul_high_S2", 8, ACT_S2, [](const FmaStageProbes& p) -> uint64_t { return p.exp_resMul_high_S2; }},
+    {"fma", "c_in_S2", 32, ACT_S2, [](const FmaStageProbes& p) -> uint64_t { return p.c_in_S2; }},
+    {"fma", "adderOut_low_S3", 24, ACT_S3, [](const FmaStageProbes& p) -> uint64_t { return p.adderOut_low_S3; }},
+    {"fma", "adderOut_high_S3", 24, ACT_S3, [](const FmaStageProbes& p) -> uint64_t { return p.adderOut_high_S3; }},
+    {"fma", "adderOut_sign_low_S3", 1, ACT_S3,
+     [](const FmaStageProbes& p) -> uint64_t { return p.adderOut_sign_low_S3; }},
+    {"fma", "adderOut_sign_high_S3", 1, ACT_S3,
+     [](const FmaStageProbes& p) -> uint64_t { return p.adderOut_sign_high_S3; }},
+    {"fma", "c_in_S3", 32, ACT_S3, [](const FmaStageProbes& p) -> uint64_t { return p.c_in_S3; }},
+};
+
+// 各组的位数
+static int group_bits(int g) {
+    int n = 0;
+    for (const ActivitySignal& s : kSignals) {
+        if (s.group == g) n += s.width;
+    }
+    return n;
+}
+
+static int mode_index(const FmaMode& m) {
+    if (m.is_widen) return m.is_fp16 ? 3 : 4;
+    if (m.is_fp16) return 1;
+    if (m.is_bf16) return 2;
+    return 0;
+}
+
+// fp16/bf16 (非 widen) 每个 uop 两个 FMA
+static int fmas_per_op(int mode) {
+    return (mode == 1 || mode == 2) ? 2 : 1;
+}
+
+bool parse_activity_option(const char* arg, ActivitySpec& spec, bool& ok) {
+    ok = true;
+    if (!strcmp(arg, "--activity")) {
+        spec.on = true;
+    } else if (!strncmp(arg, "--saif=", 7)) {
+        spec.on = true;
+        spec.saif_path = arg + 7;
+    } else if (!strncmp(arg, "--activity-ops=", 15)) {
+        spec.on = true;
+        spec.ops_path = arg + 15;
+    } else {
+        return false;
+    }
+    if ((!strncmp(arg, "--saif=", 7) && spec.saif_path.empty()) ||
+        (!strncmp(arg, "--activity-ops=", 15) && spec.ops_path.empty())) {
+        printf("ERROR: %s needs a path\n", arg);
+        ok = false;
+    }
+    return true;
+}
+
+bool FmaActivity::open(const ActivitySpec& spec) {
+    spec_ = spec;
+    if (!spec.ops_path.empty()) {
+        ops_file_ = fopen(spec.ops_path.c_str(), "w");
+        if (!ops_file_) {
+            printf("ERROR: cannot open %s\n", spec.ops_path.c_str());
+            return false;
+        }
+        fprintf(ops_file_, "op,cycle,mode");
+        for (const char* g : kGroupNames) fprintf(ops_file_, ",%s", g);
+        fprintf(ops_file_, ",total\n");
+    }
+    return true;
+}
+
+void FmaActivity::update(bool reset, bool issued, const FmaMode& mode, const FmaStageProbes& p) {
+    // 1. 本沿各组采样的操作: S1 组为本沿发射的操作, S2/S3 为上一沿之后在 S1/S2 中的操作
+    //    (复位清空流水线, 寄存器本身不复位, 复位期间的翻转记为 idle)
+    Stage next[3];
+    if (!reset) {
+        next[0].valid = issued;
+        next[0].mode = mode_index(mode);
+        next[0].op = issued_;
+        next[1] = pipe_[0];
+        next[2] = pipe_[1];
+    }
+    const Stage* owner[ACT_GROUPS] = {&next[0], &next[0], &next[0], &next[1], &next[2]};
+    if (next[0].valid) {
+        OpRecord& r = inflight_[issued_ % 4];
+        r = OpRecord();
+        r.cycle = cycles_;
+        r.mode = next[0].mode;
+        ops_[r.mode]++;
+        issued_++;
+    }
+
+    // 2. 逐位比较上一沿之后的值 (第一次调用只记录初值)
+    uint64_t group_toggles[ACT_GROUPS] = {};
+    int bit = 0;
+    for (const ActivitySignal& s : kSignals) {
+        const uint64_t v = s.get(p) & (s.width == 64 ? ~0ull : (1ull << s.width) - 1);
+        for (int i = 0; i < s.width; ++i, ++bit) {
+            Bit& b = bits_[bit];
+            const bool nv = (v >> i) & 1;
+            if (!started_) {
+                b.value = nv;
+                continue;
+            }
+            if (nv != b.value) {
+                if (b.value) b.t1 += cycles_ - b.since;
+                b.value = nv;
+                b.since = cycles_;
+                b.tc++;
+                group_toggles[s.group]++;
+            }
+        }
+    }
+    if (!started_) {
+        started_ = true;
+    } else {
+        cycles_++;
+    }
+
+    // 3. 记到操作和模式上
+    for (int g = 0; g < ACT_GROUPS; ++g) {
+        const Stage& st = *owner[g];
+        if (st.valid) {
+            enabled_[g]++;
+            if (group_toggles[g] == 0) quiet_[g]++;
+            toggles_[g][st.mode] += group_toggles[g];
+            inflight_[st.op % 4].toggles[g] += group_toggles[g];
+        } else {
+            toggles_[g][kModes - 1] += group_toggles[g];
+        }
+    }
+    for (int i = 0; i < 3; ++i) pipe_[i] = next[i];
+    if (next[2].valid) retire(next[2].op);
+}
+
+void FmaActivity::retire(uint64_t op) {
+    if (!ops_file_) return;
+    const OpRecord& r = inflight_[op % 4];
+    uint64_t total = 0;
+    fprintf(ops_file_, "%lu,%lu,%s", op, r.cycle, kModeNames[r.mode]);
+    for (int g = 0; g < ACT_GROUPS; ++g) {
+        fprintf(ops_file_, ",%lu", r.toggles[g]);
+        total += r.toggles[g];
+    }
+    fprintf(ops_file_, ",%lu\n", total);
+}
+
+bool FmaActivity::finish(const char* workload) {
+    if (ops_file_) {
+        fclose(ops_file_);
+        ops_file_ = nullptr;
+        printf("Per-op activity written to %s\n", spec_.ops_path.c_str());
+    }
+
+    uint64_t ops = 0, fmas = 0;
+    for (int m = 0; m < kModes - 1; ++m) {
+        ops += ops_[m];
+        fmas += ops_[m] * fmas_per_op(m);
+    }
+    printf("\n--- Switching activity: %s (%lu cycles, %lu ops, %lu FMAs) ---\n", workload, cycles_, ops, fmas);
+
+    // 每组: 位数, 翻转数, 使能沿上的翻转率 (每位每次采样), 使能为低的周期 (可门控时钟),
+    // 使能但没有位变化的沿 (写入相同的值), idle 周期的翻转 (mul_in: 操作数隔离可省掉的部分)
+    printf("%-7s %5s %12s %9s %10s %10s %12s\n", "group", "bits", "toggles", "alpha", "gateable", "same-data",
+           "idle-toggles");
+    for (int g = 0; g < ACT_GROUPS; ++g) {
+        uint64_t total = 0;
+        for (int m = 0; m < kModes; ++m) total += toggles_[g][m];
+        const int nbits = group_bits(g);
+        const uint64_t idle = toggles_[g][kModes - 1];
+        printf("%-7s %5d %12lu %9.4f %9.1f%% %9.1f%% %11.1f%%\n", kGroupNames[g], nbits, total,
+               enabled_[g] ? (double)(total - idle) / ((double)enabled_[g] * nbits) : 0.0,
+               cycles_ ? 100.0 * (cycles_ - enabled_[g]) / cycles_ : 0.0,
+               enabled_[g] ? 100.0 * quiet_[g] / enabled_[g] : 0.0, total ? 100.0 * idle / total : 0.0);
+    }
+
+    // 每种模式: 每个 uop 各组的平均翻转数, 以及每个 FMA 的总翻转数 (能耗的相对指标)
+    printf("%-6s %10s", "mode", "ops");
+    for (const char* g : kGroupNames) printf(" %9s", g);
+    printf(" %10s %10s\n", "total/op", "total/FMA");
+    for (int m = 0; m < kModes - 1; ++m) {
+        if (!ops_[m]) continue;
+        uint64_t total = 0;
+        printf("%-6s %10lu", kModeNames[m], ops_[m]);
+        for (int g = 0; g < ACT_GROUPS; ++g) {
+            printf(" %9.1f", (double)toggles_[g][m] / ops_[m]);
+            total += toggles_[g][m];
+        }
+        printf(" %10.1f %10.1f\n", (double)total / ops_[m], (double)total / (ops_[m] * fmas_per_op(m)));
+    }
+
+    if (spec_.saif_path.empty()) return true;
+    if (!write_saif(spec_.saif_path.c_str())) {
+        printf("ERROR: cannot write %s\n", spec_.saif_path.c_str());
+        return false;
+    }
+    printf("SAIF written to %s\n", spec_.saif_path.c_str());
+    return true;
+}
+
+void FmaActivity::write_saif_nets(FILE* fp, const char* instance, const char* indent) const {
+    fprintf(fp, "%s(NET\n", indent);
+    int bit = 0;
+    for (const ActivitySignal& s : kSignals) {
+        for (int i = 0; i < s.width; ++i, ++bit) {
+            if (strcmp(s.instance, instance)) continue;
+            const Bit& b = bits_[bit];
+            // 最后一次翻转之后的时间计入当前值
+            const uint64_t t1 = b.t1 + (b.value ? cycles_ - b.since : 0);
+            fprintf(fp, "%s  (%s", indent, s.name);
+            if (s.width > 1) fprintf(fp, "\\[%d\\]", i);
+            fprintf(fp, " (T0 %lu) (T1 %lu) (TX 0) (TC %lu))\n", 2 * (cycles_ - t1), 2 * t1, b.tc);
+        }
+    }
+    fprintf(fp, "%s)\n", indent);
+}
+
+// SAIF 2.0, 时间单位与仿真一致 (--timescale 1us/1us, 每个时钟周期 2 个单位)
+bool FmaActivity::write_saif(const char* path) const {
+    FILE* fp = fopen(path, "w");
+    if (!fp) return false;
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%a %b %d %H:%M:%S %Y", localtime(&now));
+    fprintf(fp, "(SAIFILE\n(SAIFVERSION \"2.0\")\n(DIRECTION \"backward\")\n(DESIGN \"top\")\n(DATE \"%s\")\n", date);
+    fprintf(fp, "(VENDOR \"Simple-Test-For-VFPU\")\n(PROGRAM_NAME \"top --saif\")\n(VERSION \"1.0\")\n");
+    fprintf(fp, "(DIVIDER / )\n(TIMESCALE 1 us)\n(DURATION %lu)\n", 2 * cycles_);
+    fprintf(fp, "(INSTANCE top\n");
+
+    // top/fma 的网, 然后是嵌套的 top/fma/intMul_12_24
+    fprintf(fp, "  (INSTANCE fma\n");
+    write_saif_nets(fp, "fma", "    ");
+    fprintf(fp, "    (INSTANCE intMul_12_24\n");
+    write_saif_nets(fp, "fma/intMul_12_24", "      ");
+    fprintf(fp, "    )\n");
+    fprintf(fp, "  )\n)\n)\n");
+    fclose(fp);
+    return true;
+}
@@ -0,0 +1,268 @@
+#include "include/bandit.h"
+#include "include/fma_stages.h"
+#include "include/simulator.h"
+#include "include/test_factory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// 每次拉臂之后所有臂的历史收益乘以该系数: 覆盖饱和后收益下降, 旧的收益不应一直占优
+// (有效记忆约 1 / (1 - kDiscount) 次拉臂)
+const double kDiscount = 0.999;
+
+struct Arm {
+    const RandomBand* band;
+    uint64_t pulls = 0, vectors = 0, hits = 0, failures = 0, new_bins = 0;
+    double s = 0, f = 0; // 折扣后的有收益/无收益向量数, 即 Beta(1 + s, 1 + f) 后验
+    double secs = 0;
+};
+
+double sample_beta(mt19937_64& rng, double a, double b) {
+    const double x = gamma_distribution<double>(a, 1.0)(rng);
+    const double y = gamma_distribution<double>(b, 1.0)(rng);
+    return x / (x + y);
+}
+
+// 0, 1, 2, 3-7, 8-15, 16-31, 32+
+int bucket(uint32_t v) {
+    if (v < 3) return v;
+    if (v < 8) return 3;
+    if (v < 16) return 4;
+    if (v < 32) return 5;
+    return 6;
+}
+
+int leading_zeros(uint64_t v, int width) {
+    int n = 0;
+    for (int i = width - 1; i >= 0 && !((v >> i) & 1); --i) n++;
+    return n;
+}
+
+// 结果的类型: 0 零, 1 非规格化, 2 规格化, 3 无穷
+int result_class(uint32_t bits, int exp_lsb, int exp_width) {
+    const uint32_t exp = (bits >> exp_lsb) & ((1u << exp_width) - 1);
+    const uint32_t frac = bits & ((1u << exp_lsb) - 1);
+    if (exp == 0) return frac ? 1 : 0;
+    if (exp == (1u << exp_width) - 1) return 3;
+    return 2;
+}
+
+// 一个向量命中的功能覆盖箱 (fp16/bf16 两路各一个, 其余模式一个)
+int coverage_bins(const TestCase& t, uint32_t keys[2]) {
+    FmaMode mode;
+    uint32_t a, b, c;
+    fma_core_inputs(t.dut_inputs(), mode, a, b, c);
+    const FmaRegsS3 s3 = fma_s3(fma_s2(fma_s1(mode, a, b, c), mode), mode);
+    const uint32_t res = fma_res_out(s3);
+    const bool dual = t.mode == TestMode::FP16 || t.mode == TestMode::BF16;
+    int n = 0;
+    for (int h = dual ? 0 : 1; h < 2; ++h) {
+        const bool hi = h == 1;
+        uint32_t lz;
+        int cls;
+        if (dual) {
+            const uint32_t adder = hi ? s3.adderOut_high : s3.adderOut_low;
+            lz = adder ? leading_zeros(adder, 24) : 63;
+            const uint32_t half = hi ? res >> 16 : res & 0xffff;
+            cls = t.mode == TestMode::FP16 ? result_class(half, 10, 5) : result_class(half, 7, 8);
+        } else {
+            const uint64_t adder = (uint64_t(s3.adderOut_high) << 24) | s3.adderOut_low;
+            lz = adder ? leading_zeros(adder, 48) : 63;
+            cls = result_class(res, 23, 8);
+        }
+        const uint32_t exp_ab = hi ? s3.exp_resMul_high : s3.exp_resMul_low;
+        const uint32_t exp_c = hi ? s3.exp_c_high : s3.exp_c_low;
+        uint32_t k = (uint32_t)t.mode;
+        k = k * 2 + h;
+        k = k * 2 + (hi ? s3.exp_c_gte_ab_high : s3.exp_c_gte_ab_low);
+        k = k * 2 + (hi ? s3.resMul_is_zero_high : s3.resMul_is_zero_low);
+        k = k * 2 + (hi ? s3.resMul_is_inf_high : s3.resMul_is_inf_low);
+        k = k * 2 + (hi ? s3.resMul_is_subnorm_high : s3.resMul_is_subnorm_low);
+        k = k * 2 + (hi ? s3.is_inf_high_c : s3.is_inf_low_c);
+        k = k * 2 + (hi ? s3.adderOut_sign_high : s3.adderOut_sign_low);
+        k = k * 8 + (lz == 63 ? 7 : bucket(lz));
+        k = k * 8 + bucket(exp_c > exp_ab ? exp_c - exp_ab : exp_ab - exp_c);
+        k = k * 4 + cls;
+        keys[n++] = k;
+    }
+    return n;
+}
+
+double parse_duration(const char* s, bool& ok) {
+    char* end;
+    double v = strtod(s, &end);
+    if (*end == 'm') {
+        v *= 60;
+        end++;
+    } else if (*end == 'h') {
+        v *= 3600;
+        end++;
+    } else if (*end == 's') {
+        end++;
+    }
+    ok = end != s && *end == '\0' && v > 0;
+    return v;
+}
+
+} // namespace
+
+bool parse_bandit_option(const char* arg, BanditSpec& spec, bool& ok) {
+    ok = true;
+    if (!strncmp(arg, "--bandit=", 9)) {
+        spec.budget_s = parse_duration(arg + 9, ok);
+        if (!ok) printf("ERROR: --bandit expects a time budget such as 600, 90s, 10m or 8h\n");
+    } else if (!strncmp(arg, "--bandit-batch=", 15)) {
+        spec.batch = atoi(arg + 15);
+        if (spec.batch < 1) {
+            printf("ERROR: --bandit-batch must be at least 1\n");
+            ok = false;
+        }
+    } else if (!strncmp(arg, "--bandit-failures=", 18)) {
+        spec.failures_path = arg + 18;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool run_bandit(Simulator& sim, const BanditSpec& spec) {
+    const vector<RandomBand>& bands = random_bands();
+    vector<Arm> arms(bands.size());
+    int fixed_total = 0;
+    for (size_t i = 0; i < bands.size(); ++i) {
+        arms[i].band = &bands[i];
+        fixed_total += bands[i].count;
+    }
+
+    FILE* fail_log = nullptr;
+    if (!spec.failures_path.empty()) {
+        fail_log = fopen(spec.failures_path.c_str(), "w");
+        if (!fail_log) {
+            printf("ERROR: cannot open %s\n", spec.failures_path.c_str());
+            return false;
+        }
+    }
+
+    printf("--- Bandit: %.0f s over %zu bands, %d vectors per pull ---\n", spec.budget_s, arms.size(), spec.batch);
+    unordered_set<uint32_t> bins;
+#if VM_COVERAGE
+    // RTL 覆盖点按批读取 (导出计数器要写文件), 计数为累计值, 第一次为零的点之后变为非零即新覆盖
+    vector<uint64_t> cov;
+    if (!sim.coverage_counters(cov, false)) return false;
+    const size_t ncov = cov.size();
+    vector<bool> covered(ncov, false);
+    size_t rtl_points = 0;
+#endif
+
+    auto t0 = chrono::steady_clock::now();
+    auto elapsed = [&] { return chrono::duration<double>(chrono::steady_clock::now() - t0).count(); };
+    // 随机数种子取自 srand(--seed), 同一种子的分配过程可复现
+    mt19937_64 rng(rand());
+    uint64_t pulls = 0;
+    while (elapsed() < spec.budget_s) {
+        // 1. Thompson 采样: 从每个臂的 Beta 后验中抽一个命中率, 取最大的臂
+        size_t pick = 0;
+        double best = -1;
+        for (size_t i = 0; i < arms.size(); ++i) {
+            const double theta = sample_beta(rng, 1 + arms[i].s, 1 + arms[i].f);
+            if (theta > best) {
+                best = theta;
+                pick = i;
+            }
+        }
+
+        // 2. 运行一批向量: 失败或命中新覆盖箱的向量计为有收益
+        Arm& arm = arms[pick];
+        const double start = elapsed();
+        int hits = 0;
+        for (int v = 0; v < spec.batch; ++v) {
+            TestCase t = arm.band->gen();
+            uint32_t keys[2];
+            int fresh = 0;
+            for (int k = 0, n = coverage_bins(t, keys); k < n; ++k) fresh += bins.insert(keys[k]).second;
+            const bool pass = sim.run_test(t);
+            arm.new_bins += fresh;
+            if (!pass) {
+                arm.failures++;
+                printf("Bandit: vector %lu of band '%s' FAILED\n", arm.vectors + v, arm.band->name);
+                if (fail_log) {
+                    fprintf(fail_log, "%s ", test_mode_name(t.mode));
+                    write_test_operands(fail_log, t);
+                    fprintf(fail_log, "\n");
+                    fflush(fail_log);
+                }
+            }
+            hits += !pass || fresh;
+        }
+#if VM_COVERAGE
+        // 这一批新覆盖的 RTL 点: 每个点与一个命中新覆盖箱的向量同等计入收益 (不超过批大小)
+        if (sim.coverage_counters(cov, false) && cov.size() == ncov) {
+            int rtl_fresh = 0;
+            for (size_t i = 0; i < ncov; ++i) {
+                if (cov[i] && !covered[i]) {
+                    covered[i] = true;
+                    rtl_points++;
+                    rtl_fresh++;
+                }
+            }
+            arm.new_bins += rtl_fresh;
+            hits = min(spec.batch, hits + rtl_fresh);
+        }
+#endif
+        for (Arm& a : arms) {
+            a.s *= kDiscount;
+            a.f *= kDiscount;
+        }
+        arm.s += hits;
+        arm.f += spec.batch - hits;
+        arm.pulls++;
+        arm.vectors += spec.batch;
+        arm.hits += hits;
+        arm.secs += elapsed() - start;
+        pulls++;
+    }
+    if (fail_log) fclose(fail_log);
+
+    // 3. 最终分配: 按分到的向量数排序, 与固定分配的占比对比
+    uint64_t vectors = 0, failures = 0;
+    for (const Arm& a : arms) {
+        vectors += a.vectors;
+        failures += a.failures;
+    }
+    vector<const Arm*> order;
+    for (const Arm& a : arms) order.push_back(&a);
+    stable_sort(order.begin(), order.end(), [](const Arm* x, const Arm* y) { return x->vectors > y->vectors; });
+
+    printf("\n--- Bandit allocation: %.1f s, %lu vectors in %lu pulls, %lu failures, %zu functional bins",
+           elapsed(), vectors, pulls, failures, bins.size());
+#if VM_COVERAGE
+    printf(", %zu of %zu RTL coverage points", rtl_points, ncov);
+#endif
+    printf(" ---\n");
+    printf("%-20s %7s %10s %7s %7s %7s %9s %8s %8s\n", "band", "pulls", "vectors", "share", "fixed", "fails",
+           "new-bins", "hit-rate", "seconds");
+    for (const Arm* a : order) {
+        printf("%-20s %7lu %10lu %6.1f%% %6.1f%% %7lu %9lu %8.5f %8.1f\n", a->band->name, a->pulls, a->vectors,
+               vectors ? 100.0 * a->vectors / vectors : 0.0, 100.0 * a->band->count / fixed_total, a->failures,
+               a->new_bins, a->vectors ? (double)a->hits / a->vectors : 0.0, a->secs);
+    }
+    if (failures) {
+        const bool logged = !spec.failures_path.empty();
+        printf("Bandit FAILED: %lu failing vectors%s%s\n", failures, logged ? " written to " : "",
+               logged ? spec.failures_path.c_str() : "");
+        return false;
+    }
+    printf("Bandit PASSED\n");
+    return true;
+}
@@ -0,0 +1,220 @@
+#include "include/coro_tb.h"
+#include "include/simulator.h"
+#include "include/vfma_model.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace std;
+
+// ===================================================================
+// ClockScheduler 实现
+// ===================================================================
+
+ClockScheduler::~ClockScheduler() {
+    // daemon 任务停在 co_await edge() 上, 随调度器一起销毁
+    for (Task::Handle h : tasks_) h.destroy();
+}
+
+void ClockScheduler::spawn(Task task, bool daemon) {
+    Task::Handle h = task.release();
+    tasks_.push_back(h);
+    daemon_.push_back(daemon);
+    ready_.push_back(h);
+}
+
+void ClockScheduler::run_ready() {
+    while (!ready_.empty()) {
+        coroutine_handle<> h = ready_.front();
+        ready_.pop_front();
+        h.resume();
+    }
+}
+
+bool ClockScheduler::run(uint64_t max_cycles) {
+    auto busy = [this] {
+        for (size_t i = 0; i < tasks_.size(); ++i) {
+            if (!daemon_[i] && !tasks_[i].done()) return true;
+        }
+        return false;
+    };
+    // 新任务先运行到第一个挂起点, 之后每个时钟沿按注册顺序恢复等待者
+    run_ready();
+    const uint64_t start = cycle_;
+    while (busy()) {
+        if (cycle_ - start >= max_cycles) return false;
+        clock_edge_();
+        cycle_++;
+        vector<coroutine_handle<>> waiters;
+        waiters.swap(on_edge_);
+        ready_.insert(ready_.end(), waiters.begin(), waiters.end());
+        run_ready();
+    }
+    return true;
+}
+
+// ===================================================================
+// Vtop + VfmaModel 测试平台
+// ===================================================================
+
+bool parse_coro_option(const char* arg, CoroStimulus& stim, bool& ok) {
+    ok = true;
+    if (!strcmp(arg, "--coro") || !strcmp(arg, "--coro=pipelined")) {
+        stim.bubble_pct = 0;
+    } else if (!strcmp(arg, "--coro=bubbly")) {
+        stim.bubble_pct = 25;
+    } else if (!strncmp(arg, "--coro=bubbly:", 14)) {
+        stim.bubble_pct = atoi(arg + 14);
+        if (stim.bubble_pct < 0 || stim.bubble_pct > 95) {
+            printf("ERROR: --coro=bubbly:P needs 0 <= P <= 95\n");
+            ok = false;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+struct Issued {
+    size_t test;
+    uint64_t cycle;
+};
+
+struct Observed {
+    DutOutputs out;
+    uint64_t cycle;
+};
+
+struct CoroBench {
+    CoroBench(Simulator& sim, const vector<TestCase>& tests, const CoroStimulus& stim)
+        : sim(sim), tests(tests), stim(stim),
+          sched([this] {
+              this->sim.step();
+              model.step();
+          }),
+          issued(sched), rtl_out(sched), ref_out(sched) {}
+
+    Simulator& sim;
+    const vector<TestCase>& tests;
+    const CoroStimulus& stim;
+    VfmaModel model;
+    ClockScheduler sched;
+    Mailbox<Issued> issued;
+    Mailbox<Observed> rtl_out, ref_out;
+    vector<uint64_t> issue_cycle;  // 驱动任务按发射顺序记录
+
+    size_t mismatches = 0, golden_checked = 0, golden_failed = 0, mode_changed = 0;
+    uint64_t min_latency = ~0ull, max_latency = 0;
+};
+
+// 驱动: 每周期发射一个操作, 或以 bubble_pct% 的概率空闲一拍 (只拉低valid_in, 模式保持不变)
+Task driver(CoroBench& b) {
+    mt19937 rng(rand());
+    for (size_t i = 0; i < b.tests.size();) {
+        if (b.stim.bubble_pct && (int)(rng() % 100) < b.stim.bubble_pct) {
+            b.sim.idle();
+            b.model.idle();
+        } else {
+            const DutInputs in = b.tests[i].dut_inputs();
+            b.sim.drive(in);
+            b.model.drive(in);
+            b.issue_cycle.push_back(b.sched.cycle());
+            b.issued.push({i++, b.sched.cycle()});
+        }
+        co_await b.sched.edge();
+    }
+    b.sim.idle();
+    b.model.idle();
+}
+
+// 监视: 每个时钟沿之后采样一个单元的 valid_out
+template <class Unit>
+Task monitor(CoroBench& b, Unit& unit, Mailbox<Observed>& box) {
+    for (;;) {
+        co_await b.sched.edge();
+        if (unit.valid_out()) box.push({unit.sample(), b.sched.cycle()});
+    }
+}
+
+// 计分板: 按发射顺序配对两个单元的输出
+Task scoreboard(CoroBench& b) {
+    const size_t max_report = 10;
+    for (size_t n = 0; n < b.tests.size(); ++n) {
+        const Issued op = co_await b.issued.pop();
+        const Observed rtl = co_await b.rtl_out.pop();
+        const Observed ref = co_await b.ref_out.pop();
+        const TestCase& t = b.tests[op.test];
+        const uint64_t latency = rtl.cycle - op.cycle;
+        b.min_latency = min(b.min_latency, latency);
+        b.max_latency = max(b.max_latency, latency);
+
+        // 1. Vtop 与 VfmaModel 逐位、逐周期一致
+        if (rtl.cycle != ref.cycle || rtl.out.res_out_32 != ref.out.res_out_32) {
+            if (b.mismatches++ < max_report) {
+                t.print_details();
+                printf("MISMATCH on op %zu (issued cycle %lu): Vtop cycle %lu res 0x%08x, "
+                       "VfmaModel cycle %lu res 0x%08x\n", op.test + 1, op.cycle, rtl.cycle,
+                       rtl.out.res_out_32, ref.cycle, ref.out.res_out_32);
+            }
+        }
+
+        // 2. S2/S3 在发射后的两个周期采样 io 模式端口: 期间模式不变的操作才能与 TestCase 的期望比较
+        bool changed = false;
+        for (size_t j = op.test + 1; j < b.issue_cycle.size() && b.issue_cycle[j] <= op.cycle + 2; ++j) {
+            changed |= b.tests[j].mode != t.mode;
+        }
+        if (changed) {
+            b.mode_changed++;
+        } else {
+            b.golden_checked++;
+            if (!t.check_result(rtl.out) && b.golden_failed++ < max_report) {
+                printf("GOLDEN FAIL on op %zu (issued cycle %lu)\n", op.test + 1, op.cycle);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool run_coro_testbench(Simulator& sim, const vector<TestCase>& tests, const CoroStimulus& stim) {
+    printf("--- Coroutine testbench: %zu ops, %d%% bubbles, Vtop + VfmaModel on one clock ---\n",
+           tests.size(), stim.bubble_pct);
+    CoroBench b(sim, tests, stim);
+    sim.reset(2);
+    b.model.reset(2);
+
+    b.sched.spawn(monitor(b, b.sim, b.rtl_out), true);
+    b.sched.spawn(monitor(b, b.model, b.ref_out), true);
+    b.sched.spawn(driver(b));
+    b.sched.spawn(scoreboard(b));
+
+    const uint64_t max_cycles = tests.size() * 100 / (100 - stim.bubble_pct) * 2 + 100;
+    auto t0 = chrono::steady_clock::now();
+    bool done = b.sched.run(max_cycles);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    const uint64_t cycles = b.sched.cycle();
+
+    printf("Ran %lu cycles in %.3f s (%.0f cycles/s, %.1f ns/cycle for both units)\n", cycles, secs,
+           secs > 0 ? cycles / secs : 0.0, cycles ? secs * 1e9 / cycles : 0.0);
+    printf("Issue rate: %.3f ops/cycle, latency %lu..%lu cycles\n", cycles ? (double)tests.size() / cycles : 0.0,
+           b.min_latency, b.max_latency);
+    printf("Checked: %zu ops against TestCase, %zu only against VfmaModel (mode changed within 2 cycles of issue)\n",
+           b.golden_checked, b.mode_changed);
+    if (!done) {
+        printf("Coroutine testbench FAILED: timeout after %lu cycles (%zu of %zu ops issued)\n", cycles,
+               b.issue_cycle.size(), tests.size());
+        return false;
+    }
+    if (b.mismatches || b.golden_failed) {
+        printf("Coroutine testbench FAILED: %zu Vtop/VfmaModel mismatches, %zu golden failures\n",
+               b.mismatches, b.golden_failed);
+        return false;
+    }
+    printf("Coroutine testbench PASSED\n");
+    return true;
+}
@@ -0,0 +1,597 @@
+#include "include/fma_stages.h"
+
+#include <cstdio>
+
+// 与 VFMA_16_32 的参数一致
+static constexpr int wResMul32 = 48;
+static constexpr int wResMul16 = wResMul32 / 2;
+
+static inline uint64_t mask(int w) { return w >= 64 ? ~0ull : (1ull << w) - 1; }
+static inline uint64_t bits(uint64_t x, int hi, int lo) { return (x >> lo) & mask(hi - lo + 1); }
+static inline bool bit(uint64_t x, int i) { return (x >> i) & 1; }
+
+FmaRoundFault g_fma_round_fault;
+
+// LZD(in) = PriorityEncoder(Reverse(Cat(in, 1.U))): in 的前导零个数, in 为0时等于位宽
+static inline uint32_t lzd(uint64_t in, int w) {
+    uint32_t n = 0;
+    for (int i = w - 1; i >= 0 && !bit(in, i); i--) n++;
+    return n;
+}
+
+// shift(data, amount, right): 右移, 或者(翻转-右移-翻转)即截断的左移
+static inline uint64_t shift(uint64_t data, uint32_t amount, bool right, int w) {
+    if (amount >= 64) return 0;
+    return right ? data >> amount : (data << amount) & mask(w);
+}
+
+// ===================================================================
+// S0 -> S1
+// ===================================================================
+FmaRegsS1 fma_s1(const FmaMode& m, uint32_t a, uint32_t b, uint32_t c) {
+    FmaRegsS1 s1;
+    const bool is_fp16 = m.is_fp16;
+    const bool is_16 = m.is_fp16 || m.is_bf16;
+    const bool widen = m.is_widen;
+
+    // ----   low_a, low_b, high_a, high_b = 0, 1, 2, 3   ----
+    uint32_t exp_in[4], frac_in_16[4];
+    exp_in[0] = is_fp16 ? bits(a, 14, 10) : bits(a, 14, 7);
+    exp_in[1] = is_fp16 ? bits(b, 14, 10) : bits(b, 14, 7);
+    exp_in[2] = is_fp16 ? bits(a, 30, 26) : bits(a, 30, 23);
+    exp_in[3] = is_fp16 ? bits(b, 30, 26) : bits(b, 30, 23);
+    frac_in_16[0] = is_fp16 ? bits(a, 9, 0) : bits(a, 6, 0) << 3;
+    frac_in_16[1] = is_fp16 ? bits(b, 9, 0) : bits(b, 6, 0) << 3;
+    frac_in_16[2] = is_fp16 ? bits(a, 25, 16) : bits(a, 22, 16) << 3;
+    frac_in_16[3] = is_fp16 ? bits(b, 25, 16) : bits(b, 22, 16) << 3;
+    uint32_t frac_in_32[2] = {a & 0x7fffff, b & 0x7fffff};
+
+    bool exp_is_0[4], exp_is_all1s[4], frac_is_0_16[4], frac_is_0_32[2];
+    for (int i = 0; i < 4; i++) {
+        exp_is_0[i] = exp_in[i] == 0;
+        exp_is_all1s[i] = exp_in[i] == (is_fp16 ? 0x1fu : 0xffu);
+        frac_is_0_16[i] = frac_in_16[i] == 0;
+    }
+    for (int i = 0; i < 2; i++) frac_is_0_32[i] = frac_in_32[i] == 0;
+
+    bool is_subnorm[4];
+    for (int i = 0; i < 4; i++) {
+        s1.is_zero_16[i] = exp_is_0[i] && frac_is_0_16[i];
+        s1.is_inf_16[i] = exp_is_all1s[i] && frac_is_0_16[i];
+        bool subnorm_16 = exp_is_0[i] && !frac_is_0_16[i];
+        bool subnorm_32 = i >= 2 && exp_is_0[i] && !frac_is_0_32[i - 2];
+        is_subnorm[i] = is_16 ? subnorm_16 : subnorm_32;
+    }
+    for (int i = 0; i < 2; i++) {
+        s1.is_zero_32[i] = exp_is_0[i + 2] && frac_is_0_32[i];
+        s1.is_inf_32[i] = exp_is_all1s[i + 2] && frac_is_0_32[i];
+    }
+
+    uint32_t exp_adjust_subnorm[4], sig_adjust_subnorm_16[4], sig_adjust_subnorm_32[2];
+    for (int i = 0; i < 4; i++) {
+        exp_adjust_subnorm[i] = is_subnorm[i] ? 1 : exp_in[i];
+        sig_adjust_subnorm_16[i] = (is_subnorm[i] ? 0 : 1u << 10) | frac_in_16[i];
+    }
+    for (int i = 0; i < 2; i++) {
+        sig_adjust_subnorm_32[i] = (is_subnorm[i + 2] ? 0 : 1u << 23) | frac_in_32[i];
+    }
+
+    // IntMUL_12_24: 两个 12*12 或一个 24*24 无符号乘法
+    if (is_16) {
+        uint64_t lo = uint64_t(sig_adjust_subnorm_16[0] << 1) * (sig_adjust_subnorm_16[1] << 1);
+        uint64_t hi = uint64_t(sig_adjust_subnorm_16[2] << 1) * (sig_adjust_subnorm_16[3] << 1);
+        s1.res_intMul = (hi << 24) | lo;
+    } else {
+        s1.res_intMul = uint64_t(sig_adjust_subnorm_32[0]) * sig_adjust_subnorm_32[1];
+    }
+
+    // Exp calculation (10 bits)
+    uint32_t exp_adjsubn_sum_high = exp_adjust_subnorm[2] + exp_adjust_subnorm[3];
+    uint32_t exp_adjsubn_sum_low = exp_adjust_subnorm[0] + exp_adjust_subnorm[1];
+    uint32_t eh = (widen && is_fp16 ? exp_adjsubn_sum_high + (127 - 15 - 15)
+                                     : exp_adjsubn_sum_high - (is_fp16 ? 15 : 127)) & 0x3ff;
+    uint32_t el = (exp_adjsubn_sum_low - (is_fp16 ? 15 : 127)) & 0x3ff;
+    s1.exp_res_adjsubn_high = eh;
+    s1.exp_res_adjsubn_low = el;
+    s1.res_is_inf_high = (is_fp16 && !widen)
+        ? !bit(eh, 9) && (bits(eh, 8, 5) == 1 || bits(eh, 4, 0) == 0x1f)
+        : !bit(eh, 9) && (bit(eh, 8) || bits(eh, 7, 0) == 0xff);
+    s1.res_is_inf_low = is_fp16
+        ? !bit(el, 9) && (bits(el, 8, 5) == 1 || bits(el, 4, 0) == 0x1f)
+        : !bit(el, 9) && (bit(el, 8) || bits(el, 7, 0) == 0xff);
+    s1.res_sign_high = bit(a, 31) ^ bit(b, 31);
+    s1.res_sign_low = bit(a, 15) ^ bit(b, 15);
+
+    s1.input_is_16 = is_16;
+    s1.res_is_32 = widen || m.is_fp32;
+    s1.res_is_bf16 = m.is_bf16 && !widen;
+    s1.res_is_fp16 = m.is_fp16 && !widen;
+    s1.widen = widen;
+    s1.is_fp16 = is_fp16;
+    s1.c_in = c;
+    return s1;
+}
+
+// ===================================================================
+// S1 -> S2: a*b 结果规格化 (部分)
+// ===================================================================
+FmaRegsS2 fma_s2(const FmaRegsS1& s1, const FmaMode& live) {
+    FmaRegsS2 s2;
+    const uint64_t P = s1.res_intMul;
+    const uint64_t res_intMul_high24 = bits(P, 47, 47 - wResMul16 + 1);
+    const uint64_t res_intMul_low24 = bits(P, 23, 23 - wResMul16 + 1);
+    const uint64_t res_intMul_48 = s1.input_is_16 ? (bits(P, 47, 24) << 24) : P;
+
+    const uint32_t int_part_high = bits(res_intMul_high24, wResMul16 - 1, wResMul16 - 2);
+    const uint32_t int_part_low = bits(res_intMul_low24, wResMul16 - 1, wResMul16 - 2);
+
+    const uint32_t lzd_low = lzd(bits(res_intMul_low24, wResMul16 - 3, 0), wResMul16 - 2);
+    const uint32_t lzd_high = lzd(bits(res_intMul_high24, wResMul16 - 3, 0), wResMul16 - 2);
+    const uint32_t lzd_whole = lzd(bits(res_intMul_48, wResMul32 - 3, 0), wResMul32 - 2);
+    const uint32_t el = s1.exp_res_adjsubn_low, eh = s1.exp_res_adjsubn_high;
+    const uint32_t low_under_1 = (1 - el) & 0x3ff, low_over_1 = (el - 1) & 0x3ff;
+    const uint32_t high_under_1 = (1 - eh) & 0x3ff, high_over_1 = (eh - 1) & 0x3ff;
+    const bool res_is_zero_low_case1 = !bit(low_under_1, 9) && bits(low_under_1, 8, 4) != 0;
+    const bool res_is_zero_high_case1 = !bit(high_under_1, 9) &&
+        (s1.res_is_32 ? bits(high_under_1, 8, 5) != 0 : bits(high_under_1, 8, 4) != 0);
+
+    // shift_amount_low: 5 bits, shift_amount_high: 6 bits
+    bool res_is_subnorm_low, res_is_inf_low_case1, shift_right_low;
+    uint32_t shift_amount_low;
+    if (int_part_low & 2) {
+        res_is_subnorm_low = bit(el, 9);
+        res_is_inf_low_case1 = el == (s1.res_is_fp16 ? 0x1eu : 0xfeu);
+        shift_right_low = true;
+        shift_amount_low = !res_is_subnorm_low ? 1 : low_under_1;
+    } else if (int_part_low & 1) {
+        res_is_subnorm_low = bit(el, 9) || el == 0;
+        res_is_inf_low_case1 = false;
+        shift_right_low = true;
+        shift_amount_low = !res_is_subnorm_low ? 0 : low_under_1;
+    } else {
+        if (!bit(low_under_1, 9)) {
+            res_is_subnorm_low = true;
+            shift_right_low = true;
+            shift_amount_low = low_under_1;
+        } else if (low_over_1 <= lzd_low) {
+            res_is_subnorm_low = true;
+            shift_right_low = false;
+            shift_amount_low = low_over_1;
+        } else {
+            res_is_subnorm_low = false;
+            shift_right_low = false;
+            shift_amount_low = lzd_low + 1;
+        }
+        res_is_inf_low_case1 = false;
+    }
+    shift_amount_low &= 0x1f;
+
+    bool res_is_subnorm_high, res_is_inf_high_case1, shift_right_high;
+    uint32_t shift_amount_high;
+    const uint32_t lzd_high_or_whole = s1.res_is_32 ? lzd_whole : lzd_high;
+    if (int_part_high & 2) {
+        res_is_subnorm_high = bit(eh, 9);
+        res_is_inf_high_case1 = eh == (s1.res_is_fp16 ? 0x1eu : 0xfeu);
+        shift_right_high = true;
+        shift_amount_high = !res_is_subnorm_high ? 1 : high_under_1;
+    } else if (int_part_high & 1) {
+        res_is_subnorm_high = bit(eh, 9) || eh == 0;
+        res_is_inf_high_case1 = false;
+        shift_right_high = true;
+        shift_amount_high = !res_is_subnorm_high ? 0 : high_under_1;
+    } else {
+        if (!bit(high_under_1, 9)) {
+            res_is_subnorm_high = true;
+            shift_right_high = true;
+            shift_amount_high = high_under_1;
+        } else if (high_over_1 <= lzd_high_or_whole) {
+            res_is_subnorm_high = true;
+            shift_right_high = false;
+            shift_amount_high = high_over_1;
+        } else {
+            res_is_subnorm_high = false;
+            shift_right_high = false;
+            shift_amount_high = lzd_high_or_whole + 1;
+        }
+        res_is_inf_high_case1 = false;
+    }
+    shift_amount_high &= 0x3f;
+
+    const bool res_is_zero_low = s1.is_zero_16[0] || s1.is_zero_16[1] || res_is_zero_low_case1;
+    const bool res_is_zero_high = (s1.input_is_16 ? s1.is_zero_16[2] || s1.is_zero_16[3]
+                                                  : s1.is_zero_32[0] || s1.is_zero_32[1]) ||
+                                  res_is_zero_high_case1;
+    s2.resMul_is_zero_low = res_is_zero_low;
+    s2.resMul_is_zero_high = res_is_zero_high;
+    s2.resMul_is_inf_low = !res_is_zero_low &&
+        (s1.is_inf_16[0] || s1.is_inf_16[1] || s1.res_is_inf_low || res_is_inf_low_case1);
+    s2.resMul_is_inf_high = !res_is_zero_high &&
+        ((s1.input_is_16 ? s1.is_inf_16[2] || s1.is_inf_16[3] : s1.is_inf_32[0] || s1.is_inf_32[1]) ||
+         s1.res_is_inf_high || res_is_inf_high_case1);
+    s2.resMul_is_subnorm_low = res_is_subnorm_low;
+    s2.resMul_is_subnorm_high = res_is_subnorm_high;
+
+    s2.sig_resMul_low = shift(res_intMul_low24, shift_amount_low, shift_right_low, wResMul16);
+    s2.sig_resMul_whole = shift(res_intMul_48, shift_amount_high, shift_right_high, wResMul32);
+    // Mux(shift_right, exp + amount, exp - amount) 的低8位
+    s2.exp_resMul_low = (shift_right_low ? el + shift_amount_low : el - shift_amount_low) & 0xff;
+    s2.exp_resMul_high = (shift_right_high ? eh + shift_amount_high : eh - shift_amount_high) & 0xff;
+    s2.resMul_sign_high = s1.res_sign_high;
+    s2.resMul_sign_low = s1.res_sign_low;
+
+    // RTL: input_is_16_S2 / res_is_*_S2 / widen_S2 直接采样 io 上的模式端口
+    s2.input_is_16 = live.is_fp16 || live.is_bf16;
+    s2.res_is_32 = live.is_widen || live.is_fp32;
+    s2.res_is_bf16 = live.is_bf16 && !live.is_widen;
+    s2.res_is_fp16 = live.is_fp16 && !live.is_widen;
+    s2.widen = live.is_widen;
+    s2.c_is_fp16 = s1.is_fp16;
+    s2.c_in = s1.c_in;
+    return s2;
+}
+
+// ===================================================================
+// S2 -> S3: 对阶和加法 (a*b + c)
+// ===================================================================
+FmaRegsS3 fma_s3(const FmaRegsS2& s2, const FmaMode& live) {
+    FmaRegsS3 s3;
+    const uint32_t c = s2.c_in;
+    const bool sign_c_high = bit(c, 31), sign_c_low = bit(c, 15);
+    const bool c_is_32 = !s2.input_is_16 || s2.widen;
+    const bool c_is_fp16 = s2.c_is_fp16;
+
+    // ---- low, high = 0, 1 ----
+    uint32_t exp_in_c[2], frac_c_16[2];
+    exp_in_c[0] = c_is_fp16 && !s2.widen ? bits(c, 14, 10) : bits(c, 14, 7);
+    exp_in_c[1] = c_is_fp16 && !s2.widen ? bits(c, 30, 26) : bits(c, 30, 23);
+    frac_c_16[0] = c_is_fp16 ? bits(c, 9, 0) : bits(c, 6, 0) << 3;
+    frac_c_16[1] = c_is_fp16 ? bits(c, 25, 16) : bits(c, 22, 16) << 3;
+    const uint32_t frac_c_32 = c & 0x7fffff;
+
+    bool exp_is_0_c[2], is_inf_16_c[2];
+    for (int i = 0; i < 2; i++) {
+        exp_is_0_c[i] = exp_in_c[i] == 0;
+        // RTL: exp_is_all1s_c 使用 io 上当前的 is_fp16
+        bool all1s = exp_in_c[i] == (live.is_fp16 ? 0x1fu : 0xffu);
+        is_inf_16_c[i] = all1s && frac_c_16[i] == 0;
+    }
+    const bool is_inf_32_c = exp_in_c[1] == (live.is_fp16 ? 0x1fu : 0xffu) && frac_c_32 == 0;
+    const bool is_inf_high_c = c_is_32 ? is_inf_32_c : is_inf_16_c[1];
+    const bool is_inf_low_c = is_inf_16_c[0];
+
+    bool is_subnorm_zero_c[2] = {!c_is_32 && exp_is_0_c[0], exp_is_0_c[1]};
+    uint32_t exp_adjust_subnorm_c[2], sig_adjust_subnorm_16_c[2];
+    for (int i = 0; i < 2; i++) {
+        exp_adjust_subnorm_c[i] = is_subnorm_zero_c[i] ? 1 : exp_in_c[i];
+        sig_adjust_subnorm_16_c[i] = (is_subnorm_zero_c[i] ? 0 : 1u << 10) | frac_c_16[i];
+    }
+    const uint32_t sig_adjust_subnorm_32_c = (is_subnorm_zero_c[1] ? 0 : 1u << 23) | frac_c_32;
+
+    // ---- 对阶 (9-bit 差值) ----
+    const uint32_t diff_low_c_ab = (exp_adjust_subnorm_c[0] - s2.exp_resMul_low) & 0x1ff;
+    const uint32_t diff_low_ab_c = (s2.exp_resMul_low - exp_adjust_subnorm_c[0]) & 0x1ff;
+    const uint32_t diff_high_c_ab = (exp_adjust_subnorm_c[1] - s2.exp_resMul_high) & 0x1ff;
+    const uint32_t diff_high_ab_c = (s2.exp_resMul_high - exp_adjust_subnorm_c[1]) & 0x1ff;
+
+    // Low: 5-bit shift amount
+    const bool exp_c_gte_ab_low = !bit(diff_low_c_ab, 8);
+    const bool c_dominates_low = exp_c_gte_ab_low && bits(diff_low_c_ab, 7, 5) != 0;
+    const bool ab_dominates_low = !bit(diff_low_ab_c, 8) && bits(diff_low_ab_c, 7, 5) != 0;
+    uint32_t shift_amount_ab_low, shift_amount_c_low;
+    bool shift_ab_low;
+    if (c_dominates_low) {
+        shift_amount_ab_low = 31; shift_amount_c_low = 0; shift_ab_low = true;
+    } else if (ab_dominates_low) {
+        shift_amount_ab_low = 0; shift_amount_c_low = 31; shift_ab_low = false;
+    } else if (exp_c_gte_ab_low) {
+        shift_amount_ab_low = bits(diff_low_c_ab, 4, 0); shift_amount_c_low = 0; shift_ab_low = true;
+    } else {
+        shift_amount_ab_low = 0; shift_amount_c_low = bits(diff_low_ab_c, 4, 0); shift_ab_low = false;
+    }
+    const uint64_t sig_c_low_24 = uint64_t(sig_adjust_subnorm_16_c[0]) << (wResMul16 - 12);
+    const uint64_t shift_out_low = (shift_ab_low ? s2.sig_resMul_low : sig_c_low_24) >>
+                                   (shift_ab_low ? shift_amount_ab_low : shift_amount_c_low);
+
+    // High/whole: 6-bit shift amount
+    const bool exp_c_gte_ab_high = !bit(diff_high_c_ab, 8);
+    const bool c_dominates_high = exp_c_gte_ab_high && bits(diff_high_c_ab, 7, 6) != 0;
+    const bool ab_dominates_high = !bit(diff_high_ab_c, 8) && bits(diff_high_ab_c, 7, 6) != 0;
+    uint32_t shift_amount_ab_high, shift_amount_c_high;
+    bool shift_ab_high;
+    if (c_dominates_high) {
+        shift_amount_ab_high = 63; shift_amount_c_high = 0; shift_ab_high = true;
+    } else if (ab_dominates_high) {
+        shift_amount_ab_high = 0; shift_amount_c_high = 63; shift_ab_high = false;
+    } else if (exp_c_gte_ab_high) {
+        shift_amount_ab_high = bits(diff_high_c_ab, 5, 0); shift_amount_c_high = 0; shift_ab_high = true;
+    } else {
+        shift_amount_ab_high = 0; shift_amount_c_high = bits(diff_high_ab_c, 5, 0); shift_ab_high = false;
+    }
+    const uint64_t sig_c_whole_48 = c_is_32 ? uint64_t(sig_adjust_subnorm_32_c) << (wResMul32 - 25)
+                                            : uint64_t(sig_adjust_subnorm_16_c[1]) << (wResMul32 - 12);
+    const uint64_t shift_out_whole = (shift_ab_high ? s2.sig_resMul_whole : sig_c_whole_48) >>
+                                     (shift_ab_high ? shift_amount_ab_high : shift_amount_c_high);
+
+    // ---- |ab| 与 |c| 比较 ----
+    const bool abs_ab_gt_c_low = bit(diff_low_c_ab, 8) ||
+                                 (diff_low_ab_c == 0 && s2.sig_resMul_low > sig_c_low_24);
+    const bool abs_ab_gt_c_whole = bit(diff_high_c_ab, 8) ||
+                                   (diff_high_ab_c == 0 && s2.sig_resMul_whole > sig_c_whole_48);
+
+    // ---- Adder-48 由两个 Adder-24 组成 ----
+    const uint64_t adderIn_ab_low_24 = shift_ab_low ? shift_out_low : s2.sig_resMul_low;
+    const uint64_t adderIn_c_low_24 = !shift_ab_low ? shift_out_low : sig_c_low_24;
+    const uint64_t adderIn_ab_whole_48 = shift_ab_high ? shift_out_whole : s2.sig_resMul_whole;
+    const uint64_t adderIn_c_whole_48 = !shift_ab_high ? shift_out_whole : sig_c_whole_48;
+
+    const bool ab_c_diffSign_low = s2.resMul_sign_low != sign_c_low;
+    const bool ab_c_diffSign_high = s2.resMul_sign_high != sign_c_high;
+    const uint64_t m16 = mask(wResMul16), m32 = mask(wResMul32);
+
+    // 绝对值较小的一方取反加一
+    const uint64_t ab_low_inv = ab_c_diffSign_low && !abs_ab_gt_c_low ? ~adderIn_ab_low_24 & m16 : adderIn_ab_low_24;
+    const uint64_t c_low_inv = ab_c_diffSign_low && abs_ab_gt_c_low ? ~adderIn_c_low_24 & m16 : adderIn_c_low_24;
+    const uint64_t ab_whole_inv = ab_c_diffSign_high && !abs_ab_gt_c_whole ? ~adderIn_ab_whole_48 & m32 : adderIn_ab_whole_48;
+    const uint64_t c_whole_inv = ab_c_diffSign_high && abs_ab_gt_c_whole ? ~adderIn_c_whole_48 & m32 : adderIn_c_whole_48;
+
+    const uint64_t ab_high_final = ab_whole_inv >> wResMul16;
+    const uint64_t c_high_final = c_whole_inv >> wResMul16;
+    const uint64_t ab_low_final = s2.res_is_32 ? ab_whole_inv & m16 : ab_low_inv;
+    const uint64_t c_low_final = s2.res_is_32 ? c_whole_inv & m16 : c_low_inv;
+
+    const uint64_t cin_low = s2.res_is_32 ? ab_c_diffSign_high : ab_c_diffSign_low;
+    const uint64_t low_temp = ((ab_low_final << 1) | cin_low) + ((c_low_final << 1) | cin_low);
+    const uint64_t low_cout = bit(low_temp, wResMul16 + 1);
+    const uint64_t cin_high = s2.res_is_32 ? low_cout : ab_c_diffSign_high;
+    const uint64_t high_temp = (((ab_high_final << 1) | cin_high) + ((c_high_final << 1) | cin_high)) & mask(wResMul16 + 1);
+
+    s3.adderOut_low = bits(low_temp, wResMul16, 1);
+    s3.adderOut_high = bits(high_temp, wResMul16, 1);
+
+    const bool sign_low = ab_c_diffSign_low ? (abs_ab_gt_c_low ? s2.resMul_sign_low : sign_c_low)
+                                            : (s2.resMul_sign_low && sign_c_low);
+    const bool sign_high = ab_c_diffSign_high ? (abs_ab_gt_c_whole ? s2.resMul_sign_high : sign_c_high)
+                                              : (s2.resMul_sign_high && sign_c_high);
+    s3.adderOut_sign_high = s2.resMul_is_inf_high ? s2.resMul_sign_high : (is_inf_high_c ? sign_c_high : sign_high);
+    s3.adderOut_sign_low = s2.resMul_is_inf_low ? s2.resMul_sign_low : (is_inf_low_c ? sign_c_low : sign_low);
+
+    s3.c_in = c;
+    s3.input_is_16 = s2.input_is_16;
+    s3.res_is_32 = s2.res_is_32;
+    s3.res_is_bf16 = s2.res_is_bf16;
+    s3.res_is_fp16 = s2.res_is_fp16;
+    s3.is_inf_low_c = is_inf_low_c;
+    s3.is_inf_high_c = is_inf_high_c;
+    s3.resMul_is_zero_low = s2.resMul_is_zero_low;
+    s3.resMul_is_zero_high = s2.resMul_is_zero_high;
+    s3.resMul_is_inf_low = s2.resMul_is_inf_low;
+    s3.resMul_is_inf_high = s2.resMul_is_inf_high;
+    s3.resMul_is_subnorm_low = s2.resMul_is_subnorm_low;
+    s3.resMul_is_subnorm_high = s2.resMul_is_subnorm_high;
+    s3.exp_resMul_low = s2.exp_resMul_low;
+    s3.exp_resMul_high = s2.exp_resMul_high;
+    s3.exp_c_low = exp_adjust_subnorm_c[0];
+    s3.exp_c_high = exp_adjust_subnorm_c[1];
+    s3.exp_c_gte_ab_low = exp_c_gte_ab_low;
+    s3.exp_c_gte_ab_high = exp_c_gte_ab_high;
+    return s3;
+}
+
+// ===================================================================
+// S3 -> res_out: 加法结果规格化和舍入 (RNE)
+// ===================================================================
+uint32_t fma_exp_adderOut_low(const FmaRegsS3& s3) {
+    return s3.exp_c_gte_ab_low ? s3.exp_c_low : s3.exp_resMul_low;
+}
+
+uint32_t fma_exp_adderOut_high(const FmaRegsS3& s3) {
+    return s3.exp_c_gte_ab_high ? s3.exp_c_high : s3.exp_resMul_high;
+}
+
+// 舍入一个结果: sig 为规格化后的significand (小数点在最高位之后), man 为尾数位数
+// 返回 {sign, exp, man} 拼接的结果, 并给出舍入导致的溢出
+// target 用于故障注入 (g_fma_round_fault), 正常运行时不起作用
+static uint32_t round_result(uint64_t sig, int w, int man, int exp_bits, bool sign,
+                             uint32_t exp_shifted, bool& is_inf, FmaRoundTarget target) {
+    const FmaRoundFault::Kind fault = g_fma_round_fault.target == target ? g_fma_round_fault.kind
+                                                                         : FmaRoundFault::None;
+    const int lsb_pos = w - 1 - man;
+    const bool lsb = bit(sig, lsb_pos);
+    const bool g = bit(sig, lsb_pos - 1);
+    // bf16 的 sticky 与 fp16 一样覆盖到最低位
+    const bool s = fault != FmaRoundFault::IgnoreSticky && bits(sig, lsb_pos - 2, 0) != 0;
+    const uint64_t sigEff = bits(sig, w - 1, lsb_pos);
+    bool rnd_cin = g && (s || lsb);
+    if (fault == FmaRoundFault::Truncate) rnd_cin = false;
+    if (fault == FmaRoundFault::TiesAway) rnd_cin = g;
+    if (fault == FmaRoundFault::TiesToOdd) rnd_cin = g && (s || !lsb);
+    const uint64_t sigExt = sigEff + rnd_cin;
+    const bool carry = bit(sigExt, man + 1);
+    const uint64_t sig_final = carry ? sigExt >> 1 : sigExt & mask(man + 1);
+    const uint32_t exp_adjust = (exp_shifted + carry + (fault == FmaRoundFault::ExpPlus1) -
+                                 (fault == FmaRoundFault::ExpMinus1)) & 0xff;
+    is_inf = carry && exp_shifted == ((1u << exp_bits) - 2);
+    const uint32_t exp_final = (exp_adjust == 1 && !bit(sig_final, man)) ? 0 : exp_adjust;
+    return (uint32_t(sign) << (exp_bits + man)) | ((exp_final & mask(exp_bits)) << man) |
+           (sig_final & mask(man));
+}
+
+uint32_t fma_res_out(const FmaRegsS3& s3) {
+    const uint32_t exp_adderOut_low = fma_exp_adderOut_low(s3);
+    const uint32_t exp_adderOut_high = fma_exp_adderOut_high(s3);
+    const uint32_t inf_exp = s3.res_is_fp16 ? 0x1f : 0xff;
+    const bool adderOut_is_inf_low = s3.resMul_is_inf_low || s3.is_inf_low_c || exp_adderOut_low == inf_exp;
+    const bool adderOut_is_inf_high = s3.resMul_is_inf_high || s3.is_inf_high_c || exp_adderOut_high == inf_exp;
+
+    const uint64_t whole = (uint64_t(s3.adderOut_high) << wResMul16) | s3.adderOut_low;
+    const uint32_t int_part_low = bits(s3.adderOut_low, wResMul16 - 1, wResMul16 - 2);
+    const uint32_t int_part_high = bits(s3.adderOut_high, wResMul16 - 1, wResMul16 - 2);
+    const uint32_t lzd_low = lzd(bits(s3.adderOut_low, wResMul16 - 3, 0), wResMul16 - 2);
+    const uint32_t lzd_high = lzd(bits(s3.adderOut_high, wResMul16 - 3, 0), wResMul16 - 2);
+    const uint32_t lzd_whole = lzd(bits(whole, wResMul32 - 3, 0), wResMul32 - 2);
+
+    // Low part (5-bit shift amount)
+    bool inf_low_case1 = false, isZero_low = false;
+    uint32_t shift_low, tobe_sub_low;
+    const uint32_t low_over_1 = (exp_adderOut_low - 1) & 0xff;
+    if (int_part_low & 2) {
+        inf_low_case1 = exp_adderOut_low == (s3.res_is_fp16 ? 0x1eu : 0xfeu);
+        shift_low = 0;
+        tobe_sub_low = 0xff;
+    } else if (int_part_low & 1) {
+        shift_low = 1;
+        tobe_sub_low = 0;
+    } else if (low_over_1 <= lzd_low) {
+        shift_low = low_over_1 + 1;
+        tobe_sub_low = low_over_1;
+    } else {
+        shift_low = lzd_low + 2;
+        tobe_sub_low = lzd_low + 1;
+        isZero_low = lzd_low == wResMul16 - 2;
+    }
+    shift_low &= 0x1f;
+
+    // High part (6-bit shift amount)
+    bool inf_high_case1 = false, isZero_high = false;
+    uint32_t shift_high, tobe_sub_high;
+    const uint32_t lzd_hw = s3.res_is_32 ? lzd_whole : lzd_high;
+    const uint32_t high_over_1 = (exp_adderOut_high - 1) & 0xff;
+    if (int_part_high & 2) {
+        inf_high_case1 = exp_adderOut_high == (s3.res_is_fp16 ? 0x1eu : 0xfeu);
+        shift_high = 0;
+        tobe_sub_high = 0xff;
+    } else if (int_part_high & 1) {
+        shift_high = 1;
+        tobe_sub_high = 0;
+    } else if (high_over_1 <= lzd_hw) {
+        shift_high = high_over_1 + 1;
+        tobe_sub_high = high_over_1;
+    } else {
+        shift_high = lzd_hw + 2;
+        tobe_sub_high = lzd_hw + 1;
+        isZero_high = lzd_hw == uint32_t(s3.res_is_32 ? wResMul32 - 2 : wResMul16 - 2);
+    }
+    shift_high &= 0x3f;
+
+    const uint64_t sig_low = shift(s3.adderOut_low, shift_low, false, wResMul16);
+    const uint64_t sig_whole = shift(whole, shift_high, false, wResMul32);
+    const uint64_t sig_high = sig_whole >> wResMul16;
+    const uint32_t exp_shifted_low = (exp_adderOut_low - tobe_sub_low) & 0xff;
+    const uint32_t exp_shifted_high = (exp_adderOut_high - tobe_sub_high) & 0xff;
+
+    bool inf_low_fp16, inf_low_bf16, inf_high_fp16, inf_high_bf16, inf_whole32;
+    const uint32_t fp16_low = round_result(sig_low, wResMul16, 10, 5, s3.adderOut_sign_low, exp_shifted_low, inf_low_fp16, ROUND_FP16_LOW);
+    const uint32_t bf16_low = round_result(sig_low, wResMul16, 7, 8, s3.adderOut_sign_low, exp_shifted_low, inf_low_bf16, ROUND_BF16_LOW);
+    const uint32_t fp16_high = round_result(sig_high, wResMul16, 10, 5, s3.adderOut_sign_high, exp_shifted_high, inf_high_fp16, ROUND_FP16_HIGH);
+    const uint32_t bf16_high = round_result(sig_high, wResMul16, 7, 8, s3.adderOut_sign_high, exp_shifted_high, inf_high_bf16, ROUND_BF16_HIGH);
+    const uint32_t whole32_tmp = round_result(sig_whole, wResMul32, 23, 8, s3.adderOut_sign_high, exp_shifted_high, inf_whole32, ROUND_WHOLE32);
+
+    const uint32_t whole32 = isZero_high ? whole32_tmp & 0x80000000u : whole32_tmp;
+    const uint32_t high16_tmp = s3.res_is_fp16 ? fp16_high : bf16_high;
+    const uint32_t high16 = isZero_high ? high16_tmp & 0x8000 : high16_tmp;
+    const uint32_t low16_tmp = s3.res_is_fp16 ? fp16_low : bf16_low;
+    const uint32_t low16 = isZero_low ? low16_tmp & 0x8000 : low16_tmp;
+
+    const bool isInf_low = adderOut_is_inf_low || inf_low_case1 || (s3.res_is_fp16 ? inf_low_fp16 : inf_low_bf16);
+    const bool isInf_high = adderOut_is_inf_high || inf_high_case1 ||
+                            (s3.res_is_32 ? inf_whole32 : (s3.res_is_fp16 ? inf_high_fp16 : inf_high_bf16));
+    const uint32_t inf16 = s3.res_is_fp16 ? 0x7c00 : 0x7f80;
+
+    const uint32_t out_low16 = s3.resMul_is_zero_low ? (s3.c_in & 0xffff)
+                             : isInf_low ? (uint32_t(s3.adderOut_sign_low) << 15 | inf16) : low16;
+    const uint32_t out_high16 = s3.resMul_is_zero_high ? (s3.c_in >> 16)
+                              : isInf_high ? (uint32_t(s3.adderOut_sign_high) << 15 | inf16) : high16;
+    const uint32_t out_whole32 = s3.resMul_is_zero_high ? s3.c_in
+                               : isInf_high ? (uint32_t(s3.adderOut_sign_high) << 31 | 0x7f800000u) : whole32;
+    return s3.res_is_32 ? out_whole32 : (out_high16 << 16 | out_low16);
+}
+
+// ===================================================================
+// 探针比较
+// ===================================================================
+void fma_core_inputs(const DutInputs& in, FmaMode& mode, uint32_t& a, uint32_t& b, uint32_t& c) {
+    mode = FmaMode{in.is_fp32, in.is_fp16, in.is_bf16, in.is_widen};
+    if (in.is_fp32) {
+        a = in.a_in_32;
+        b = in.b_in_32;
+        c = in.c_in_32;
+    } else {
+        a = uint32_t(in.a_in_16[1]) << 16 | in.a_in_16[0];
+        b = uint32_t(in.b_in_16[1]) << 16 | in.b_in_16[0];
+        c = in.is_widen ? in.c_in_32 : uint32_t(in.c_in_16[1]) << 16 | in.c_in_16[0];
+    }
+}
+
+uint32_t fma_ref_result(const DutInputs& in) {
+    FmaMode mode;
+    uint32_t a, b, c;
+    fma_core_inputs(in, mode, a, b, c);
+    return fma_res_out(fma_s3(fma_s2(fma_s1(mode, a, b, c), mode), mode));
+}
+
+FmaStageProbes fma_stage_ref(const DutInputs& in) {
+    FmaMode mode;
+    uint32_t a, b, c;
+    fma_core_inputs(in, mode, a, b, c);
+    FmaRegsS1 s1 = fma_s1(mode, a, b, c);
+    FmaRegsS2 s2 = fma_s2(s1, mode);
+    FmaRegsS3 s3 = fma_s3(s2, mode);
+
+    FmaStageProbes p{};
+    p.res_intMul_S1 = s1.res_intMul;
+    p.exp_res_adjsubn_low_S1 = s1.exp_res_adjsubn_low;
+    p.exp_res_adjsubn_high_S1 = s1.exp_res_adjsubn_high;
+    p.sig_resMul_low_S2 = s2.sig_resMul_low;
+    p.sig_resMul_whole_S2 = s2.sig_resMul_whole;
+    p.exp_resMul_low_S2 = s2.exp_resMul_low;
+    p.exp_resMul_high_S2 = s2.exp_resMul_high;
+    p.adderOut_low_S3 = s3.adderOut_low;
+    p.adderOut_high_S3 = s3.adderOut_high;
+    p.adderOut_sign_low_S3 = s3.adderOut_sign_low;
+    p.adderOut_sign_high_S3 = s3.adderOut_sign_high;
+    p.exp_adderOut_low_S3 = fma_exp_adderOut_low(s3);
+    p.exp_adderOut_high_S3 = fma_exp_adderOut_high(s3);
+    p.c_in_S1 = s1.c_in;
+    p.c_in_S2 = s2.c_in;
+    p.c_in_S3 = s3.c_in;
+    return p;
+}
+
+bool compare_stage_probes(const DutInputs& in, const FmaStageProbes& dut) {
+    const FmaStageProbes ref = fma_stage_ref(in);
+    struct Row {
+        const char* stage;
+        const char* name;
+        uint64_t dut, ref;
+    };
+    const Row rows[] = {
+        {"S1", "res_intMul_S1", dut.res_intMul_S1, ref.res_intMul_S1},
+        {"S1", "exp_res_adjsubn_low_S1", dut.exp_res_adjsubn_low_S1, ref.exp_res_adjsubn_low_S1},
+        {"S1", "exp_res_adjsubn_high_S1", dut.exp_res_adjsubn_high_S1, ref.exp_res_adjsubn_high_S1},
+        {"S2", "sig_resMul_low_S2", dut.sig_resMul_low_S2, ref.sig_resMul_low_S2},
+        {"S2", "sig_resMul_whole_S2", dut.sig_resMul_whole_S2, ref.sig_resMul_whole_S2},
+        {"S2", "exp_resMul_low_S2", dut.exp_resMul_low_S2, ref.exp_resMul_low_S2},
+        {"S2", "exp_resMul_high_S2", dut.exp_resMul_high_S2, ref.exp_resMul_high_S2},
+        {"S3", "adderOut_low_S3", dut.adderOut_low_S3, ref.adderOut_low_S3},
+        {"S3", "adderOut_high_S3", dut.adderOut_high_S3, ref.adderOut_high_S3},
+        {"S3", "adderOut_sign_low_S3", dut.adderOut_sign_low_S3, ref.adderOut_sign_low_S3},
+        {"S3", "adderOut_sign_high_S3", dut.adderOut_sign_high_S3, ref.adderOut_sign_high_S3},
+        {"S3", "exp_adderOut_low_S3", dut.exp_adderOut_low_S3, ref.exp_adderOut_low_S3},
+        {"S3", "exp_adderOut_high_S3", dut.exp_adderOut_high_S3, ref.exp_adderOut_high_S3},
+    };
+
+    const char* first_bad = nullptr;
+    printf("--- Stage probes (DUT vs reference) ---\n");
+    for (const Row& r : rows) {
+        bool ok = r.dut == r.ref;
+        if (!ok && !first_bad) first_bad = r.stage;
+        printf("%s %-24s DUT 0x%012lx  REF 0x%012lx %s\n", r.stage, r.name,
+               (unsigned long)r.dut, (unsigned long)r.ref, ok ? "" : "<-- MISMATCH");
+    }
+    if (first_bad) {
+        printf("First diverging stage: %s\n", first_bad);
+    } else {
+        printf("All stage probes match; the error is in the S3 normalize/round logic\n");
+    }
+    return first_bad == nullptr;
+}
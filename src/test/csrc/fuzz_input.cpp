@@ -0,0 +1,62 @@
+#include "include/fuzz_input.h"
+#include "include/test_factory.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+
+TestCase decode_fuzz_input(const uint8_t* data, size_t size) {
+    uint8_t buf[kFuzzInputSize] = {0};
+    memcpy(buf, data, std::min(size, kFuzzInputSize));
+
+    auto u16 = [&](int off) { return uint32_t(buf[off] | buf[off + 1] << 8); };
+    auto u32 = [&](int off) { return u16(off) | u16(off + 2) << 16; };
+
+    static const TestMode kModes[5] = {TestMode::FP32, TestMode::FP16, TestMode::BF16,
+                                       TestMode::FP16_Widen, TestMode::BF16_Widen};
+    TestMode mode = kModes[buf[0] % 5];
+    uint32_t ops[6] = {0};
+    if (mode == TestMode::FP16 || mode == TestMode::BF16) {
+        for (int i = 0; i < 6; i++) ops[i] = u16(1 + 2 * i);
+    } else if (mode == TestMode::FP32) {
+        ops[0] = u32(1); ops[1] = u32(5); ops[2] = u32(9);
+    } else {
+        ops[0] = u16(1); ops[1] = u16(3); ops[2] = u32(5);
+    }
+
+    // 与随机测试一致的宽松检查, 只报告真正的错误
+    // (Widen 模式下由检查层退化为ULP检查)
+    return make_test_case(mode, ops, ErrorType::ULP_or_RelativeError);
+}
+
+size_t load_corpus(const char* dir, std::vector<TestCase>& tests) {
+    DIR* d = opendir(dir);
+    if (!d) {
+        return 0;
+    }
+    std::vector<std::string> files;
+    while (struct dirent* ent = readdir(d)) {
+        if (ent->d_name[0] != '.') {
+            files.push_back(std::string(dir) + "/" + ent->d_name);
+        }
+    }
+    closedir(d);
+    std::sort(files.begin(), files.end());
+
+    size_t loaded = 0;
+    for (const std::string& path : files) {
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (!fp) {
+            printf("WARNING: cannot open corpus file %s\n", path.c_str());
+            continue;
+        }
+        uint8_t data[kFuzzInputSize];
+        size_t n = fread(data, 1, sizeof(data), fp);
+        fclose(fp);
+        tests.push_back(decode_fuzz_input(data, n));
+        loaded++;
+    }
+    return loaded;
+}
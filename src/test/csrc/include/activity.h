@@ -0,0 +1,78 @@
+#ifndef __ACTIVITY_H__
+#define __ACTIVITY_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "fma_stages.h"
+
+// ===================================================================
+// 翻转统计 (--activity): 每个时钟沿之后读取 top 的 dbg 端口 (probes=1), 逐位统计流水寄存器和乘法器的翻转
+//   mul_in   IntMUL_12_24 的操作数 (组合输入, 空闲周期的翻转即操作数隔离的收益)
+//   mul_S1   IntMUL_12_24 的进位保留寄存器 (wallaceOutReg)
+//   S1/S2/S3 VFMA_16_32 各级的指数/尾数/c_in 寄存器
+// 寄存器的翻转记到本沿被采样进该级的操作上 (S1 为本沿发射的操作, S2/S3 依次晚一个/两个周期),
+// 按模式和按操作汇总; 没有操作进入时的翻转记为 idle. --saif=PATH 输出整个工作负载的逐位 SAIF
+// (T0/T1/TC, 网名与 Verilog 一致), 可交给功耗工具; 按模式的 SAIF 用单一模式的工作负载得到
+// ===================================================================
+
+enum ActivityGroup { ACT_MUL_IN, ACT_MUL_S1, ACT_S1, ACT_S2, ACT_S3, ACT_GROUPS };
+
+struct ActivitySpec {
+    bool on = false;
+    std::string saif_path;   // 非空: 写 SAIF
+    std::string ops_path;    // 非空: 每个操作一行 CSV (操作序号, 发射周期, 模式, 各组翻转数)
+};
+
+// 解析命令行选项 (--activity / --saif= / --activity-ops=); 识别则返回true
+bool parse_activity_option(const char* arg, ActivitySpec& spec, bool& ok);
+
+class FmaActivity {
+public:
+    static const int kModes = 6; // 按 TestMode 顺序, 最后一个为 idle
+
+    // ops_path 非空时打开每操作 CSV, 失败返回false
+    bool open(const ActivitySpec& spec);
+    // 每个时钟上升沿之后调用: reset/issued/mode 为该沿采样到的 reset、valid_in 和 io 模式端口
+    void update(bool reset, bool issued, const FmaMode& mode, const FmaStageProbes& p);
+    // 打印一个工作负载的翻转统计 (自 open 以来的累计值), 写 SAIF; 写文件失败返回false
+    bool finish(const char* workload);
+
+private:
+    struct Stage {
+        bool valid = false;
+        int mode = 0;
+        uint64_t op = 0;
+    };
+    struct OpRecord {
+        uint64_t cycle = 0;
+        int mode = 0;
+        uint64_t toggles[ACT_GROUPS] = {};
+    };
+
+    void retire(uint64_t op);
+    bool write_saif(const char* path) const;
+    void write_saif_nets(FILE* fp, const char* instance, const char* indent) const;
+
+    ActivitySpec spec_;
+    FILE* ops_file_ = nullptr;
+    bool started_ = false;
+    uint64_t cycles_ = 0;     // 已统计的时钟沿
+    uint64_t issued_ = 0;     // 已发射的操作 (操作序号)
+    Stage pipe_[3];           // 本沿之后 S1/S2/S3 中的操作
+    OpRecord inflight_[4];    // 按操作序号 % 4 存放流水线中操作的翻转
+    uint64_t ops_[kModes] = {};
+    uint64_t toggles_[ACT_GROUPS][kModes] = {};
+    uint64_t enabled_[ACT_GROUPS] = {};    // 该组采样了一个操作的沿数
+    uint64_t quiet_[ACT_GROUPS] = {};      // 其中没有任何位翻转的沿数
+    // 逐位状态: 当前值, 翻转数, 为 1 的周期数, 上次翻转的沿
+    struct Bit {
+        bool value = false;
+        uint64_t tc = 0, t1 = 0, since = 0;
+    };
+    static const int kMaxBits = 512; // 目前共 398 位
+    Bit bits_[kMaxBits];
+};
+
+#endif // __ACTIVITY_H__
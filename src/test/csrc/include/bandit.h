@@ -0,0 +1,29 @@
+#ifndef __BANDIT_H__
+#define __BANDIT_H__
+
+#include <string>
+
+// ===================================================================
+// 按时间预算分配随机向量 (--bandit=SECONDS): 把 random_bands() 的每个 (模式, 指数范围) 组当作
+// 多臂老虎机的一个臂, 每次拉一个臂运行 batch 个单独的测试 (与常规测试相同, 每个向量复位后运行)
+//   收益: 失败或命中新覆盖箱的向量计 1, 否则计 0
+//   覆盖箱: 逐级参考模型上的功能覆盖 (模式, 半路, 乘积为零/无穷/非规格化, c 与 a*b 的指数差,
+//          加法结果的前导零数, 有效减法, 结果类型); coverage=1 构建时再加上 Verilator 行/翻转覆盖点
+//   选择: 折扣 Thompson 采样, 每个臂的命中率服从 Beta 后验, 旧的收益逐次衰减 (覆盖饱和后转向其他臂)
+// 预算用完后报告每个臂最终分到的向量和与固定分配 (create_all_tests 中的 count) 的对比
+// ===================================================================
+
+struct BanditSpec {
+    double budget_s = 0;        // 0: 不运行
+    int batch = 64;             // 每次拉臂运行的向量数
+    std::string failures_path;  // 非空: 失败向量写到该文件 (sim_server 请求行格式, 可用 "file PATH" 回放)
+};
+
+// 解析命令行选项 (--bandit=SECONDS[s|m|h] / --bandit-batch= / --bandit-failures=); 识别则返回true
+bool parse_bandit_option(const char* arg, BanditSpec& spec, bool& ok);
+
+// 没有失败返回true
+class Simulator;
+bool run_bandit(Simulator& sim, const BanditSpec& spec);
+
+#endif // __BANDIT_H__
@@ -0,0 +1,118 @@
+#ifndef __CHECKER_H__
+#define __CHECKER_H__
+
+#include <cstdint>
+#include <cstring>
+
+#include "fp_utils.h"
+#include "test_case.h"
+
+// ===================================================================
+// 结果检查层: 按浮点格式、测试模式和误差类型在编译期特化
+//   通过路径只做整数比较; 只有需要相对误差时才转换为float
+// ===================================================================
+
+// 浮点格式特征 (指数位宽 / 尾数位宽)
+template <int ExpBits, int ManBits>
+struct FpFormat {
+    static constexpr int kExpBits = ExpBits;
+    static constexpr int kManBits = ManBits;
+    static constexpr int kWidth = 1 + ExpBits + ManBits;
+    static constexpr uint32_t kAbsMask = (1u << (kWidth - 1)) - 1;
+};
+
+using FormatFP32 = FpFormat<8, 23>;
+using FormatFP16 = FpFormat<5, 10>;
+using FormatBF16 = FpFormat<8, 7>;
+
+template <class Fmt> inline float fp_value(uint32_t bits);
+template <> inline float fp_value<FormatFP32>(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+template <> inline float fp_value<FormatFP16>(uint32_t bits) { return fp16_to_fp32(bits); }
+template <> inline float fp_value<FormatBF16>(uint32_t bits) { return bf16_to_fp32(bits); }
+
+// 误差容限: 允许的ULP数, 以及相对误差阈值 (尺度 max(|a*b|,|c|) 小于 small_scale 时放宽为 small_rel)
+struct Tolerance {
+    uint32_t max_ulp;
+    float small_scale, small_rel, rel;
+};
+
+// 每种测试模式的格式、通道数和容限
+template <TestMode M> struct ModeTraits;
+template <> struct ModeTraits<TestMode::FP32> {
+    using Fmt = FormatFP32;
+    static constexpr int kLanes = 1;
+    static constexpr bool kHasRelative = true;
+    static constexpr Tolerance tol() { return {8, 1.0f / (1ull << 60), 1e-3f, 1e-5f}; }
+};
+template <> struct ModeTraits<TestMode::FP16> {
+    using Fmt = FormatFP16;
+    static constexpr int kLanes = 2;
+    static constexpr bool kHasRelative = true;
+    static constexpr Tolerance tol() { return {5, 1.0f / (1ull << 10), 1e-2f, 1e-3f}; }
+};
+template <> struct ModeTraits<TestMode::BF16> {
+    using Fmt = FormatBF16;
+    static constexpr int kLanes = 2;
+    static constexpr bool kHasRelative = true;
+    static constexpr Tolerance tol() { return {2, 1.0f / (1ull << 30), 1e-2f, 8e-3f}; }
+};
+// Widen 结果为FP32, 非精确模式下统一按 2 ULP 检查
+template <> struct ModeTraits<TestMode::FP16_Widen> {
+    using Fmt = FormatFP32;
+    static constexpr int kLanes = 1;
+    static constexpr bool kHasRelative = false;
+    static constexpr Tolerance tol() { return {2, 0.0f, 0.0f, 0.0f}; }
+};
+template <> struct ModeTraits<TestMode::BF16_Widen> : ModeTraits<TestMode::FP16_Widen> {};
+
+// 位模式之差 (与原有检查一致, 不处理跨零)
+inline uint32_t ulp_diff(uint32_t a, uint32_t b) { return a > b ? a - b : b - a; }
+
+template <class Fmt>
+inline bool both_zero(uint32_t a, uint32_t b) { return ((a | b) & Fmt::kAbsMask) == 0; }
+
+template <class Fmt>
+inline bool rel_pass(uint32_t dut, uint32_t expected, float scale, const Tolerance& tol) {
+    float diff = fp_value<Fmt>(dut) - fp_value<Fmt>(expected);
+    float limit = (scale < tol.small_scale ? tol.small_rel : tol.rel) * scale;
+    return (diff < 0 ? -diff : diff) < limit;
+}
+
+// 单个结果的检查, 按误差类型特化
+template <class Fmt, ErrorType E> struct LaneCheck;
+
+template <class Fmt> struct LaneCheck<Fmt, ErrorType::Precise> {
+    static bool pass(uint32_t dut, uint32_t expected, float, const Tolerance&) {
+        return (dut == expected) | both_zero<Fmt>(dut, expected);
+    }
+};
+template <class Fmt> struct LaneCheck<Fmt, ErrorType::ULP> {
+    static bool pass(uint32_t dut, uint32_t expected, float, const Tolerance& tol) {
+        return (ulp_diff(dut, expected) <= tol.max_ulp) | both_zero<Fmt>(dut, expected);
+    }
+};
+template <class Fmt> struct LaneCheck<Fmt, ErrorType::RelativeError> {
+    static bool pass(uint32_t dut, uint32_t expected, float scale, const Tolerance& tol) {
+        return LaneCheck<Fmt, ErrorType::Precise>::pass(dut, expected, scale, tol) ||
+               rel_pass<Fmt>(dut, expected, scale, tol);
+    }
+};
+template <class Fmt> struct LaneCheck<Fmt, ErrorType::ULP_or_RelativeError> {
+    static bool pass(uint32_t dut, uint32_t expected, float scale, const Tolerance& tol) {
+        return LaneCheck<Fmt, ErrorType::ULP>::pass(dut, expected, scale, tol) ||
+               rel_pass<Fmt>(dut, expected, scale, tol);
+    }
+};
+
+// 模式不支持相对误差时退化为ULP检查
+template <TestMode M, ErrorType E>
+struct EffectiveError {
+    static constexpr ErrorType value =
+        (ModeTraits<M>::kHasRelative || E == ErrorType::Precise) ? E : ErrorType::ULP;
+};
+
+#endif // __CHECKER_H__
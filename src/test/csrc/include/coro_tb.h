@@ -0,0 +1,128 @@
+#ifndef __CORO_TB_H__
+#define __CORO_TB_H__
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <vector>
+
+#include "test_case.h"
+
+// ===================================================================
+// 基于 C++20 协程的测试平台: 驱动 / 监视 / 计分板各是一个任务 (Task),
+// 在 ClockScheduler 上 co_await 时钟沿, 单线程按注册顺序依次恢复, 不引入额外线程
+//   co_await sched.edge()   挂起到下一个时钟上升沿之后 (输出已更新, 可以设置下一拍的输入)
+//   co_await box.pop()      挂起直到 Mailbox 中有数据 (同一周期内恢复, 不等时钟沿)
+// 时钟沿由构造时传入的回调产生, 可以同时推动多个单元 (例如 Vtop 和 VfmaModel)
+// ===================================================================
+
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() { return Task(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task(Task&& o) noexcept : h_(o.h_) { o.h_ = nullptr; }
+    Task(const Task&) = delete;
+    ~Task() {
+        if (h_) h_.destroy();
+    }
+    Handle release() {
+        Handle h = h_;
+        h_ = nullptr;
+        return h;
+    }
+
+private:
+    explicit Task(Handle h) : h_(h) {}
+    Handle h_;
+};
+
+class ClockScheduler {
+public:
+    explicit ClockScheduler(std::function<void()> clock_edge) : clock_edge_(std::move(clock_edge)) {}
+    ~ClockScheduler();
+
+    // daemon: 监视器一类的无限循环任务, 不阻止 run() 结束
+    void spawn(Task task, bool daemon = false);
+    // 运行到所有非 daemon 任务结束; 超过 max_cycles 个时钟沿返回false
+    bool run(uint64_t max_cycles);
+    uint64_t cycle() const { return cycle_; }
+
+    auto edge() {
+        struct Awaiter {
+            ClockScheduler& s;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { s.on_edge_.push_back(h); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+    // 本周期内稍后恢复 (Mailbox 唤醒等待者时使用)
+    void wake(std::coroutine_handle<> h) { ready_.push_back(h); }
+
+private:
+    void run_ready();
+
+    std::function<void()> clock_edge_;
+    std::vector<Task::Handle> tasks_;
+    std::vector<bool> daemon_;
+    std::vector<std::coroutine_handle<>> on_edge_;
+    std::deque<std::coroutine_handle<>> ready_;
+    uint64_t cycle_ = 0;
+};
+
+// 任务之间的单生产者/单消费者队列
+template <class T>
+class Mailbox {
+public:
+    explicit Mailbox(ClockScheduler& sched) : sched_(sched) {}
+
+    void push(T v) {
+        items_.push_back(std::move(v));
+        if (waiter_) {
+            sched_.wake(waiter_);
+            waiter_ = nullptr;
+        }
+    }
+    bool empty() const { return items_.empty(); }
+
+    auto pop() {
+        struct Awaiter {
+            Mailbox& m;
+            bool await_ready() const noexcept { return !m.items_.empty(); }
+            void await_suspend(std::coroutine_handle<> h) { m.waiter_ = h; }
+            T await_resume() {
+                T v = std::move(m.items_.front());
+                m.items_.pop_front();
+                return v;
+            }
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    ClockScheduler& sched_;
+    std::deque<T> items_;
+    std::coroutine_handle<> waiter_ = nullptr;
+};
+
+// 协程测试平台的激励: 背靠背 (每周期一个操作) 或以 bubble_pct% 的概率插入空闲周期
+struct CoroStimulus {
+    int bubble_pct = 0;
+};
+bool parse_coro_option(const char* arg, CoroStimulus& stim, bool& ok);
+
+// 同一时钟驱动 Vtop 和 VfmaModel 两个单元: 驱动任务发射 tests, 两个监视任务采样 valid_out,
+// 计分板逐个比较两者的结果和输出周期, 并对没有受到后续模式变化影响的操作用 TestCase 检查结果
+class Simulator;
+bool run_coro_testbench(Simulator& sim, const std::vector<TestCase>& tests, const CoroStimulus& stim);
+
+#endif // __CORO_TB_H__
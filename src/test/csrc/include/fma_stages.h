@@ -0,0 +1,104 @@
+#ifndef __FMA_STAGES_H__
+#define __FMA_STAGES_H__
+
+#include <cstdint>
+
+#include "test_case.h"
+
+// ===================================================================
+// VFMA_16_32 的逐级参考模型 (wResMul32 = 48)
+//   与 RTL 逐信号对应, 位宽和回绕行为与 Chisel 代码一致, 用于定位出错的流水级
+//   FmaRegsS1/S2/S3 对应各级流水寄存器, fma_sN() 为上一级寄存器到本级寄存器的组合逻辑
+// ===================================================================
+
+// io 上的模式端口
+struct FmaMode {
+    bool is_fp32, is_fp16, is_bf16, is_widen;
+};
+
+// S1 寄存器 (io.valid_in 采样, 包括 IntMUL_12_24 的乘积)
+struct FmaRegsS1 {
+    bool input_is_16, res_is_32, res_is_bf16, res_is_fp16, widen;
+    bool is_zero_16[4], is_zero_32[2], is_inf_16[4], is_inf_32[2];
+    uint32_t exp_res_adjsubn_high, exp_res_adjsubn_low; // 10 bits
+    bool res_is_inf_high, res_is_inf_low;
+    bool res_sign_high, res_sign_low;
+    bool is_fp16;                                       // c_is_fp16 的第一级
+    uint64_t res_intMul;                                // 48 bits
+    uint32_t c_in;
+};
+
+// S2 寄存器 (valid_S1 采样)
+struct FmaRegsS2 {
+    bool input_is_16, res_is_32, res_is_bf16, res_is_fp16, widen;
+    bool resMul_sign_high, resMul_sign_low;
+    bool resMul_is_zero_low, resMul_is_zero_high;
+    bool resMul_is_inf_low, resMul_is_inf_high;
+    bool resMul_is_subnorm_low, resMul_is_subnorm_high;
+    uint32_t sig_resMul_low;   // 24 bits
+    uint64_t sig_resMul_whole; // 48 bits
+    uint32_t exp_resMul_low, exp_resMul_high; // 8 bits
+    bool c_is_fp16;
+    uint32_t c_in;
+};
+
+// S3 寄存器 (valid_S2 采样)
+struct FmaRegsS3 {
+    uint32_t c_in;
+    bool input_is_16, res_is_32, res_is_bf16, res_is_fp16;
+    bool is_inf_low_c, is_inf_high_c;
+    bool resMul_is_zero_low, resMul_is_zero_high;
+    bool resMul_is_inf_low, resMul_is_inf_high;
+    bool resMul_is_subnorm_low, resMul_is_subnorm_high;
+    uint32_t adderOut_low, adderOut_high; // 24 bits
+    bool adderOut_sign_low, adderOut_sign_high;
+    uint32_t exp_resMul_low, exp_resMul_high, exp_c_low, exp_c_high; // 8 bits
+    bool exp_c_gte_ab_low, exp_c_gte_ab_high;
+};
+
+// live: 本级采样时 io 模式端口的值 (RTL 中部分S2寄存器直接采样io, 见 fma_s2)
+FmaRegsS1 fma_s1(const FmaMode& mode, uint32_t a_in, uint32_t b_in, uint32_t c_in);
+FmaRegsS2 fma_s2(const FmaRegsS1& s1, const FmaMode& live);
+FmaRegsS3 fma_s3(const FmaRegsS2& s2, const FmaMode& live);
+uint32_t fma_res_out(const FmaRegsS3& s3);
+// S3 寄存器之后的指数 Mux(exp_c_gte_ab, exp_c, exp_resMul)
+uint32_t fma_exp_adderOut_low(const FmaRegsS3& s3);
+uint32_t fma_exp_adderOut_high(const FmaRegsS3& s3);
+
+// 舍入故障注入 (变异测试, 见 mutation.h): 只影响 target 指定的那一路舍入, 默认关闭
+enum FmaRoundTarget { ROUND_FP16_LOW, ROUND_BF16_LOW, ROUND_FP16_HIGH, ROUND_BF16_HIGH, ROUND_WHOLE32, ROUND_TARGETS };
+struct FmaRoundFault {
+    enum Kind { None, Truncate, TiesAway, TiesToOdd, IgnoreSticky, ExpPlus1, ExpMinus1, Kinds };
+    Kind kind = None;
+    int target = -1;
+};
+extern FmaRoundFault g_fma_round_fault;
+
+// top 的 dbg 端口 (VParams.debugMode), 与 VFMAStageProbes 一一对应
+struct FmaStageProbes {
+    uint64_t res_intMul_S1;
+    uint32_t exp_res_adjsubn_low_S1, exp_res_adjsubn_high_S1;
+    uint32_t sig_resMul_low_S2;
+    uint64_t sig_resMul_whole_S2;
+    uint32_t exp_resMul_low_S2, exp_resMul_high_S2;
+    uint32_t adderOut_low_S3, adderOut_high_S3;
+    bool adderOut_sign_low_S3, adderOut_sign_high_S3;
+    uint32_t exp_adderOut_low_S3, exp_adderOut_high_S3;
+    // 只用于翻转统计 (activity.h), 不参与逐级比较
+    uint32_t mul_a_in, mul_b_in;          // 24 bits
+    uint64_t mul_sum_S1, mul_carry_S1;    // 48 bits
+    uint32_t c_in_S1, c_in_S2, c_in_S3;
+};
+
+// top 送给 VFMA_16_32 的 a/b/c (与 top_fma.scala 中的拼接一致)
+void fma_core_inputs(const DutInputs& in, FmaMode& mode, uint32_t& a, uint32_t& b, uint32_t& c);
+
+// 单个操作(模式保持不变)流过整条流水线后各级探针的期望值
+FmaStageProbes fma_stage_ref(const DutInputs& in);
+// 单个操作(模式保持不变)的 res_out, 与 RTL 逐位一致
+uint32_t fma_ref_result(const DutInputs& in);
+
+// 逐级比较 DUT 探针和参考值, 打印对照表并指出第一个出错的流水级; 全部一致返回true
+bool compare_stage_probes(const DutInputs& in, const FmaStageProbes& dut);
+
+#endif // __FMA_STAGES_H__
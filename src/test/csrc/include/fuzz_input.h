@@ -0,0 +1,25 @@
+#ifndef __FUZZ_INPUT_H__
+#define __FUZZ_INPUT_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "test_case.h"
+
+// ===================================================================
+// 模糊测试输入的解码, 由 libFuzzer 入口 (src/test/fuzz) 和
+// 常规运行的语料回放共用
+//   字节0:    测试模式 (mode % 5: FP32/FP16/BF16/FP16_Widen/BF16_Widen)
+//   字节1~12: 操作数位模式 (小端), 按模式依次取 a,b,c (双路时为两组)
+//   输入不足 kFuzzInputSize 字节时补0, 多余字节忽略
+// ===================================================================
+constexpr size_t kFuzzInputSize = 13;
+
+TestCase decode_fuzz_input(const uint8_t* data, size_t size);
+
+// 读取语料目录下的每个文件并解码为测试用例 (按文件名排序)
+// 目录不存在时不报错, 返回读取的文件数
+size_t load_corpus(const char* dir, std::vector<TestCase>& tests);
+
+#endif // __FUZZ_INPUT_H__
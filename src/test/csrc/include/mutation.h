@@ -0,0 +1,27 @@
+#ifndef __MUTATION_H__
+#define __MUTATION_H__
+
+#include <vector>
+
+#include "test_case.h"
+
+// ===================================================================
+// 变异评分的冒烟测试集
+//   在逐级参考模型 (fma_stages.h, 与 RTL 逐位等价, 见 --equiv) 上注入系统的变异体:
+//     - 流水寄存器 S1/S2/S3 各字段逐位 stuck-at-0/1
+//     - 指数字段 +1/-1
+//     - 五路舍入各自的舍入判断错误 (截断, 就近舍入到远离0/奇数, 忽略 sticky) 和指数调整 ±1
+//   每个向量单独流过流水线, 结果与未变异的结果不同即杀死该变异体;
+//   记录杀死矩阵后贪心选出能杀死同样变异体的最小向量集, 写成冒烟测试文件:
+//     <mode> <操作数...> <期望的 res_out_32>    (操作数格式同 sim_server 的请求行)
+// ===================================================================
+
+class Simulator;
+
+// 对 tests 做变异分析, 把选出的向量写入 path; 成功返回true
+bool build_smoke_suite(const std::vector<TestCase>& tests, const char* path, unsigned seed);
+
+// 逐个运行冒烟测试文件中的向量, 逐位比较 res_out_32; 全部通过返回true
+bool run_smoke_suite(Simulator& sim, const char* path);
+
+#endif // __MUTATION_H__
@@ -0,0 +1,26 @@
+#ifndef __OCCUPANCY_H__
+#define __OCCUPANCY_H__
+
+#include <cstdint>
+
+// ===================================================================
+// 流水线占用计数器: top 的 perf_* 端口 (VFMAPerfCounters, 需要 VParams.debugMode = true)
+// 或 VfmaModel 的同名软件计数器. 计数为已经过的非复位时钟沿 (不含尚未结束的当前周期); 硬件计数器复位清零,
+// 驱动方在每次复位前把它们累加进总数, 因此一个工作负载的计数为前后两次快照之差
+// ===================================================================
+struct FmaOccupancy {
+    uint64_t cycles = 0;
+    uint64_t active = 0;   // 至少一级有效的周期
+    uint64_t busy[3] = {}; // valid_S1/S2/S3 为高的周期
+    uint64_t issue_fp32 = 0, issue_fp16 = 0, issue_bf16 = 0, issue_widen = 0;
+
+    FmaOccupancy& operator+=(const FmaOccupancy& o);
+    FmaOccupancy operator-(const FmaOccupancy& o) const;
+    bool operator==(const FmaOccupancy& o) const;
+};
+
+// 打印一个工作负载的利用率: 各级占用, 气泡比例 (流水线非空时空着的级),
+// 每种模式的发射占比, uop/周期 和 FMA/周期 (fp16/bf16 每个 uop 两个 FMA)
+void report_occupancy(const char* workload, const FmaOccupancy& occ);
+
+#endif // __OCCUPANCY_H__
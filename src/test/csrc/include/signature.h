@@ -0,0 +1,26 @@
+#ifndef __SIGNATURE_H__
+#define __SIGNATURE_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "test_case.h"
+
+// ===================================================================
+// 输出签名: 把每个输出 (出现的周期, res_out_32, res_out_16_0/1) 折叠进每种模式
+// 一个滚动的 128 位哈希, 用来快速判断 RTL 修改前后输出是否逐位一致
+//   基线文件记录种子, 测试数, 每种模式的哈希以及每 every 个输出一个检查点 (哈希前缀),
+//   哈希不同时由第一个不同的检查点给出第一个出错的测试所在的范围 (every = 1 时精确到单个测试)
+// ===================================================================
+struct Signature128 {
+    uint64_t h[2] = {0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull};
+    void fold(uint64_t w);
+};
+
+class Simulator;
+// 背靠背运行 tests 并计算签名; 基线文件不存在或 update 时写入基线, 否则与基线比较
+// 一致 (或写入了基线) 返回true
+bool run_signature(Simulator& sim, const std::vector<TestCase>& tests, const char* path,
+                   unsigned seed, int every, bool update);
+
+#endif // __SIGNATURE_H__
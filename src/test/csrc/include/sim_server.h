@@ -0,0 +1,26 @@
+#ifndef __SIM_SERVER_H__
+#define __SIM_SERVER_H__
+
+// ===================================================================
+// 常驻仿真服务: 在 Unix socket 上接收测试批次, 复用预先构造好的 Simulator
+// 每个 Simulator 由一个工作线程独占, 同一时刻每个线程服务一个连接
+//
+// 请求 (按行, '#' 开头为注释):
+//   <mode> <a> <b> <c> [<a2> <b2> <c2>]   加入一个操作, 操作数为十六进制位模式
+//                                         mode: fp32|fp16|bf16|fp16_widen|bf16_widen
+//                                         fp16/bf16 双路需要6个操作数
+//   err <precise|ulp|rel|ulp_rel>         之后加入的操作使用的误差类型 (默认 ulp)
+//   file <path>                           读入黄金向量文件 (每行格式同上)
+//   end                                   执行当前批次并返回结果
+//   quit                                  关闭连接
+//   shutdown                              停止服务
+// 应答:
+//   <idx> <P|F|T> <res>...                每个操作一行: 通过/失败/超时, DUT结果 (十六进制)
+//   done <ops> <failed> <cycles>          批次结束
+//   error <line> <message>                该行被忽略
+// ===================================================================
+
+// 阻塞运行直到收到 shutdown; 出错返回false
+bool run_sim_server(const char* socket_path, int num_sims, int argc, char* argv[]);
+
+#endif // __SIM_SERVER_H__
@@ -1,12 +1,22 @@
 #ifndef __SIMULATOR_H__
 #define __SIMULATOR_H__
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 #include "test_case.h"
+#include "occupancy.h"
+#ifdef FMA_PROBES
+#include "fma_stages.h"
+#endif
 
 // 前向声明Verilator相关类
 class Vtop;
 class VerilatedContext;
+class FmaActivity;
+class VectorCache;
 
 #ifdef VCD
 class VerilatedVcdC;
@@ -17,20 +27,81 @@ class VerilatedVcdC;
 // ===================================================================
 class Simulator {
 public:
-    Simulator(int argc, char* argv[]);
+    // vcd: VCD 构建 (vcd=1) 中是否记录 build/fma/top.vcd; 同时存在多个实例时只应有一个记录
+    Simulator(int argc, char* argv[], bool vcd = true);
     ~Simulator();
 
     bool run_test(const TestCase& test);
     void reset(int n);
+    // 发射单个操作并等待结果 (不复位DUT), 超时返回false
+    bool run_op(const DutInputs& in, DutOutputs& out);
+    // verbose: 每个测试都打印输入和检查结果 (默认只在失败时打印)
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    // 背靠背发射(每周期一个操作), 不经过TestCase, 返回消耗的周期数
+    uint64_t run_stream(const StreamSource& source, const StreamSink& sink);
+    uint64_t cycles() const { return cycles_; }
+
+#ifdef FMA_PROBES
+    // 读取 top 的 dbg 端口 (流水级探针, 需要 VParams.debugMode = true)
+    FmaStageProbes sample_probes() const;
+#endif
+
+    // 已验证向量缓存 (--vcache, nullptr 不使用): run_test 和 run_cached_op 先查缓存, 未命中时仿真并记录
+    void set_vcache(VectorCache* cache) { vcache_ = cache; }
+    // 单个独立操作: 缓存命中时不仿真 (hit = true), 否则 (reset_first 时先复位) 同 run_op; 超时返回false
+    bool run_cached_op(const DutInputs& in, DutOutputs& out, bool reset_first, bool& hit);
+
+    // 之后每个时钟沿把 dbg 端口交给 act 统计翻转 (nullptr 停止); 没有 dbg 端口 (probes=0) 时返回false
+    bool set_activity(FmaActivity* act);
+
+    // top 的 perf 端口自构造以来的累计值 (含每次复位前的计数); 没有 perf 端口 (probes=0) 时返回false
+    bool occupancy(FmaOccupancy& occ) const;
+
+#if VM_COVERAGE
+    // Verilator --coverage 的行/翻转计数器, 经 VerilatedCovContext 导出, 每个覆盖点一项 (同一模型中下标固定);
+    // 复位不清零, zero = true 时读完清零 (下次得到增量). 导出要写文件, 较慢; 失败返回false
+    bool coverage_counters(std::vector<uint64_t>& counts, bool zero);
+    // 同一组计数器在内存中的数组 (生成的符号表 Vtop__Syms::__Vcoverage, 只在这里访问), 每次输入都要读的
+    // 模糊测试使用; 下标与 coverage_counters 不同, 两者不能混用
+    const uint32_t* coverage_array(size_t& n) const;
+#endif
+
+    // Verilator --savable 检查点 (make savable=1): DUT 全部状态、仿真时间和周期数; 未启用时返回false
+    bool save(const char* path);
+    bool restore(const char* path);
+    // VCD 构建 (vcd=1) 中暂停/恢复波形记录, 默认记录 (构造时 vcd = false 则始终不记录)
+    void set_trace(bool on) { trace_on_ = on; }
+
+    // 逐周期驱动接口 (协程测试平台使用): 设置输入 / 只拉低valid_in (保持模式) / 推进一个时钟 / 读输出
+    void drive(const DutInputs& in);
+    void idle();
+    void step() { single_cycle(); }
+    bool valid_out() const;
+    DutOutputs sample() const;
 
 private:
     void init_vcd();
     void single_cycle();
-    
+
     // Verilator核心对象
     std::unique_ptr<VerilatedContext> contextp_;
     std::unique_ptr<Vtop> top_;
 
+    // 已仿真的时钟周期数
+    uint64_t cycles_ = 0;
+    // 之前各次复位清掉的 perf 计数
+    FmaOccupancy occupancy_base_;
+    bool reset_done_ = false;
+    bool verbose_ = false;
+    bool trace_on_ = true;
+    FmaActivity* activity_ = nullptr;
+    VectorCache* vcache_ = nullptr;
+#if VM_COVERAGE
+    // coverage_counters 导出用的临时文件
+    std::string cov_path_;
+#endif
+
     // VCD波形跟踪器
 #ifdef VCD
     VerilatedVcdC* tfp_ = nullptr;
@@ -0,0 +1,33 @@
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+#include <cstdint>
+#include <string>
+
+// ===================================================================
+// 长时间随机扫描 (--sweep=N): 一个 Simulator 上背靠背运行 N 个随机向量, 与逐级参考模型逐位比较
+//   每个块 (kSweepChunk 个操作) 使用同一模式, 块之间排空流水线, 因此每个结果都与单独运行一致
+//   --ckpt=DIR 时每 ckpt_every 个操作写一个检查点: Vtop 状态 (Verilator --savable, make savable=1)
+//   加上扫描游标、失败计数和随机数状态. 同一命令再次运行时从 DIR 中最新的检查点继续;
+//   只保留最新的检查点和其后区间内出现过失败的检查点, 失败向量记录在 DIR/failures.txt
+//   --replay=OP 恢复 OP 之前最近的检查点, 打开波形只重新运行到 OP 所在的块为止
+// ===================================================================
+
+static const uint64_t kSweepChunk = 1024;
+
+struct SweepSpec {
+    uint64_t ops = 0;              // 0: 不运行扫描
+    std::string ckpt_dir;          // 空: 不写检查点
+    uint64_t ckpt_every = 1 << 20; // 按块对齐
+    bool replay = false;
+    uint64_t replay_op = 0;
+};
+
+// 解析命令行选项 (--sweep= / --ckpt= / --ckpt-every= / --replay=); 识别则返回true
+bool parse_sweep_option(const char* arg, SweepSpec& spec, bool& ok);
+
+// seed 只在新的扫描中使用, 从检查点继续时沿用检查点中的随机数状态; 全部通过返回true
+class Simulator;
+bool run_sweep(Simulator& sim, const SweepSpec& spec, unsigned seed);
+
+#endif // __SWEEP_H__
@@ -0,0 +1,80 @@
+#ifndef __TENSOR_TRACE_H__
+#define __TENSOR_TRACE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "test_case.h"
+
+class Simulator;
+
+// 张量元素的数据类型
+enum class TensorDType {
+    FP32,
+    FP16,
+    BF16
+};
+
+// ===================================================================
+// MappedTensor 类: 以 mmap 方式只读映射 .npy 或 raw 二进制张量
+//   .npy: 支持 '<f4' (fp32), '<f2' (fp16), '<u2'/'<i2'/'|V2' (按bf16解释)
+//   raw:  按 dtype 解释整个文件, 形状视为一维
+// 元素按位读取, 不做任何拷贝
+// ===================================================================
+class MappedTensor {
+public:
+    MappedTensor() = default;
+    ~MappedTensor();
+    MappedTensor(const MappedTensor&) = delete;
+    MappedTensor& operator=(const MappedTensor&) = delete;
+
+    // dtype_override: raw 文件必须给出; 对 .npy 则用于重新解释16位元素 (如 '<u2' -> bf16)
+    bool open(const std::string& path, const TensorDType* dtype_override);
+
+    size_t size() const { return count_; }
+    TensorDType dtype() const { return dtype_; }
+    const std::vector<size_t>& shape() const { return shape_; }
+
+    // 读取第 i 个元素的原始位模式 (fp32为32位, fp16/bf16为低16位)
+    uint32_t bits(size_t i) const {
+        return dtype_ == TensorDType::FP32 ? reinterpret_cast<const uint32_t*>(data_)[i]
+                                           : reinterpret_cast<const uint16_t*>(data_)[i];
+    }
+
+private:
+    bool parse_npy_header(const std::string& path, const TensorDType* dtype_override);
+
+    void* map_ = nullptr;
+    size_t map_len_ = 0;
+    const uint8_t* data_ = nullptr;
+    size_t count_ = 0;
+    TensorDType dtype_ = TensorDType::FP32;
+    std::vector<size_t> shape_;
+};
+
+// 张量到 a/b/c 流的组合方式
+enum class TraceLayout {
+    Elementwise, // r[i]    = a[i] * b[i] + c[i]
+    OuterProduct, // r[i,j]  = a[i] * b[j] + c[i,j]
+    GemmTile     // C[M,N] += A[M,K] * B[K,N], 沿K方向逐次累加
+};
+
+struct TraceSpec {
+    std::string a_path, b_path, c_path; // c_path 可为空 (c视为0)
+    bool has_dtype = false;
+    TensorDType dtype = TensorDType::FP32; // raw文件的元素类型 / .npy 16位元素的解释方式
+    bool has_mode = false;
+    TestMode mode = TestMode::FP32;       // 缺省时由a的类型推断
+    TraceLayout layout = TraceLayout::Elementwise;
+    size_t M = 0, N = 0, K = 0;           // GemmTile 的形状
+};
+
+// 解析命令行选项 (--trace-a= 等); 识别则返回true
+bool parse_trace_option(const char* arg, TraceSpec& spec, bool& ok);
+
+// 将张量流经DUT, 统计吞吐和相对于双精度参考的误差; 出错返回false
+bool run_tensor_trace(Simulator& sim, const TraceSpec& spec);
+
+#endif // __TENSOR_TRACE_H__
@@ -2,6 +2,7 @@
 #define __TEST_CASE_H__
 
 #include <cstdint>
+#include <functional>
 
 #include "fp_utils.h"
 
@@ -46,6 +47,13 @@ enum class ErrorType {
     ULP_or_RelativeError // 允许若干 ulp 或 相对误差
 };
 
+// DUT 输入端口的取值（控制信号 + 数据），由 Simulator 直接驱动到 Vtop
+struct DutInputs {
+    bool is_fp32, is_fp16, is_bf16, is_widen;
+    uint32_t a_in_32, b_in_32, c_in_32;
+    uint16_t a_in_16[2], b_in_16[2], c_in_16[2];
+};
+
 // 用于从仿真器传递DUT输出到TestCase进行检查的结构体
 struct DutOutputs {
     uint32_t res_out_32;
@@ -53,6 +61,15 @@ struct DutOutputs {
     uint16_t res_out_16_1;
 };
 
+// 流式仿真的数据源/接收端
+// source: 填充下一个操作并返回true; 没有更多操作时返回false
+// sink:   按发射顺序依次接收DUT输出
+using StreamSource = std::function<bool(DutInputs&)>;
+using StreamSink = std::function<void(const DutOutputs&)>;
+
+// 参考模型 (期望结果, 检查器, 端口取值) 的版本, 改变其行为时加一; 向量缓存 (vcache.h) 的键包含该版本
+constexpr int kGoldenModelVersion = 1;
+
 // ===================================================================
 // TestCase 类: 封装单个测试用例
 // ===================================================================
@@ -74,7 +91,10 @@ public:
     TestCase(const FMA_Operands_BF16_Widen& ops_widen, ErrorType error_type = ErrorType::ULP);
     
     void print_details() const;
-    bool check_result(const DutOutputs& dut_res) const;
+    // 检查DUT结果; 只在失败(或verbose)时打印诊断信息
+    bool check_result(const DutOutputs& dut_res, bool verbose = false) const;
+    // 按测试模式生成DUT端口取值
+    DutInputs dut_inputs() const;
 
     TestMode mode;
     ErrorType error_type;
@@ -105,6 +125,14 @@ private:
     uint32_t expected_res_fp32;
     uint16_t expected_res1_fp16, expected_res2_fp16;
     uint16_t expected_res1_bf16, expected_res2_bf16;
+
+    // 相对误差的尺度 max(|a*b|, |c|)，构造时预先计算 (FP32/Widen 只用[0])
+    float rel_scale[2];
+
+    // 按 (模式, 误差类型) 编译期特化的检查函数, 见 checker.h
+    template <TestMode M, ErrorType E>
+    bool check_impl(const DutOutputs& dut_res) const;
+    void report_result(const DutOutputs& dut_res, bool pass) const;
 };
 
 #endif // __TEST_CASE_H__ 
\ No newline at end of file
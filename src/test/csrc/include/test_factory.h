@@ -1,10 +1,35 @@
 #ifndef __TEST_FACTORY_H__
 #define __TEST_FACTORY_H__
 
+#include <cstdio>
 #include <vector>
 #include "test_case.h"
 
 // Creates and returns a vector of all test cases.
 std::vector<TestCase> create_all_tests();
 
+// One group of random vectors: a mode and the exponent ranges of its operands.
+// create_all_tests() generates `count` vectors per band; --bandit allocates simulation time across them.
+struct RandomBand {
+    TestMode mode;
+    const char* name;
+    int count;
+    TestCase (*gen)();
+};
+const std::vector<RandomBand>& random_bands();
+
+// Inverse of parse_test_mode
+const char* test_mode_name(TestMode mode);
+// Writes the operands in the sim server request format: a b c (fp32), a1 b1 c1 a2 b2 c2 (fp16/bf16), a b c32 (widen)
+void write_test_operands(FILE* fp, const TestCase& t);
+
+// Builds a test case from raw operand bits.
+// ops: a,b,c (FP32 / widen: a,b 16-bit, c 32-bit) or a1,b1,c1,a2,b2,c2 (FP16/BF16 dual)
+TestCase make_test_case(TestMode mode, const uint32_t ops[6], ErrorType error_type);
+
+// Parses fp32|fp16|bf16|fp16_widen|bf16_widen
+bool parse_test_mode(const char* s, TestMode& mode);
+// Parses precise|ulp|rel|ulp_rel
+bool parse_error_type(const char* s, ErrorType& error_type);
+
 #endif // __TEST_FACTORY_H__ 
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef __TRAFFIC_H__
+#define __TRAFFIC_H__
+
+#include <string>
+#include <vector>
+
+#include "test_case.h"
+
+// ===================================================================
+// 流量模型: 按真实调度器的发射方式产生 valid_in 序列, 同时驱动 Vtop 和 VfmaModel
+//   b2b             每周期发射一个操作
+//   bernoulli:P     每周期以 P% 的概率发射
+//   bursty:ON,OFF   开/关两种状态交替, 长度服从均值为 ON / OFF 周期的几何分布, 只在开状态发射
+//   trace:PATH      按记录的发射时间线回放, 每行 "<周期> [模式]" (模式缺省时按 mix 选取)
+// 每个模型可以带自己的模式比例: --traffic=MODEL@fp32:W,fp16:W,bf16:W,fp16w:W,bf16w:W
+// ===================================================================
+
+enum class TrafficKind {
+    BackToBack,
+    Bernoulli,
+    Bursty,
+    Trace
+};
+
+// 空闲周期 (valid_in 为低) 时模式和数据端口的取值
+enum class IdlePolicy {
+    Hold,   // 保持上一个发射的操作 (Simulator::idle)
+    Next,   // 提前给出下一个操作的模式和数据, 只拉低 valid_in
+    Random  // 任意合法模式和随机数据
+};
+
+struct TrafficModel {
+    TrafficKind kind = TrafficKind::BackToBack;
+    int issue_pct = 100;          // Bernoulli
+    double mean_on = 8, mean_off = 8; // Bursty
+    std::string trace_path;       // Trace
+    double mix[5] = {1, 1, 1, 1, 1}; // 按 TestMode 顺序的权重
+    std::string name;             // 命令行中的原文, 用于报告
+};
+
+struct TrafficSpec {
+    std::vector<TrafficModel> models;
+    IdlePolicy idle = IdlePolicy::Hold;
+    size_t ops = 0;               // 每个模型发射的操作数, 0: 与测试用例数相同 (trace 由文件决定)
+    std::string record_path;      // 非空: 把发射时间线写到 PATH (多个模型时为 PATH.<序号>), 可用 trace: 回放
+};
+
+// 解析命令行选项 (--traffic= / --traffic-idle= / --traffic-ops= / --traffic-record=); 识别则返回true
+bool parse_traffic_option(const char* arg, TrafficSpec& spec, bool& ok);
+
+// 依次运行每个流量模型: 报告达到的 ops/cycle、延迟分布, 以及结果与单独运行时不同的操作
+// (S2/S3 在发射后采样 io 模式端口, 空闲周期或后续操作改变模式时流水线中的操作会受影响);
+// Vtop 与 VfmaModel 不一致, 或模式未变化的操作结果错误时返回false
+class Simulator;
+bool run_traffic(Simulator& sim, const std::vector<TestCase>& tests, const TrafficSpec& spec);
+
+#endif // __TRAFFIC_H__
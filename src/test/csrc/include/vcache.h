@@ -0,0 +1,46 @@
+#ifndef __VCACHE_H__
+#define __VCACHE_H__
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "test_case.h"
+
+// ===================================================================
+// 已验证向量缓存 (--vcache=DIR --vcache-rtl=PATH): 记录每个独立操作 (端口取值 -> DUT 输出)
+//   缓存文件 DIR/<键>.vc 按内容寻址, 键为生成的 top.v 的 128 位哈希加上参考模型版本 (kGoldenModelVersion),
+//   RTL 有任何改动都换一个文件. 命中时不再仿真, 用缓存的输出和当前的参考模型检查结果;
+//   未命中的向量照常仿真并追加到文件. 只用于独立运行的操作 (run_test / 冒烟测试集),
+//   背靠背的流与相邻操作有关, 不经过缓存. 并发运行可以共用同一个缓存目录
+// ===================================================================
+
+struct VcacheSpec {
+    std::string dir;       // 空: 不使用缓存
+    std::string rtl_path;  // 生成的 top.v
+};
+
+// 解析命令行选项 (--vcache= / --vcache-rtl=); 识别则返回true
+bool parse_vcache_option(const char* arg, VcacheSpec& spec, bool& ok);
+
+class VectorCache {
+public:
+    ~VectorCache();
+    // 计算键, 读入已有的缓存文件并打开以追加; 失败返回false
+    bool open(const VcacheSpec& spec);
+    // 命中返回true 并填写 out
+    bool lookup(const DutInputs& in, DutOutputs& out);
+    // 记录一个仿真得到的结果 (已有的不重复写)
+    void insert(const DutInputs& in, const DutOutputs& out);
+    // 打印命中率和新增记录数
+    void report() const;
+
+private:
+    std::string path_;
+    int fd_ = -1;  // O_APPEND, 每条记录一次 write()
+    size_t loaded_ = 0;
+    uint64_t hits_ = 0, misses_ = 0, added_ = 0;
+    std::unordered_map<std::string, DutOutputs> map_;
+};
+
+#endif // __VCACHE_H__
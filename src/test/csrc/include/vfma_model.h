@@ -0,0 +1,69 @@
+#ifndef __VFMA_MODEL_H__
+#define __VFMA_MODEL_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "fma_stages.h"
+#include "occupancy.h"
+#include "test_case.h"
+
+// ===================================================================
+// VfmaModel 类: VFMA_16_32 的纯C++周期模型, 可替代 Vtop 作为功能单元
+//   结果与 RTL 逐位一致 (fp32/fp16/bf16/widen), 时序与 RTL 一致:
+//   valid_in 之后第 kLatency 个时钟沿 valid_out 拉高 (VParams.fmaDelay 去掉 delayBias),
+//   每周期可发射一个操作, 各级寄存器只在本级 valid 时更新 (RegEnable)
+//   注意: 与 RTL 相同, 部分S2/S3寄存器采样的是当时 io 上的模式端口,
+//   发射后修改模式信号会影响流水线中的操作, 因此空闲周期应保持模式不变
+// ===================================================================
+class VfmaModel {
+public:
+    static constexpr int kLatency = 3;
+
+    // 输入端口 (与 VFMA_16_32 的 io 一致, a/b/c 为核心输入, 见 fma_core_inputs)
+    bool reset_in = false;
+    bool valid_in = false;
+    FmaMode mode = {false, false, false, false};
+    uint32_t a_in = 0, b_in = 0, c_in = 0;
+
+    // 一个时钟上升沿
+    void tick();
+    // 输出端口 (res_out 为S3寄存器后的组合逻辑, valid_out 为低时值无意义)
+    bool valid_out() const { return valid_S3_; }
+    uint32_t res_out() const { return fma_res_out(s3_); }
+
+    // 与 Simulator 相同的驱动接口, 便于替换
+    void reset(int n);
+    bool run_op(const DutInputs& in, DutOutputs& out);
+    uint64_t run_stream(const StreamSource& source, const StreamSink& sink);
+    uint64_t cycles() const { return cycles_; }
+    // 与 top 的 perf 端口相同的占用计数 (已经过的非复位周期)
+    bool occupancy(FmaOccupancy& occ) const {
+        occ = occupancy_;
+        return true;
+    }
+
+    // 逐周期驱动接口, 与 Simulator 相同
+    void drive(const DutInputs& in);
+    void idle() { valid_in = false; }
+    void step() { tick(); }
+    DutOutputs sample() const;
+
+private:
+    // 把当前周期 (上升沿之前的 valid 和 io 端口) 计入占用计数
+    void count_cycle(FmaOccupancy& occ) const;
+
+    bool valid_S1_ = false, valid_S2_ = false, valid_S3_ = false;
+    FmaRegsS1 s1_ = {};
+    FmaRegsS2 s2_ = {};
+    FmaRegsS3 s3_ = {};
+    uint64_t cycles_ = 0;
+    FmaOccupancy occupancy_;
+};
+
+// 等价性检查: 相同的输入序列 (逐个发射 + 背靠背流) 同时驱动 Vtop 和 VfmaModel,
+// 逐个比较结果和输出周期, 并报告两者的仿真速度; 完全一致返回true
+class Simulator;
+bool run_equiv(Simulator& sim, const std::vector<TestCase>& tests);
+
+#endif // __VFMA_MODEL_H__
@@ -1,31 +1,214 @@
 #include "include/simulator.h"
 #include "include/test_factory.h"
+#include "include/tensor_trace.h"
+#include "include/fuzz_input.h"
+#include "include/sim_server.h"
+#include "include/vfma_model.h"
+#include "include/signature.h"
+#include "include/mutation.h"
+#include "include/coro_tb.h"
+#include "include/traffic.h"
+#include "include/sweep.h"
+#include "include/activity.h"
+#include "include/bandit.h"
+#include "include/vcache.h"
 #include <vector>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 
 int main(int argc, char *argv[]) {
-  // 1. 初始化随机数生成器种子
-  srand(time(NULL)); 
+  // 0. 解析命令行选项 (其余参数如 +verilator+xxx 交给 VerilatedContext)
+  TraceSpec trace;
+  bool use_trace = false;
+  bool verbose = false;
+  bool equiv = false;
+  const char* corpus_dir = nullptr;
+  const char* server_path = nullptr;
+  int server_sims = 1;
+  long seed = -1;  // -1: 按时间取种子 (签名模式默认 1)
+  const char* signature_path = nullptr;
+  int signature_every = 64;
+  bool signature_update = false;
+  const char* mutate_path = nullptr;
+  const char* smoke_path = nullptr;
+  bool occupancy = false;
+  CoroStimulus coro;
+  bool use_coro = false;
+  TrafficSpec traffic;
+  SweepSpec sweep;
+  ActivitySpec activity;
+  BanditSpec bandit;
+  VcacheSpec vcache_spec;
+  for (int i = 1; i < argc; ++i) {
+    bool ok;
+    if (!strcmp(argv[i], "--verbose")) {
+      verbose = true;
+    } else if (!strcmp(argv[i], "--equiv")) {
+      equiv = true;
+    } else if (!strncmp(argv[i], "--corpus=", 9)) {
+      corpus_dir = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--server=", 9)) {
+      server_path = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--server-sims=", 14)) {
+      server_sims = atoi(argv[i] + 14);
+      if (server_sims < 1) {
+        printf("ERROR: --server-sims must be at least 1\n");
+        return 2;
+      }
+    } else if (!strncmp(argv[i], "--seed=", 7)) {
+      seed = strtoul(argv[i] + 7, nullptr, 0);
+    } else if (!strncmp(argv[i], "--signature=", 12)) {
+      signature_path = argv[i] + 12;
+    } else if (!strncmp(argv[i], "--signature-every=", 18)) {
+      signature_every = atoi(argv[i] + 18);
+      if (signature_every < 1) {
+        printf("ERROR: --signature-every must be at least 1\n");
+        return 2;
+      }
+    } else if (!strcmp(argv[i], "--signature-update")) {
+      signature_update = true;
+    } else if (!strncmp(argv[i], "--mutate=", 9)) {
+      mutate_path = argv[i] + 9;
+    } else if (!strncmp(argv[i], "--smoke=", 8)) {
+      smoke_path = argv[i] + 8;
+    } else if (!strcmp(argv[i], "--occupancy")) {
+      occupancy = true;
+    } else if (parse_coro_option(argv[i], coro, ok)) {
+      if (!ok) return 2;
+      use_coro = true;
+    } else if (parse_traffic_option(argv[i], traffic, ok)) {
+      if (!ok) return 2;
+    } else if (parse_sweep_option(argv[i], sweep, ok)) {
+      if (!ok) return 2;
+    } else if (parse_activity_option(argv[i], activity, ok)) {
+      if (!ok) return 2;
+    } else if (parse_bandit_option(argv[i], bandit, ok)) {
+      if (!ok) return 2;
+    } else if (parse_vcache_option(argv[i], vcache_spec, ok)) {
+      if (!ok) return 2;
+    } else if (parse_trace_option(argv[i], trace, ok)) {
+      if (!ok) return 2;
+      use_trace = true;
+    }
+  }
+
+  // 1. 初始化随机数生成器种子 (签名模式需要固定的种子才能与基线比较, 冒烟测试集固定种子便于复现)
+  if (seed < 0) seed = (signature_path || mutate_path) ? 1 : time(NULL);
+  srand((unsigned)seed);
+
+  // 常驻服务模式: 由服务自行构造仿真器, 按请求执行测试批次
+  if (server_path) {
+    return run_sim_server(server_path, server_sims, argc, argv) ? 0 : 1;
+  }
 
   // 2. 初始化仿真器
   Simulator sim(argc, argv);
+  sim.set_verbose(verbose);
+
+  // 占用计数器: 工作负载结束后报告流水线利用率 (需要 top 的 perf 端口, 即 probes=1)
+  FmaOccupancy occ0;
+  if (occupancy && !sim.occupancy(occ0)) {
+    printf("ERROR: --occupancy needs the perf ports of top (build with probes=1)\n");
+    return 2;
+  }
+  // 翻转统计: 逐周期读取 dbg 端口, 工作负载结束后按流水级/模式报告, 可输出 SAIF (同样需要 probes=1)
+  FmaActivity act;
+  if (activity.on) {
+    if (!sim.set_activity(&act)) {
+      printf("ERROR: --activity needs the dbg ports of top (build with probes=1)\n");
+      return 2;
+    }
+    if (!act.open(activity)) return 2;
+  }
+  // 已验证向量缓存: 同一 RTL 上运行过的独立操作不再仿真 (占用/翻转统计需要逐周期仿真, 不能同时使用)
+  VectorCache vcache;
+  if (!vcache_spec.dir.empty()) {
+    if (occupancy || activity.on) {
+      printf("ERROR: --vcache skips simulation of cached vectors and cannot be used with --occupancy/--activity\n");
+      return 2;
+    }
+    if (!vcache.open(vcache_spec)) return 2;
+    sim.set_vcache(&vcache);
+  }
+  auto finish = [&](const char* workload, bool ok) {
+    FmaOccupancy occ1;
+    if (occupancy && sim.occupancy(occ1)) report_occupancy(workload, occ1 - occ0);
+    if (activity.on && !act.finish(workload)) ok = false;
+    if (!vcache_spec.dir.empty()) vcache.report();
+    return ok ? 0 : 1;
+  };
+
+  // 张量回放模式: 直接以真实数据驱动DUT, 不创建TestCase
+  if (use_trace) {
+    return finish("tensor trace", run_tensor_trace(sim, trace));
+  }
+
+  // 冒烟测试: 只运行变异分析选出的少量向量 (见 --mutate)
+  if (smoke_path) {
+    return finish("smoke suite", run_smoke_suite(sim, smoke_path));
+  }
+
+  // 长时间随机扫描 (可从检查点继续), 或从检查点回放一个失败的向量
+  if (sweep.ops || sweep.replay) {
+    return finish("random sweep", run_sweep(sim, sweep, (unsigned)seed));
+  }
+
+  // 按时间预算把随机向量分配给收益高的 (模式, 指数范围) 组
+  if (bandit.budget_s > 0) {
+    return finish("bandit allocation", run_bandit(sim, bandit));
+  }
 
   // 3. 使用 TestFactory 创建所有测试用例
   printf("--- Creating all test cases ---\n");
-  std::vector<TestCase> tests = create_all_tests();
+  // 先回放模糊测试找到的失败输入 (见 make fuzz), 再运行常规测试
+  std::vector<TestCase> tests;
+  if (corpus_dir) {
+    size_t n = load_corpus(corpus_dir, tests);
+    printf("Loaded %zu corpus inputs from %s\n", n, corpus_dir);
+  }
+  std::vector<TestCase> generated = create_all_tests();
+  tests.insert(tests.end(), generated.begin(), generated.end());
   printf("--- All test cases created ---\n\n");
 
+  // 变异分析: 在参考模型上完成, 不运行DUT
+  if (mutate_path) {
+    return build_smoke_suite(tests, mutate_path, (unsigned)seed) ? 0 : 1;
+  }
+
+  // 等价性模式: 用同一组测试比较 VfmaModel 与 RTL (结果和时序)
+  if (equiv) {
+    return run_equiv(sim, tests) ? 0 : 1;
+  }
+
+  // 协程测试平台: 驱动/监视/计分板任务在同一时钟上同时驱动 Vtop 和 VfmaModel
+  if (use_coro) {
+    return finish("coroutine testbench", run_coro_testbench(sim, tests, coro));
+  }
+
+  // 流量模型: 按真实调度器的发射方式 (背靠背/伯努利/突发/时间线回放) 驱动 Vtop 和 VfmaModel
+  if (!traffic.models.empty()) {
+    return finish("traffic models", run_traffic(sim, tests, traffic));
+  }
+
+  // 签名模式: 只比较输出的哈希, 不检查结果
+  if (signature_path) {
+    return finish("signature stream",
+                  run_signature(sim, tests, signature_path, (unsigned)seed, signature_every, signature_update));
+  }
+
   // 4. 执行所有测试，遇到错误即停止
   for (size_t i = 0; i < tests.size(); ++i) {
-    printf("--- Running test case %zu of %zu ---\n", i + 1, tests.size());
+    if (verbose) {
+      printf("--- Running test case %zu of %zu ---\n", i + 1, tests.size());
+    }
     if (!sim.run_test(tests[i])) {
       printf("\n=================================\n");
       printf("      TEST FAILED!\n");
       printf("=================================\n");
       printf("Failed on test case %zu.\n", i + 1);
-      return 1; // 返回非零值表示失败
+      return finish("isolated test cases", false); // 返回非零值表示失败
     }
   }
 
@@ -36,5 +219,5 @@ int main(int argc, char *argv[]) {
   printf("Successfully completed %zu test cases.\n", tests.size());
   printf("=================================\n");
 
-  return 0; // 返回0表示成功
-}
\ No newline at end of file
+  return finish("isolated test cases", true); // 返回0表示成功
+}
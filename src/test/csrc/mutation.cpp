@@ -0,0 +1,311 @@
+#include "include/mutation.h"
+#include "include/fma_stages.h"
+#include "include/simulator.h"
+#include "include/test_factory.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// 一个流水寄存器字段: 所在级, 在 FmaRegsSN 中的偏移和大小, RTL 位宽
+struct RegField {
+    const char* name;
+    int stage;
+    size_t offset, size;
+    int width;
+    bool is_exp;  // 指数字段另加 +1/-1 变异
+};
+
+#define S1_FIELD(f, w, e) {#f, 1, offsetof(FmaRegsS1, f), sizeof(FmaRegsS1::f), w, e}
+#define S2_FIELD(f, w, e) {#f, 2, offsetof(FmaRegsS2, f), sizeof(FmaRegsS2::f), w, e}
+#define S3_FIELD(f, w, e) {#f, 3, offsetof(FmaRegsS3, f), sizeof(FmaRegsS3::f), w, e}
+
+const RegField kFields[] = {
+    S1_FIELD(input_is_16, 1, false), S1_FIELD(res_is_32, 1, false), S1_FIELD(res_is_bf16, 1, false),
+    S1_FIELD(res_is_fp16, 1, false), S1_FIELD(widen, 1, false),
+    {"is_zero_16[0]", 1, offsetof(FmaRegsS1, is_zero_16) + 0, 1, 1, false},
+    {"is_zero_16[1]", 1, offsetof(FmaRegsS1, is_zero_16) + 1, 1, 1, false},
+    {"is_zero_16[2]", 1, offsetof(FmaRegsS1, is_zero_16) + 2, 1, 1, false},
+    {"is_zero_16[3]", 1, offsetof(FmaRegsS1, is_zero_16) + 3, 1, 1, false},
+    {"is_zero_32[0]", 1, offsetof(FmaRegsS1, is_zero_32) + 0, 1, 1, false},
+    {"is_zero_32[1]", 1, offsetof(FmaRegsS1, is_zero_32) + 1, 1, 1, false},
+    {"is_inf_16[0]", 1, offsetof(FmaRegsS1, is_inf_16) + 0, 1, 1, false},
+    {"is_inf_16[1]", 1, offsetof(FmaRegsS1, is_inf_16) + 1, 1, 1, false},
+    {"is_inf_16[2]", 1, offsetof(FmaRegsS1, is_inf_16) + 2, 1, 1, false},
+    {"is_inf_16[3]", 1, offsetof(FmaRegsS1, is_inf_16) + 3, 1, 1, false},
+    {"is_inf_32[0]", 1, offsetof(FmaRegsS1, is_inf_32) + 0, 1, 1, false},
+    {"is_inf_32[1]", 1, offsetof(FmaRegsS1, is_inf_32) + 1, 1, 1, false},
+    S1_FIELD(exp_res_adjsubn_high, 10, true), S1_FIELD(exp_res_adjsubn_low, 10, true),
+    S1_FIELD(res_is_inf_high, 1, false), S1_FIELD(res_is_inf_low, 1, false),
+    S1_FIELD(res_sign_high, 1, false), S1_FIELD(res_sign_low, 1, false),
+    S1_FIELD(is_fp16, 1, false), S1_FIELD(res_intMul, 48, false), S1_FIELD(c_in, 32, false),
+
+    S2_FIELD(input_is_16, 1, false), S2_FIELD(res_is_32, 1, false), S2_FIELD(res_is_bf16, 1, false),
+    S2_FIELD(res_is_fp16, 1, false), S2_FIELD(widen, 1, false),
+    S2_FIELD(resMul_sign_high, 1, false), S2_FIELD(resMul_sign_low, 1, false),
+    S2_FIELD(resMul_is_zero_low, 1, false), S2_FIELD(resMul_is_zero_high, 1, false),
+    S2_FIELD(resMul_is_inf_low, 1, false), S2_FIELD(resMul_is_inf_high, 1, false),
+    S2_FIELD(resMul_is_subnorm_low, 1, false), S2_FIELD(resMul_is_subnorm_high, 1, false),
+    S2_FIELD(sig_resMul_low, 24, false), S2_FIELD(sig_resMul_whole, 48, false),
+    S2_FIELD(exp_resMul_low, 8, true), S2_FIELD(exp_resMul_high, 8, true),
+    S2_FIELD(c_is_fp16, 1, false), S2_FIELD(c_in, 32, false),
+
+    S3_FIELD(c_in, 32, false), S3_FIELD(input_is_16, 1, false), S3_FIELD(res_is_32, 1, false),
+    S3_FIELD(res_is_bf16, 1, false), S3_FIELD(res_is_fp16, 1, false),
+    S3_FIELD(is_inf_low_c, 1, false), S3_FIELD(is_inf_high_c, 1, false),
+    S3_FIELD(resMul_is_zero_low, 1, false), S3_FIELD(resMul_is_zero_high, 1, false),
+    S3_FIELD(resMul_is_inf_low, 1, false), S3_FIELD(resMul_is_inf_high, 1, false),
+    S3_FIELD(resMul_is_subnorm_low, 1, false), S3_FIELD(resMul_is_subnorm_high, 1, false),
+    S3_FIELD(adderOut_low, 24, false), S3_FIELD(adderOut_high, 24, false),
+    S3_FIELD(adderOut_sign_low, 1, false), S3_FIELD(adderOut_sign_high, 1, false),
+    S3_FIELD(exp_resMul_low, 8, true), S3_FIELD(exp_resMul_high, 8, true),
+    S3_FIELD(exp_c_low, 8, true), S3_FIELD(exp_c_high, 8, true),
+    S3_FIELD(exp_c_gte_ab_low, 1, false), S3_FIELD(exp_c_gte_ab_high, 1, false),
+};
+
+const char* kRoundTargets[ROUND_TARGETS] = {"fp16_low", "bf16_low", "fp16_high", "bf16_high", "whole32"};
+const char* kRoundFaults[FmaRoundFault::Kinds] = {"none", "truncate", "ties_away", "ties_to_odd",
+                                                  "ignore_sticky", "exp_adjust+1", "exp_adjust-1"};
+
+struct Mutant {
+    enum Kind { StuckAt0, StuckAt1, ExpPlus1, ExpMinus1, Round } kind;
+    const RegField* field;
+    int bit;
+    FmaRoundFault round;
+
+    string name() const {
+        char buf[96];
+        if (kind == Round) {
+            snprintf(buf, sizeof(buf), "round %s %s", kRoundTargets[round.target], kRoundFaults[round.kind]);
+        } else if (kind == StuckAt0 || kind == StuckAt1) {
+            snprintf(buf, sizeof(buf), "S%d %s[%d] stuck-at-%d", field->stage, field->name, bit, kind == StuckAt1);
+        } else {
+            snprintf(buf, sizeof(buf), "S%d %s %s", field->stage, field->name, kind == ExpPlus1 ? "+1" : "-1");
+        }
+        return buf;
+    }
+};
+
+vector<Mutant> make_mutants() {
+    vector<Mutant> mutants;
+    for (const RegField& f : kFields) {
+        for (int b = 0; b < f.width; ++b) {
+            mutants.push_back({Mutant::StuckAt0, &f, b, {}});
+            mutants.push_back({Mutant::StuckAt1, &f, b, {}});
+        }
+        if (f.is_exp) {
+            mutants.push_back({Mutant::ExpPlus1, &f, 0, {}});
+            mutants.push_back({Mutant::ExpMinus1, &f, 0, {}});
+        }
+    }
+    for (int t = 0; t < ROUND_TARGETS; ++t) {
+        for (int k = FmaRoundFault::Truncate; k < FmaRoundFault::Kinds; ++k) {
+            FmaRoundFault fault;
+            fault.kind = FmaRoundFault::Kind(k);
+            fault.target = t;
+            mutants.push_back({Mutant::Round, nullptr, 0, fault});
+        }
+    }
+    return mutants;
+}
+
+// 修改寄存器结构体中的一个字段 (小端主机, 与 Verilator 一致)
+void mutate_field(void* regs, const Mutant& m) {
+    const RegField& f = *m.field;
+    uint64_t v = 0;
+    memcpy(&v, (char*)regs + f.offset, f.size);
+    const uint64_t wmask = f.width >= 64 ? ~0ull : (1ull << f.width) - 1;
+    switch (m.kind) {
+        case Mutant::StuckAt0: v &= ~(1ull << m.bit); break;
+        case Mutant::StuckAt1: v |= 1ull << m.bit; break;
+        case Mutant::ExpPlus1: v = (v + 1) & wmask; break;
+        case Mutant::ExpMinus1: v = (v - 1) & wmask; break;
+        default: break;
+    }
+    memcpy((char*)regs + f.offset, &v, f.size);
+}
+
+// 一个向量 (单个操作, 模式不变) 在变异体下的 res_out
+uint32_t mutant_res_out(const Mutant& m, const FmaMode& mode, const FmaRegsS1& s1, const FmaRegsS2& s2,
+                        const FmaRegsS3& s3) {
+    if (m.kind == Mutant::Round) {
+        g_fma_round_fault = m.round;
+        uint32_t res = fma_res_out(s3);
+        g_fma_round_fault = FmaRoundFault();
+        return res;
+    }
+    switch (m.field->stage) {
+        case 1: {
+            FmaRegsS1 r = s1;
+            mutate_field(&r, m);
+            return fma_res_out(fma_s3(fma_s2(r, mode), mode));
+        }
+        case 2: {
+            FmaRegsS2 r = s2;
+            mutate_field(&r, m);
+            return fma_res_out(fma_s3(r, mode));
+        }
+        default: {
+            FmaRegsS3 r = s3;
+            mutate_field(&r, m);
+            return fma_res_out(r);
+        }
+    }
+}
+
+size_t popcount(const vector<uint64_t>& a, const vector<uint64_t>& b) {
+    size_t n = 0;
+    for (size_t i = 0; i < a.size(); ++i) n += __builtin_popcountll(a[i] & b[i]);
+    return n;
+}
+
+} // namespace
+
+bool build_smoke_suite(const vector<TestCase>& tests, const char* path, unsigned seed) {
+    const vector<Mutant> mutants = make_mutants();
+    const size_t words = (mutants.size() + 63) / 64;
+    printf("--- Mutation analysis: %zu mutants x %zu vectors ---\n", mutants.size(), tests.size());
+
+    // 1. 杀死矩阵: 每个向量一行, 每个变异体一位
+    auto t0 = chrono::steady_clock::now();
+    vector<vector<uint64_t>> kills(tests.size(), vector<uint64_t>(words, 0));
+    vector<uint32_t> golden(tests.size());
+    vector<size_t> kill_count(mutants.size(), 0);
+    for (size_t i = 0; i < tests.size(); ++i) {
+        FmaMode mode;
+        uint32_t a, b, c;
+        fma_core_inputs(tests[i].dut_inputs(), mode, a, b, c);
+        const FmaRegsS1 s1 = fma_s1(mode, a, b, c);
+        const FmaRegsS2 s2 = fma_s2(s1, mode);
+        const FmaRegsS3 s3 = fma_s3(s2, mode);
+        golden[i] = fma_res_out(s3);
+        for (size_t m = 0; m < mutants.size(); ++m) {
+            if (mutant_res_out(mutants[m], mode, s1, s2, s3) != golden[i]) {
+                kills[i][m / 64] |= 1ull << (m % 64);
+                kill_count[m]++;
+            }
+        }
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    // 2. 贪心集合覆盖: 每次选杀死剩余变异体最多的向量 (相同时取靠前的)
+    vector<uint64_t> remaining(words, 0);
+    size_t killed = 0;
+    for (size_t m = 0; m < mutants.size(); ++m) {
+        if (kill_count[m]) {
+            remaining[m / 64] |= 1ull << (m % 64);
+            killed++;
+        }
+    }
+    vector<size_t> selected;
+    for (size_t left = killed; left > 0;) {
+        size_t best = 0, best_n = 0;
+        for (size_t i = 0; i < tests.size(); ++i) {
+            size_t n = popcount(kills[i], remaining);
+            if (n > best_n) {
+                best = i;
+                best_n = n;
+            }
+        }
+        selected.push_back(best);
+        for (size_t w = 0; w < words; ++w) remaining[w] &= ~kills[best][w];
+        left -= best_n;
+    }
+
+    printf("Kill matrix built in %.2f s\n", secs);
+    printf("Mutation score: %zu of %zu mutants killed (%.1f%%)\n", killed, mutants.size(),
+           100.0 * killed / mutants.size());
+    printf("Smoke suite: %zu of %zu vectors kill the same mutants\n", selected.size(), tests.size());
+    // 没有向量能杀死的变异体: 等价变异 (该位在所有模式下都不影响结果) 或测试集的缺口
+    size_t undetected = mutants.size() - killed;
+    if (undetected) {
+        printf("Undetected mutants (%zu):\n", undetected);
+        for (size_t m = 0; m < mutants.size(); ++m) {
+            if (!kill_count[m]) printf("  %s\n", mutants[m].name().c_str());
+        }
+    }
+
+    // 3. 写出冒烟测试文件
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        printf("ERROR: cannot write smoke suite %s\n", path);
+        return false;
+    }
+    fprintf(fp, "# VFMA_16_32 smoke suite: <mode> <operands> <expected res_out_32>, selected by mutation analysis\n");
+    fprintf(fp, "# seed %u, %zu of %zu vectors, %zu of %zu mutants killed\n", seed, selected.size(),
+            tests.size(), killed, mutants.size());
+    for (size_t i : selected) {
+        fprintf(fp, "%s ", test_mode_name(tests[i].mode));
+        write_test_operands(fp, tests[i]);
+        fprintf(fp, " %08x\n", golden[i]);
+    }
+    fclose(fp);
+    printf("Smoke suite written to %s\n", path);
+    return true;
+}
+
+bool run_smoke_suite(Simulator& sim, const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        printf("ERROR: cannot open smoke suite %s (build it with --mutate)\n", path);
+        return false;
+    }
+    vector<TestCase> tests;
+    vector<uint32_t> expected;
+    char buf[256];
+    int lineno = 0;
+    bool ok = true;
+    while (ok && fgets(buf, sizeof(buf), fp)) {
+        lineno++;
+        char* line = buf;
+        while (*line == ' ' || *line == '\t') line++;
+        if (*line == '#' || *line == '\n' || *line == '\0') continue;
+        char mode_str[16];
+        uint32_t v[7];
+        int n = sscanf(line, "%15s %x %x %x %x %x %x %x", mode_str, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6]);
+        TestMode mode = TestMode::FP32;
+        ok = n >= 1 && parse_test_mode(mode_str, mode);
+        const int nops = (mode == TestMode::FP16 || mode == TestMode::BF16) ? 6 : 3;
+        ok = ok && n == nops + 2;
+        if (!ok) {
+            printf("ERROR: %s:%d: expected <mode> <%d operands> <result>\n", path, lineno, nops);
+            break;
+        }
+        tests.push_back(make_test_case(mode, v, ErrorType::Precise));
+        expected.push_back(v[nops]);
+    }
+    fclose(fp);
+    if (!ok) return false;
+
+    // 逐个发射: 期望值是单个操作 (模式端口保持不变) 的结果, 背靠背时 S2 采样的是下一个操作的模式
+    // (--vcache 时同一 RTL 上运行过的向量直接取缓存的输出)
+    size_t failed = 0;
+    auto t0 = chrono::steady_clock::now();
+    uint64_t start = sim.cycles();
+    for (size_t i = 0; i < tests.size(); ++i) {
+        DutOutputs out = {};
+        bool hit;
+        if (!sim.run_cached_op(tests[i].dut_inputs(), out, false, hit)) {
+            printf("Smoke FAILED: timeout on vector %zu\n", i + 1);
+            return false;
+        }
+        if (out.res_out_32 != expected[i] && failed++ < 10) {
+            tests[i].print_details();
+            printf("SMOKE FAIL on vector %zu: DUT 0x%08x, expected 0x%08x\n", i + 1, out.res_out_32, expected[i]);
+        }
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("Smoke suite: %zu vectors in %lu cycles, %.3f ms\n", tests.size(), sim.cycles() - start, secs * 1e3);
+    if (failed) {
+        printf("Smoke FAILED: %zu of %zu vectors\n", failed, tests.size());
+        return false;
+    }
+    printf("Smoke PASSED\n");
+    return true;
+}
@@ -0,0 +1,54 @@
+#include "include/occupancy.h"
+
+#include <cstdio>
+
+FmaOccupancy& FmaOccupancy::operator+=(const FmaOccupancy& o) {
+    cycles += o.cycles;
+    active += o.active;
+    for (int s = 0; s < 3; ++s) busy[s] += o.busy[s];
+    issue_fp32 += o.issue_fp32;
+    issue_fp16 += o.issue_fp16;
+    issue_bf16 += o.issue_bf16;
+    issue_widen += o.issue_widen;
+    return *this;
+}
+
+FmaOccupancy FmaOccupancy::operator-(const FmaOccupancy& o) const {
+    FmaOccupancy d;
+    d.cycles = cycles - o.cycles;
+    d.active = active - o.active;
+    for (int s = 0; s < 3; ++s) d.busy[s] = busy[s] - o.busy[s];
+    d.issue_fp32 = issue_fp32 - o.issue_fp32;
+    d.issue_fp16 = issue_fp16 - o.issue_fp16;
+    d.issue_bf16 = issue_bf16 - o.issue_bf16;
+    d.issue_widen = issue_widen - o.issue_widen;
+    return d;
+}
+
+bool FmaOccupancy::operator==(const FmaOccupancy& o) const {
+    return cycles == o.cycles && active == o.active && busy[0] == o.busy[0] && busy[1] == o.busy[1] &&
+           busy[2] == o.busy[2] && issue_fp32 == o.issue_fp32 && issue_fp16 == o.issue_fp16 &&
+           issue_bf16 == o.issue_bf16 && issue_widen == o.issue_widen;
+}
+
+static double ratio(uint64_t a, uint64_t b) {
+    return b ? (double)a / b : 0.0;
+}
+
+void report_occupancy(const char* workload, const FmaOccupancy& occ) {
+    const uint64_t uops = occ.issue_fp32 + occ.issue_fp16 + occ.issue_bf16 + occ.issue_widen;
+    const uint64_t fmas = occ.issue_fp32 + occ.issue_widen + 2 * (occ.issue_fp16 + occ.issue_bf16);
+    const uint64_t slots = occ.busy[0] + occ.busy[1] + occ.busy[2];
+    printf("Occupancy (%s): %lu cycles, %lu with the pipeline non-empty\n", workload, occ.cycles, occ.active);
+    printf("  stage busy:   S1 %5.1f%%  S2 %5.1f%%  S3 %5.1f%%  of all cycles\n", 100 * ratio(occ.busy[0], occ.cycles),
+           100 * ratio(occ.busy[1], occ.cycles), 100 * ratio(occ.busy[2], occ.cycles));
+    printf("  bubble ratio: %5.1f%%  (empty stages while the pipeline is non-empty)\n",
+           100 * (1 - ratio(slots, 3 * occ.active)));
+    printf("  %-6s %10s %10s %8s\n", "mode", "uops", "% cycles", "datapath");
+    printf("  %-6s %10lu %9.1f%% %8s\n", "fp32", occ.issue_fp32, 100 * ratio(occ.issue_fp32, occ.cycles), "1x32");
+    printf("  %-6s %10lu %9.1f%% %8s\n", "fp16", occ.issue_fp16, 100 * ratio(occ.issue_fp16, occ.cycles), "2x16");
+    printf("  %-6s %10lu %9.1f%% %8s\n", "bf16", occ.issue_bf16, 100 * ratio(occ.issue_bf16, occ.cycles), "2x16");
+    printf("  %-6s %10lu %9.1f%% %8s\n", "widen", occ.issue_widen, 100 * ratio(occ.issue_widen, occ.cycles), "high 16");
+    printf("  effective:    %.3f uops/cycle, %.3f FMA/cycle (%.3f FMA per non-empty cycle)\n",
+           ratio(uops, occ.cycles), ratio(fmas, occ.cycles), ratio(fmas, occ.active));
+}
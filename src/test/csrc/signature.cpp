@@ -0,0 +1,210 @@
+#include "include/signature.h"
+#include "include/simulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+static const int kModes = 5;
+static const char* kModeNames[kModes] = {"fp32", "fp16", "bf16", "fp16_widen", "bf16_widen"};
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+void Signature128::fold(uint64_t w) {
+    h[0] = mix64(h[0] ^ w);
+    h[1] = mix64(h[1] + w * 0x9e3779b97f4a7c15ull + h[0]);
+}
+
+namespace {
+
+// 一种模式的签名: 输出个数, 哈希, 每 every 个输出记录一次 h[0]
+struct ModeSignature {
+    uint64_t count = 0;
+    Signature128 sig;
+    vector<uint64_t> checkpoints;
+};
+
+struct SignatureFile {
+    unsigned seed = 0;
+    size_t tests = 0;
+    int every = 0;
+    ModeSignature modes[kModes];
+};
+
+int mode_index(const char* name) {
+    for (int m = 0; m < kModes; ++m) {
+        if (!strcmp(name, kModeNames[m])) return m;
+    }
+    return -1;
+}
+
+bool write_signature(const char* path, const SignatureFile& s) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        printf("ERROR: cannot write signature baseline %s\n", path);
+        return false;
+    }
+    fprintf(fp, "# VFMA_16_32 output signature: per mode <outputs> <hash>, then one checkpoint every <every> outputs\n");
+    fprintf(fp, "seed %u\ntests %zu\nevery %d\n", s.seed, s.tests, s.every);
+    for (int m = 0; m < kModes; ++m) {
+        const ModeSignature& ms = s.modes[m];
+        fprintf(fp, "mode %s %lu %016lx%016lx\ncp %s", kModeNames[m], ms.count, ms.sig.h[0], ms.sig.h[1],
+                kModeNames[m]);
+        for (uint64_t cp : ms.checkpoints) {
+            fprintf(fp, " %016lx", cp);
+        }
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+    return true;
+}
+
+// 文件不存在返回false (exists = false); 格式错误返回false (exists = true)
+bool read_signature(const char* path, SignatureFile& s, bool& exists) {
+    FILE* fp = fopen(path, "r");
+    exists = fp != nullptr;
+    if (!fp) return false;
+    char key[32], name[32];
+    bool ok = true;
+    while (ok && fscanf(fp, "%31s", key) == 1) {
+        if (key[0] == '#') {
+            int c;
+            while ((c = fgetc(fp)) != EOF && c != '\n') {}
+        } else if (!strcmp(key, "seed")) {
+            ok = fscanf(fp, "%u", &s.seed) == 1;
+        } else if (!strcmp(key, "tests")) {
+            ok = fscanf(fp, "%zu", &s.tests) == 1;
+        } else if (!strcmp(key, "every")) {
+            ok = fscanf(fp, "%d", &s.every) == 1;
+        } else if (!strcmp(key, "mode")) {
+            uint64_t count;
+            char hash[40];
+            int m = fscanf(fp, "%31s %lu %39s", name, &count, hash) == 3 ? mode_index(name) : -1;
+            ok = m >= 0 && strlen(hash) == 32 &&
+                 sscanf(hash, "%16lx%16lx", &s.modes[m].sig.h[0], &s.modes[m].sig.h[1]) == 2;
+            if (ok) s.modes[m].count = count;
+        } else if (!strcmp(key, "cp")) {
+            int m = fscanf(fp, "%31s", name) == 1 ? mode_index(name) : -1;
+            ok = m >= 0;
+            int c;
+            while (ok && (c = fgetc(fp)) != EOF && c != '\n') {
+                if (c == ' ') continue;
+                ungetc(c, fp);
+                uint64_t cp;
+                ok = fscanf(fp, "%lx", &cp) == 1;
+                if (ok) s.modes[m].checkpoints.push_back(cp);
+            }
+        } else {
+            ok = false;
+        }
+    }
+    fclose(fp);
+    if (!ok) printf("ERROR: malformed signature baseline %s\n", path);
+    return ok;
+}
+
+} // namespace
+
+bool run_signature(Simulator& sim, const vector<TestCase>& tests, const char* path,
+                   unsigned seed, int every, bool update) {
+    // 1. 背靠背运行所有测试, 每个输出折叠进它所属模式的签名
+    SignatureFile cur;
+    cur.seed = seed;
+    cur.tests = tests.size();
+    cur.every = every;
+    vector<size_t> test_index[kModes];  // 每种模式第 k 个输出对应的测试
+    size_t next = 0, retired = 0;
+    uint64_t base = 0;
+    auto t0 = chrono::steady_clock::now();
+    sim.run_stream(
+        [&](DutInputs& in) {
+            if (next == tests.size()) return false;
+            if (next == 0) base = sim.cycles();
+            in = tests[next++].dut_inputs();
+            return true;
+        },
+        [&](const DutOutputs& out) {
+            int m = (int)tests[retired].mode;
+            ModeSignature& ms = cur.modes[m];
+            ms.sig.fold(sim.cycles() - base);
+            ms.sig.fold(out.res_out_32 | (uint64_t)out.res_out_16_0 << 32 | (uint64_t)out.res_out_16_1 << 48);
+            test_index[m].push_back(retired++);
+            if (++ms.count % every == 0) ms.checkpoints.push_back(ms.sig.h[0]);
+        });
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("Signature: %zu of %zu outputs in %.3f s (seed %u, checkpoint every %d)\n",
+           retired, tests.size(), secs, seed, every);
+    for (int m = 0; m < kModes; ++m) {
+        printf("  %-10s %6lu outputs  %016lx%016lx\n", kModeNames[m], cur.modes[m].count,
+               cur.modes[m].sig.h[0], cur.modes[m].sig.h[1]);
+    }
+    if (retired != tests.size()) {
+        printf("Signature FAILED: DUT retired %zu of %zu ops\n", retired, tests.size());
+        return false;
+    }
+
+    // 2. 记录或比较基线
+    SignatureFile base_sig;
+    bool exists;
+    if (update || !read_signature(path, base_sig, exists)) {
+        if (!update && exists) return false;
+        if (!write_signature(path, cur)) return false;
+        printf("Signature baseline written to %s\n", path);
+        return true;
+    }
+    if (base_sig.seed != seed || base_sig.tests != tests.size() || base_sig.every != every) {
+        printf("Signature FAILED: baseline %s was recorded with seed %u, %zu tests, checkpoint every %d; "
+               "rerun with the same options or --signature-update\n",
+               path, base_sig.seed, base_sig.tests, base_sig.every);
+        return false;
+    }
+
+    size_t first = tests.size(), first_end = 0;
+    bool differs = false;
+    for (int m = 0; m < kModes; ++m) {
+        const ModeSignature &b = base_sig.modes[m], &c = cur.modes[m];
+        if (b.count == c.count && b.sig.h[0] == c.sig.h[0] && b.sig.h[1] == c.sig.h[1]) continue;
+        differs = true;
+        // 第一个不同的检查点之前的输出都一致
+        size_t cp = 0;
+        while (cp < b.checkpoints.size() && cp < c.checkpoints.size() && b.checkpoints[cp] == c.checkpoints[cp]) {
+            cp++;
+        }
+        size_t lo = cp * every, hi = min<size_t>(lo + every, c.count);
+        if (lo >= c.count) {
+            printf("  %-10s differs: %lu outputs, baseline %lu\n", kModeNames[m], c.count, b.count);
+            continue;
+        }
+        printf("  %-10s differs: first diverging output %zu..%zu of this mode (test case %zu..%zu)\n",
+               kModeNames[m], lo + 1, hi, test_index[m][lo] + 1, test_index[m][hi - 1] + 1);
+        if (test_index[m][lo] < first) {
+            first = test_index[m][lo];
+            first_end = test_index[m][hi - 1];
+        }
+    }
+    if (!differs) {
+        printf("Signature MATCHES baseline %s: outputs are bit- and cycle-identical\n", path);
+        return true;
+    }
+    if (first == tests.size()) {
+        printf("Signature DIFFERS: output counts per mode changed\n");
+        return false;
+    }
+    if (first == first_end) {
+        printf("Signature DIFFERS: first diverging test case %zu\n", first + 1);
+    } else {
+        printf("Signature DIFFERS: first diverging test case between %zu and %zu (use --signature-every=1 "
+               "for the exact case)\n", first + 1, first_end + 1);
+    }
+    tests[first].print_details();
+    return false;
+}
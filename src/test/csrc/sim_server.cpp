@@ -0,0 +1,241 @@
+#include "include/sim_server.h"
+#include "include/simulator.h"
+#include "include/test_factory.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static std::atomic<bool> g_stop(false);
+
+// 一个连接的状态
+struct Session {
+    Simulator& sim;
+    FILE* out;
+    ErrorType error_type = ErrorType::ULP;
+    std::vector<TestCase> batch;
+    size_t line_no = 0;
+
+    Session(Simulator& s, FILE* o) : sim(s), out(o) {}
+};
+
+// 解析 "<mode> <a> <b> <c> [<a2> <b2> <c2>]" 并加入批次
+static bool parse_op(Session& s, char* line, const char** msg) {
+    char* save = nullptr;
+    char* tok = strtok_r(line, " \t", &save);
+    TestMode mode;
+    if (!parse_test_mode(tok, mode)) {
+        *msg = "unknown mode";
+        return false;
+    }
+    uint32_t ops[6] = {0};
+    int n = 0;
+    while ((tok = strtok_r(nullptr, " \t", &save)) != nullptr) {
+        char* end;
+        unsigned long v = strtoul(tok, &end, 16);
+        if (*end != '\0' || n == 6) {
+            *msg = "bad operand";
+            return false;
+        }
+        ops[n++] = v;
+    }
+    int expected = (mode == TestMode::FP16 || mode == TestMode::BF16) ? 6 : 3;
+    if (n != expected) {
+        *msg = "wrong operand count";
+        return false;
+    }
+    s.batch.push_back(make_test_case(mode, ops, s.error_type));
+    return true;
+}
+
+// 去掉首尾空白; 返回空串表示空行或注释
+static char* trim(char* line) {
+    while (*line == ' ' || *line == '\t') line++;
+    char* end = line + strlen(line);
+    while (end > line && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) {
+        *--end = '\0';
+    }
+    if (*line == '#') *line = '\0';
+    return line;
+}
+
+static bool load_vector_file(Session& s, const char* path, const char** msg) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        *msg = "cannot open file";
+        return false;
+    }
+    char* buf = nullptr;
+    size_t cap = 0;
+    size_t before = s.batch.size();
+    bool ok = true;
+    while (getline(&buf, &cap, fp) > 0) {
+        char* line = trim(buf);
+        if (*line == '\0') continue;
+        if (!parse_op(s, line, msg)) {
+            // 文件中任一行出错则整个文件不加入
+            s.batch.erase(s.batch.begin() + before, s.batch.end());
+            ok = false;
+            break;
+        }
+    }
+    free(buf);
+    fclose(fp);
+    return ok;
+}
+
+static void run_batch(Session& s) {
+    uint64_t start = s.sim.cycles();
+    size_t failed = 0;
+    s.sim.reset(2);
+    for (size_t i = 0; i < s.batch.size(); i++) {
+        const TestCase& test = s.batch[i];
+        DutOutputs dut;
+        char status;
+        if (!s.sim.run_op(test.dut_inputs(), dut)) {
+            test.print_details();
+            printf("Timeout waiting for valid_out\n");
+            s.sim.reset(2);
+            status = 'T';
+            dut = DutOutputs{0, 0, 0};
+        } else {
+            status = test.check_result(dut) ? 'P' : 'F';
+        }
+        if (status != 'P') failed++;
+
+        if (test.mode == TestMode::FP16 || test.mode == TestMode::BF16) {
+            fprintf(s.out, "%zu %c %04x %04x\n", i, status, dut.res_out_16_0, dut.res_out_16_1);
+        } else {
+            fprintf(s.out, "%zu %c %08x\n", i, status, dut.res_out_32);
+        }
+    }
+    fprintf(s.out, "done %zu %zu %lu\n", s.batch.size(), failed, s.sim.cycles() - start);
+    fflush(s.out);
+    s.batch.clear();
+}
+
+// 处理一个连接, 返回false表示收到 shutdown
+static bool serve_client(Simulator& sim, int fd) {
+    FILE* in = fdopen(fd, "r");
+    FILE* out = fdopen(dup(fd), "w");
+    Session s(sim, out);
+    bool keep_running = true;
+
+    char* buf = nullptr;
+    size_t cap = 0;
+    while (getline(&buf, &cap, in) > 0) {
+        s.line_no++;
+        char* line = trim(buf);
+        const char* msg = nullptr;
+        bool ok = true;
+
+        if (*line == '\0') {
+            continue;
+        } else if (!strcmp(line, "end")) {
+            run_batch(s);
+        } else if (!strcmp(line, "quit")) {
+            break;
+        } else if (!strcmp(line, "shutdown")) {
+            keep_running = false;
+            break;
+        } else if (!strncmp(line, "err ", 4)) {
+            ok = parse_error_type(trim(line + 4), s.error_type);
+            msg = "unknown error type";
+        } else if (!strncmp(line, "file ", 5)) {
+            ok = load_vector_file(s, trim(line + 5), &msg);
+        } else {
+            ok = parse_op(s, line, &msg);
+        }
+
+        if (!ok) {
+            fprintf(out, "error %zu %s\n", s.line_no, msg);
+            fflush(out);
+        }
+        // 客户端已断开 (EPIPE 等): 丢弃这个会话, 继续接受其他连接
+        if (ferror(out)) {
+            printf("Client write failed on line %zu, dropping session\n", s.line_no);
+            break;
+        }
+    }
+    free(buf);
+    fclose(out);
+    fclose(in);
+    return keep_running;
+}
+
+static void worker(Simulator* sim, int listen_fd) {
+    while (!g_stop) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            // 被信号打断或连接在 accept 前被对方放弃时重试; 其他错误 (EMFILE, EBADF 等) 会一直重复, 结束本线程
+            if (g_stop) break;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("accept");
+            break;
+        }
+        if (!serve_client(*sim, fd)) {
+            // 唤醒其余阻塞在 accept 上的线程
+            g_stop = true;
+            shutdown(listen_fd, SHUT_RDWR);
+        }
+    }
+}
+
+bool run_sim_server(const char* socket_path, int num_sims, int argc, char* argv[]) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        printf("ERROR: socket path too long: %s\n", socket_path);
+        return false;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        return false;
+    }
+    unlink(socket_path);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd, 16) < 0) {
+        perror(socket_path);
+        close(listen_fd);
+        return false;
+    }
+
+    // 客户端提前断开时写回复会产生 SIGPIPE, 忽略它, 由 serve_client 检查写错误
+    signal(SIGPIPE, SIG_IGN);
+
+    // 预先构造所有 Simulator, 之后的请求不再付出构造开销;
+    // 常驻进程不记录波形 (各实例会写同一个 top.vcd, 且随请求无限增长)
+    std::vector<std::unique_ptr<Simulator>> sims;
+    for (int i = 0; i < num_sims; i++) {
+        sims.push_back(std::make_unique<Simulator>(argc, argv, false));
+        sims.back()->reset(2);
+    }
+    printf("Simulation server listening on %s (%d simulators)\n", socket_path, num_sims);
+    fflush(stdout);
+
+    std::vector<std::thread> workers;
+    for (auto& sim : sims) {
+        workers.emplace_back(worker, sim.get(), listen_fd);
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    close(listen_fd);
+    unlink(socket_path);
+    printf("Simulation server stopped\n");
+    return true;
+}
@@ -1,10 +1,23 @@
 // sim_c/sim.cc
 #include "include/simulator.h"
+#include "include/activity.h"
+#include "include/vcache.h"
 #include <verilated.h>
 #include "Vtop.h"
+#if VM_COVERAGE
+    #include "Vtop__Syms.h"
+    #include "verilated_cov.h"
+    #include <atomic>
+    #include <filesystem>
+    #include <fstream>
+    #include <unistd.h>
+#endif
 #ifdef VCD
     #include "verilated_vcd_c.h"
 #endif
+#ifdef SAVABLE
+    #include "verilated_save.h"
+#endif
 
 #include <iostream>
 #include <bitset>
@@ -15,17 +28,26 @@ using namespace std;
 // Simulator 类实现
 // ===================================================================
 
-Simulator::Simulator(int argc, char* argv[]) {
+Simulator::Simulator(int argc, char* argv[], bool vcd) {
     contextp_ = make_unique<VerilatedContext>();
     contextp_->commandArgs(argc, argv);
     top_ = make_unique<Vtop>(contextp_.get());
 
 #ifdef VCD
-    init_vcd();
+    if (vcd) {
+        init_vcd();
+    }
+#else
+    (void)vcd;
 #endif
 }
 
 Simulator::~Simulator() {
+#if VM_COVERAGE
+    if (!cov_path_.empty()) {
+        remove(cov_path_.c_str());
+    }
+#endif
 #ifdef VCD
     if (tfp_) {
         tfp_->close();
@@ -46,23 +68,44 @@ void Simulator::single_cycle() {
     top_->clock = 0;
     top_->eval();
 #ifdef VCD
-    if (tfp_) {
+    if (tfp_ && trace_on_) {
         tfp_->dump(contextp_->time());
     }
 #endif
     contextp_->timeInc(1);
 
+#ifdef FMA_PROBES
+    // 上升沿采样的 reset/valid_in/模式, 翻转统计用
+    const bool reset = top_->reset, issued = top_->io_valid_in;
+    const FmaMode mode = {(bool)top_->io_is_fp32, (bool)top_->io_is_fp16, (bool)top_->io_is_bf16,
+                          (bool)top_->io_is_widen};
+#endif
     top_->clock = 1;
     top_->eval();
 #ifdef VCD
-    if (tfp_) {
+    if (tfp_ && trace_on_) {
         tfp_->dump(contextp_->time());
     }
+#endif
+#ifdef FMA_PROBES
+    if (activity_) {
+        activity_->update(reset, issued, mode, sample_probes());
+    }
 #endif
     contextp_->timeInc(1);
+    cycles_++;
 }
 
 void Simulator::reset(int n) {
+#ifdef FMA_PROBES
+    // perf 计数器随复位清零, 先累加已经过的周期 (第一次复位之前寄存器的初值无意义)
+    if (reset_done_) {
+        FmaOccupancy total;
+        occupancy(total);
+        occupancy_base_ = total;
+    }
+    reset_done_ = true;
+#endif
     top_->reset = 1;
     for (int i = 0; i < n; i++) {
         single_cycle();
@@ -71,64 +114,142 @@ void Simulator::reset(int n) {
     top_->eval();
 }
 
-bool Simulator::run_test(const TestCase& test) {
-    test.print_details();
+void Simulator::drive(const DutInputs& in) {
+    top_->io_valid_in = 1;
+    top_->io_is_fp32  = in.is_fp32;
+    top_->io_is_fp16  = in.is_fp16;
+    top_->io_is_bf16  = in.is_bf16;
+    top_->io_is_widen = in.is_widen;
 
-    // -- 执行仿真 --
-    // 复位DUT
-    reset(2);
+    top_->io_a_in_32 = in.a_in_32;
+    top_->io_b_in_32 = in.b_in_32;
+    top_->io_c_in_32 = in.c_in_32;
+    top_->io_a_in_16_0 = in.a_in_16[0];
+    top_->io_b_in_16_0 = in.b_in_16[0];
+    top_->io_c_in_16_0 = in.c_in_16[0];
+    top_->io_a_in_16_1 = in.a_in_16[1];
+    top_->io_b_in_16_1 = in.b_in_16[1];
+    top_->io_c_in_16_1 = in.c_in_16[1];
+}
 
-    // 1. 设置控制信号和数据输入
-    top_->io_valid_in = 1;
-    top_->io_is_fp32  = test.is_fp32;
-    top_->io_is_fp16  = test.is_fp16;
-    top_->io_is_bf16  = test.is_bf16;
-    top_->io_is_widen = test.is_widen;
-
-    // 2. 根据模式设置数据输入端口
-    switch(test.mode) {
-        case TestMode::FP32:
-            top_->io_a_in_32 = test.a_fp32_bits;
-            top_->io_b_in_32 = test.b_fp32_bits;
-            top_->io_c_in_32 = test.c_fp32_bits;
-            break;
-        case TestMode::FP16:
-            // 注意：Verilator会把 a_in_16: Vec(2, UInt(16.W)) 转换成 io_a_in_16_0, io_a_in_16_1
-            top_->io_a_in_16_0 = test.a1_fp16_bits;
-            top_->io_b_in_16_0 = test.b1_fp16_bits;
-            top_->io_c_in_16_0 = test.c1_fp16_bits;
-            top_->io_a_in_16_1 = test.a2_fp16_bits;
-            top_->io_b_in_16_1 = test.b2_fp16_bits;
-            top_->io_c_in_16_1 = test.c2_fp16_bits;
-            break;
-        case TestMode::BF16:
-            // BF16也使用16位端口
-            top_->io_a_in_16_0 = test.a1_bf16_bits;
-            top_->io_b_in_16_0 = test.b1_bf16_bits;
-            top_->io_c_in_16_0 = test.c1_bf16_bits;
-            top_->io_a_in_16_1 = test.a2_bf16_bits;
-            top_->io_b_in_16_1 = test.b2_bf16_bits;
-            top_->io_c_in_16_1 = test.c2_bf16_bits;
-            break;
-        case TestMode::FP16_Widen:
-            // FP16 Widen: a,b是FP16, c是FP32
-            // 在test_case中，a,b的fp16值被存在了a_fp32_bits的高16位
-            top_->io_a_in_16_0 = 0;
-            top_->io_a_in_16_1 = (test.a_fp32_bits >> 16) & 0xFFFF;
-            top_->io_b_in_16_0 = 0;
-            top_->io_b_in_16_1 = (test.b_fp32_bits >> 16) & 0xFFFF;
-            top_->io_c_in_32 = test.c_fp32_bits;
-            break;
-        case TestMode::BF16_Widen:
-            // BF16 Widen: a,b是BF16, c是FP32
-            // 在test_case中，a,b的bf16值被存在了a_fp32_bits的高16位
-            top_->io_a_in_16_0 = 0;
-            top_->io_a_in_16_1 = (test.a_fp32_bits >> 16) & 0xFFFF;
-            top_->io_b_in_16_0 = 0;
-            top_->io_b_in_16_1 = (test.b_fp32_bits >> 16) & 0xFFFF;
-            top_->io_c_in_32 = test.c_fp32_bits;
-            break;
-    }
+void Simulator::idle() {
+    top_->io_valid_in = 0;
+}
+
+bool Simulator::valid_out() const {
+    return top_->io_valid_out;
+}
+
+DutOutputs Simulator::sample() const {
+    DutOutputs dut_res;
+    dut_res.res_out_32 = top_->io_res_out_32;
+    dut_res.res_out_16_0 = top_->io_res_out_16_0;
+    dut_res.res_out_16_1 = top_->io_res_out_16_1;
+    return dut_res;
+}
+
+#ifdef FMA_PROBES
+FmaStageProbes Simulator::sample_probes() const {
+    FmaStageProbes p;
+    p.res_intMul_S1 = top_->dbg_res_intMul_S1;
+    p.exp_res_adjsubn_low_S1 = top_->dbg_exp_res_adjsubn_low_S1;
+    p.exp_res_adjsubn_high_S1 = top_->dbg_exp_res_adjsubn_high_S1;
+    p.sig_resMul_low_S2 = top_->dbg_sig_resMul_low_S2;
+    p.sig_resMul_whole_S2 = top_->dbg_sig_resMul_whole_S2;
+    p.exp_resMul_low_S2 = top_->dbg_exp_resMul_low_S2;
+    p.exp_resMul_high_S2 = top_->dbg_exp_resMul_high_S2;
+    p.adderOut_low_S3 = top_->dbg_adderOut_low_S3;
+    p.adderOut_high_S3 = top_->dbg_adderOut_high_S3;
+    p.adderOut_sign_low_S3 = top_->dbg_adderOut_sign_low_S3;
+    p.adderOut_sign_high_S3 = top_->dbg_adderOut_sign_high_S3;
+    p.exp_adderOut_low_S3 = top_->dbg_exp_adderOut_low_S3;
+    p.exp_adderOut_high_S3 = top_->dbg_exp_adderOut_high_S3;
+    p.mul_a_in = top_->dbg_mul_a_in;
+    p.mul_b_in = top_->dbg_mul_b_in;
+    p.mul_sum_S1 = top_->dbg_mul_sum_S1;
+    p.mul_carry_S1 = top_->dbg_mul_carry_S1;
+    p.c_in_S1 = top_->dbg_c_in_S1;
+    p.c_in_S2 = top_->dbg_c_in_S2;
+    p.c_in_S3 = top_->dbg_c_in_S3;
+    return p;
+}
+#endif
+
+bool Simulator::set_activity(FmaActivity* act) {
+#ifdef FMA_PROBES
+    activity_ = act;
+    return true;
+#else
+    (void)act;
+    return false;
+#endif
+}
+
+bool Simulator::occupancy(FmaOccupancy& occ) const {
+#ifdef FMA_PROBES
+    occ = occupancy_base_;
+    if (!reset_done_) return true;
+    FmaOccupancy cur;
+    cur.cycles = top_->perf_cycles;
+    cur.active = top_->perf_active;
+    cur.busy[0] = top_->perf_busy_S1;
+    cur.busy[1] = top_->perf_busy_S2;
+    cur.busy[2] = top_->perf_busy_S3;
+    cur.issue_fp32 = top_->perf_issue_fp32;
+    cur.issue_fp16 = top_->perf_issue_fp16;
+    cur.issue_bf16 = top_->perf_issue_bf16;
+    cur.issue_widen = top_->perf_issue_widen;
+    occ += cur;
+    return true;
+#else
+    (void)occ;
+    return false;
+#endif
+}
+
+bool Simulator::save(const char* path) {
+#ifdef SAVABLE
+    VerilatedSave os;
+    os.open(path);
+    if (!os.isOpen()) return false;
+    // 仿真时间和驱动方的计数不在模型中, 与模型一起保存
+    uint64_t time = contextp_->time();
+    os << time << cycles_ << reset_done_;
+    os << occupancy_base_.cycles << occupancy_base_.active << occupancy_base_.busy[0] << occupancy_base_.busy[1]
+       << occupancy_base_.busy[2] << occupancy_base_.issue_fp32 << occupancy_base_.issue_fp16
+       << occupancy_base_.issue_bf16 << occupancy_base_.issue_widen;
+    os << *top_;
+    os.close();
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+bool Simulator::restore(const char* path) {
+#ifdef SAVABLE
+    VerilatedRestore is;
+    is.open(path);
+    if (!is.isOpen()) return false;
+    uint64_t time;
+    is >> time >> cycles_ >> reset_done_;
+    is >> occupancy_base_.cycles >> occupancy_base_.active >> occupancy_base_.busy[0] >> occupancy_base_.busy[1]
+       >> occupancy_base_.busy[2] >> occupancy_base_.issue_fp32 >> occupancy_base_.issue_fp16
+       >> occupancy_base_.issue_bf16 >> occupancy_base_.issue_widen;
+    is >> *top_;
+    is.close();
+    contextp_->time(time);
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+bool Simulator::run_op(const DutInputs& in, DutOutputs& out) {
+    // 设置控制信号和数据输入
+    drive(in);
 
     // 输入有效，等待一个周期，让DUT接收数据
     single_cycle();
@@ -142,15 +263,113 @@ bool Simulator::run_test(const TestCase& test) {
         timeout--;
     }
 
+    if (!top_->io_valid_out) {
+        return false;
+    }
+    out = sample();
+    return true;
+}
+
+bool Simulator::run_cached_op(const DutInputs& in, DutOutputs& out, bool reset_first, bool& hit) {
+    hit = vcache_ && vcache_->lookup(in, out);
+    if (hit) return true;
+    if (reset_first) reset(2);
+    if (!run_op(in, out)) return false;
+    if (vcache_) vcache_->insert(in, out);
+    return true;
+}
+
+bool Simulator::run_test(const TestCase& test) {
+    if (verbose_) {
+        test.print_details();
+    }
+
+    // -- 执行仿真 (复位DUT; 向量缓存命中时直接取缓存的输出) --
     // -- 获取DUT输出并检查结果 --
-    if (top_->io_valid_out) {
-        DutOutputs dut_res;
-        dut_res.res_out_32 = top_->io_res_out_32;
-        dut_res.res_out_16_0 = top_->io_res_out_16_0;
-        dut_res.res_out_16_1 = top_->io_res_out_16_1;
-        return test.check_result(dut_res);
+    DutOutputs dut_res;
+    bool hit;
+    if (run_cached_op(test.dut_inputs(), dut_res, true, hit)) {
+        bool pass = test.check_result(dut_res, verbose_);
+#ifdef FMA_PROBES
+        // 单个操作时各级寄存器在 valid_out 时仍保持该操作的值, 逐级比对定位出错的流水级
+        if (!pass && !hit) {
+            compare_stage_probes(test.dut_inputs(), sample_probes());
+        }
+#endif
+        if (!pass && hit) {
+            printf("(DUT result from the vector cache; run without --vcache for the stage comparison)\n");
+        }
+        return pass;
     } else {
+        test.print_details();
         printf("Timeout waiting for valid_out\n");
         return false;
     }
-}
\ No newline at end of file
+}
+
+uint64_t Simulator::run_stream(const StreamSource& source, const StreamSink& sink) {
+    reset(2);
+    uint64_t start = cycles_;
+    uint64_t issued = 0, retired = 0;
+    bool has_more = true;
+    int timeout = 100; // 发射结束后等待valid_out的超时周期
+
+    DutInputs in;
+    while (has_more || retired < issued) {
+        if (has_more && source(in)) {
+            drive(in);
+            issued++;
+        } else {
+            // 只拉低valid_in，保持模式信号不变 (FMA内部部分寄存器在下一级才采样模式)
+            has_more = false;
+            top_->io_valid_in = 0;
+        }
+        single_cycle();
+
+        if (top_->io_valid_out) {
+            sink(sample());
+            retired++;
+        } else if (!has_more && --timeout == 0) {
+            printf("Timeout waiting for valid_out (%lu of %lu retired)\n", retired, issued);
+            break;
+        }
+    }
+    return cycles_ - start;
+}
+
+#if VM_COVERAGE
+bool Simulator::coverage_counters(vector<uint64_t>& counts, bool zero) {
+    // VerilatedCovContext 没有逐点读取的接口: 导出到本实例的临时文件再读回
+    if (cov_path_.empty()) {
+        static atomic<int> next_id(0);
+        error_code ec;
+        cov_path_ = (filesystem::temp_directory_path(ec) /
+                     ("vfpu_cov_" + to_string(getpid()) + "_" + to_string(next_id++) + ".dat")).string();
+    }
+    VerilatedCovContext* cov = contextp_->coveragep();
+    cov->write(cov_path_.c_str());
+    if (zero) {
+        cov->zero();
+    }
+
+    // 每个覆盖点一行 "C '<键>' <计数>", 按键排序 (同一模型中顺序固定)
+    counts.clear();
+    ifstream in(cov_path_);
+    string line;
+    while (getline(in, line)) {
+        const size_t q = line.rfind("' ");
+        if (line.compare(0, 3, "C '") != 0 || q == string::npos) continue;
+        counts.push_back(strtoull(line.c_str() + q + 2, nullptr, 10));
+    }
+    if (counts.empty()) {
+        printf("ERROR: cannot read coverage counters from %s\n", cov_path_.c_str());
+        return false;
+    }
+    return true;
+}
+
+const uint32_t* Simulator::coverage_array(size_t& n) const {
+    n = sizeof(top_->vlSymsp->__Vcoverage) / sizeof(top_->vlSymsp->__Vcoverage[0]);
+    return top_->vlSymsp->__Vcoverage;
+}
+#endif
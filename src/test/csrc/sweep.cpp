@@ -0,0 +1,372 @@
+#include "include/sweep.h"
+#include "include/simulator.h"
+#include "include/fma_stages.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static const int kModes = 5;
+static const char* kModeNames[kModes] = {"fp32", "fp16", "bf16", "fp16_widen", "bf16_widen"};
+
+bool parse_sweep_option(const char* arg, SweepSpec& spec, bool& ok) {
+    ok = true;
+    if (!strncmp(arg, "--sweep=", 8)) {
+        // 接受 1e9 这样的写法
+        spec.ops = (uint64_t)strtod(arg + 8, nullptr);
+        if (spec.ops == 0) {
+            printf("ERROR: --sweep=N needs N >= 1\n");
+            ok = false;
+        }
+    } else if (!strncmp(arg, "--ckpt=", 7)) {
+        spec.ckpt_dir = arg + 7;
+    } else if (!strncmp(arg, "--ckpt-every=", 13)) {
+        spec.ckpt_every = (uint64_t)strtod(arg + 13, nullptr);
+        if (spec.ckpt_every < kSweepChunk) {
+            printf("ERROR: --ckpt-every must be at least %lu\n", kSweepChunk);
+            ok = false;
+        }
+    } else if (!strncmp(arg, "--replay=", 9)) {
+        spec.replay = true;
+        spec.replay_op = strtoull(arg + 9, nullptr, 0);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+// 扫描的全部驱动方状态 (Vtop 状态由 Simulator::save 另存)
+struct SweepState {
+    unsigned seed = 0;
+    uint64_t ops = 0;
+    uint64_t cursor = 0;   // 已完成的操作数, 按块对齐
+    uint64_t failures = 0;
+    mt19937_64 rng;
+};
+
+string ckpt_base(const string& dir, uint64_t cursor) {
+    return dir + "/ckpt_" + to_string(cursor);
+}
+
+// 文本状态文件: 先写临时文件再改名, 中途被杀掉时不留下半个文件
+bool write_state(const string& path, const SweepState& st) {
+    const string tmp = path + ".tmp";
+    {
+        ofstream f(tmp);
+        f << "seed " << st.seed << "\nops " << st.ops << "\ncursor " << st.cursor << "\nfailures " << st.failures
+          << "\nrng " << st.rng << "\n";
+        if (!f) return false;
+    }
+    return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool read_state(const string& path, SweepState& st) {
+    ifstream f(path);
+    string key;
+    bool has[5] = {};
+    while (f >> key) {
+        if (key == "seed") has[0] = bool(f >> st.seed);
+        else if (key == "ops") has[1] = bool(f >> st.ops);
+        else if (key == "cursor") has[2] = bool(f >> st.cursor);
+        else if (key == "failures") has[3] = bool(f >> st.failures);
+        else if (key == "rng") has[4] = bool(f >> st.rng);
+        else break;
+    }
+    for (bool h : has) {
+        if (!h) {
+            printf("ERROR: bad sweep checkpoint %s\n", path.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// DIR 中的检查点游标, 升序
+vector<uint64_t> list_checkpoints(const string& dir) {
+    vector<uint64_t> cursors;
+    error_code ec;
+    for (const fs::directory_entry& e : fs::directory_iterator(dir, ec)) {
+        const string name = e.path().filename().string();
+        if (name.rfind("ckpt_", 0) == 0 && e.path().extension() == ".state") {
+            cursors.push_back(strtoull(name.c_str() + 5, nullptr, 10));
+        }
+    }
+    sort(cursors.begin(), cursors.end());
+    return cursors;
+}
+
+bool save_checkpoint(Simulator& sim, const string& dir, const SweepState& st) {
+    const string base = ckpt_base(dir, st.cursor);
+    if (!sim.save((base + ".sav").c_str())) {
+        printf("ERROR: cannot save the Vtop state to %s.sav (Verilator --savable needs make savable=1)\n",
+               base.c_str());
+        return false;
+    }
+    // 状态文件最后写: 有 .state 的检查点才是完整的
+    if (!write_state(base + ".state", st)) {
+        printf("ERROR: cannot write %s.state\n", base.c_str());
+        return false;
+    }
+    return true;
+}
+
+void remove_checkpoint(const string& dir, uint64_t cursor) {
+    const string base = ckpt_base(dir, cursor);
+    fs::remove(base + ".state");
+    fs::remove(base + ".sav");
+}
+
+bool load_checkpoint(Simulator& sim, const string& dir, uint64_t cursor, SweepState& st) {
+    const string base = ckpt_base(dir, cursor);
+    if (!read_state(base + ".state", st)) return false;
+    if (!sim.restore((base + ".sav").c_str())) {
+        printf("ERROR: cannot restore the Vtop state from %s.sav (Verilator --savable needs make savable=1)\n",
+               base.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 一种模式的随机操作数 (任意位模式, 包括 NaN/Inf/非规格化数)
+DutInputs random_inputs(int mode, mt19937_64& rng) {
+    DutInputs in = {};
+    const uint64_t r0 = rng(), r1 = rng();
+    in.is_fp32 = mode == 0;
+    in.is_fp16 = mode == 1 || mode == 3;
+    in.is_bf16 = mode == 2 || mode == 4;
+    in.is_widen = mode >= 3;
+    if (mode == 0) {
+        in.a_in_32 = uint32_t(r0);
+        in.b_in_32 = uint32_t(r0 >> 32);
+        in.c_in_32 = uint32_t(r1);
+    } else if (mode <= 2) {
+        for (int h = 0; h < 2; ++h) {
+            in.a_in_16[h] = uint16_t(r0 >> (32 * h));
+            in.b_in_16[h] = uint16_t(r0 >> (32 * h + 16));
+            in.c_in_16[h] = uint16_t(r1 >> (32 * h));
+        }
+    } else {
+        // widen 只用高半部分的16位操作数 (与 TestCase::dut_inputs 一致)
+        in.a_in_16[1] = uint16_t(r0);
+        in.b_in_16[1] = uint16_t(r0 >> 16);
+        in.c_in_32 = uint32_t(r1);
+    }
+    return in;
+}
+
+struct Mismatch {
+    uint64_t op;
+    int mode;
+    DutInputs in;
+    uint32_t got, expected;
+};
+
+void print_mismatch(FILE* fp, const Mismatch& m) {
+    const DutInputs& in = m.in;
+    fprintf(fp, "op %lu %s a 0x%08x b 0x%08x c 0x%08x a16 0x%04x,0x%04x b16 0x%04x,0x%04x c16 0x%04x,0x%04x "
+                "got 0x%08x expected 0x%08x\n", m.op, kModeNames[m.mode], in.a_in_32, in.b_in_32, in.c_in_32,
+            in.a_in_16[1], in.a_in_16[0], in.b_in_16[1], in.b_in_16[0], in.c_in_16[1], in.c_in_16[0], m.got,
+            m.expected);
+}
+
+// 一个块: 同一模式的操作背靠背发射, 排空后逐位比较; 推进 st.cursor, 返回false表示超时
+bool run_chunk(Simulator& sim, SweepState& st, vector<Mismatch>& bad) {
+    const int mode = int(st.rng() % kModes);
+    const uint64_t n = min(kSweepChunk, st.ops - st.cursor);
+    vector<DutInputs> ops(n);
+    for (DutInputs& in : ops) in = random_inputs(mode, st.rng);
+
+    vector<uint32_t> res;
+    res.reserve(n);
+    int timeout = 100;
+    for (uint64_t i = 0; res.size() < n; ++i) {
+        if (i < n) {
+            sim.drive(ops[i]);
+        } else {
+            // 只拉低valid_in, 模式保持不变, 直到排空
+            sim.idle();
+            if (--timeout == 0) {
+                printf("Timeout waiting for valid_out (op %lu)\n", st.cursor + res.size());
+                return false;
+            }
+        }
+        sim.step();
+        if (sim.valid_out()) res.push_back(sim.sample().res_out_32);
+    }
+    sim.idle();
+
+    for (uint64_t i = 0; i < n; ++i) {
+        const uint32_t expected = fma_ref_result(ops[i]);
+        if (res[i] != expected) bad.push_back({st.cursor + i, mode, ops[i], res[i], expected});
+    }
+    st.cursor += n;
+    return true;
+}
+
+// 从 OP 之前最近的检查点重新运行到 OP 所在的块, 打开波形
+bool replay(Simulator& sim, const SweepSpec& spec) {
+    if (spec.ckpt_dir.empty()) {
+        printf("ERROR: --replay needs --ckpt=DIR\n");
+        return false;
+    }
+    uint64_t from = ~0ull;
+    for (uint64_t c : list_checkpoints(spec.ckpt_dir)) {
+        if (c <= spec.replay_op) from = c;
+    }
+    if (from == ~0ull) {
+        printf("ERROR: no checkpoint at or before op %lu in %s\n", spec.replay_op, spec.ckpt_dir.c_str());
+        return false;
+    }
+    SweepState st;
+    sim.set_trace(false);
+    if (!load_checkpoint(sim, spec.ckpt_dir, from, st)) return false;
+    if (spec.replay_op >= st.ops) {
+        printf("ERROR: op %lu is beyond the sweep (%lu ops)\n", spec.replay_op, st.ops);
+        return false;
+    }
+    const uint64_t start_cycle = sim.cycles();
+    printf("--- Replay: restored checkpoint at op %lu (cycle %lu), re-running to op %lu with tracing on ---\n", from,
+           start_cycle, spec.replay_op);
+
+    sim.set_trace(true);
+    vector<Mismatch> bad;
+    uint64_t chunk_start = st.cursor, chunk_cycle = sim.cycles();
+    while (st.cursor <= spec.replay_op) {
+        chunk_start = st.cursor;
+        chunk_cycle = sim.cycles();
+        if (!run_chunk(sim, st, bad)) return false;
+    }
+    printf("Replayed %lu ops in %lu cycles; op %lu is in the block starting at op %lu, cycle %lu "
+           "(waveform in build/fma/top.vcd with vcd=1)\n", st.cursor - from, sim.cycles() - start_cycle,
+           spec.replay_op, chunk_start, chunk_cycle);
+    bool op_failed = false;
+    for (const Mismatch& m : bad) {
+        print_mismatch(stdout, m);
+        op_failed |= m.op == spec.replay_op;
+    }
+    printf("Op %lu %s in the replay (%zu mismatches in the window)\n", spec.replay_op,
+           op_failed ? "FAILED" : "passed", bad.size());
+    return bad.empty();
+}
+
+} // namespace
+
+bool run_sweep(Simulator& sim, const SweepSpec& spec, unsigned seed) {
+    if (spec.replay) return replay(sim, spec);
+
+    const bool ckpt = !spec.ckpt_dir.empty();
+    SweepState st;
+    FILE* fail_log = nullptr;
+    // 波形只在回放时记录
+    sim.set_trace(false);
+
+    vector<uint64_t> existing;
+    if (ckpt) {
+        error_code ec;
+        fs::create_directories(spec.ckpt_dir, ec);
+        existing = list_checkpoints(spec.ckpt_dir);
+    }
+    if (!existing.empty()) {
+        // 从最新的检查点继续 (之后的失败记录会重新产生, 先截掉)
+        if (!load_checkpoint(sim, spec.ckpt_dir, existing.back(), st)) return false;
+        if (st.ops != spec.ops) {
+            printf("ERROR: %s holds a sweep of %lu ops, not %lu; use another --ckpt directory\n",
+                   spec.ckpt_dir.c_str(), st.ops, spec.ops);
+            return false;
+        }
+        printf("--- Sweep: resuming from checkpoint at op %lu of %lu (seed %u, %lu failures so far) ---\n", st.cursor,
+               st.ops, st.seed, st.failures);
+    } else {
+        st.seed = seed;
+        st.ops = spec.ops;
+        st.rng.seed(seed);
+        sim.reset(2);
+        printf("--- Sweep: %lu random ops (seed %u), %lu-op blocks of one mode ---\n", st.ops, st.seed, kSweepChunk);
+        if (ckpt && !save_checkpoint(sim, spec.ckpt_dir, st)) return false;
+    }
+
+    if (ckpt) {
+        // failures.txt 只保留最新检查点之前的记录
+        const string path = spec.ckpt_dir + "/failures.txt";
+        vector<string> keep;
+        ifstream in(path);
+        for (string line; getline(in, line);) {
+            if (strtoull(line.c_str() + 3, nullptr, 10) < st.cursor) keep.push_back(line);
+        }
+        in.close();
+        fail_log = fopen(path.c_str(), "w");
+        if (!fail_log) {
+            printf("ERROR: cannot write %s\n", path.c_str());
+            return false;
+        }
+        for (const string& line : keep) fprintf(fail_log, "%s\n", line.c_str());
+        fflush(fail_log);
+        printf("Checkpoints every %lu ops in %s (make savable=1 builds only)\n", spec.ckpt_every,
+               spec.ckpt_dir.c_str());
+    }
+
+    const uint64_t every = (spec.ckpt_every + kSweepChunk - 1) / kSweepChunk * kSweepChunk;
+    uint64_t last_ckpt = st.cursor, failures_at_ckpt = st.failures;
+    const uint64_t start_cursor = st.cursor, start_cycles = sim.cycles();
+    const size_t max_report = 10;
+    auto t0 = chrono::steady_clock::now();
+    bool ok = true;
+    while (st.cursor < st.ops) {
+        vector<Mismatch> bad;
+        if (!run_chunk(sim, st, bad)) {
+            ok = false;
+            break;
+        }
+        for (const Mismatch& m : bad) {
+            if (st.failures++ < max_report) {
+                printf("MISMATCH: ");
+                print_mismatch(stdout, m);
+            }
+            if (fail_log) print_mismatch(fail_log, m);
+        }
+        if (fail_log && !bad.empty()) fflush(fail_log);
+
+        if (ckpt && (st.cursor - last_ckpt >= every || st.cursor == st.ops)) {
+            if (!save_checkpoint(sim, spec.ckpt_dir, st)) {
+                ok = false;
+                break;
+            }
+            // 上一个检查点之后没有失败时不再需要它 (回放只从失败之前的检查点开始)
+            if (st.failures == failures_at_ckpt) remove_checkpoint(spec.ckpt_dir, last_ckpt);
+            last_ckpt = st.cursor;
+            failures_at_ckpt = st.failures;
+        }
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    if (fail_log) fclose(fail_log);
+
+    const uint64_t done = st.cursor - start_cursor;
+    printf("Swept %lu ops (%lu..%lu) in %lu cycles, %.3f s (%.0f ops/s)\n", done, start_cursor, st.cursor,
+           sim.cycles() - start_cycles, secs, secs > 0 ? done / secs : 0.0);
+    // 供 make bench 记录的一行
+    printf("BENCH ops_per_s=%.0f cycles_per_s=%.0f\n", secs > 0 ? done / secs : 0.0,
+           secs > 0 ? (sim.cycles() - start_cycles) / secs : 0.0);
+    if (!ok) {
+        printf("Sweep FAILED: stopped at op %lu\n", st.cursor);
+        return false;
+    }
+    if (st.failures) {
+        printf("Sweep FAILED: %lu mismatches%s\n", st.failures,
+               ckpt ? " (listed in failures.txt; --replay=OP re-runs one from its checkpoint)" : "");
+        return false;
+    }
+    printf("Sweep PASSED\n");
+    return true;
+}
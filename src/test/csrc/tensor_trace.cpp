@@ -0,0 +1,477 @@
+#include "include/tensor_trace.h"
+#include "include/simulator.h"
+#include "include/fp_utils.h"
+#include "include/test_factory.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ===================================================================
+// MappedTensor 实现
+// ===================================================================
+MappedTensor::~MappedTensor() {
+    if (map_) {
+        munmap(map_, map_len_);
+    }
+}
+
+bool MappedTensor::open(const std::string& path, const TensorDType* dtype_override) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        printf("ERROR: cannot open tensor file %s\n", path.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("ERROR: tensor file %s is empty\n", path.c_str());
+        close(fd);
+        return false;
+    }
+    map_len_ = st.st_size;
+    map_ = mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        printf("ERROR: mmap failed for %s\n", path.c_str());
+        return false;
+    }
+    // 顺序读取, 提示内核预读
+    madvise(map_, map_len_, MADV_SEQUENTIAL);
+
+    const uint8_t* p = static_cast<const uint8_t*>(map_);
+    if (map_len_ >= 10 && memcmp(p, "\x93NUMPY", 6) == 0) {
+        return parse_npy_header(path, dtype_override);
+    }
+
+    // raw 二进制: 必须指定 dtype
+    if (!dtype_override) {
+        printf("ERROR: %s is not a .npy file, --trace-dtype is required for raw tensors\n", path.c_str());
+        return false;
+    }
+    dtype_ = *dtype_override;
+    size_t elem = dtype_ == TensorDType::FP32 ? 4 : 2;
+    data_ = p;
+    count_ = map_len_ / elem;
+    shape_ = {count_};
+    return true;
+}
+
+bool MappedTensor::parse_npy_header(const std::string& path, const TensorDType* dtype_override) {
+    const uint8_t* p = static_cast<const uint8_t*>(map_);
+    uint8_t major = p[6];
+    size_t header_len, offset;
+    if (major == 1) {
+        header_len = p[8] | (p[9] << 8);
+        offset = 10;
+    } else {
+        if (map_len_ < 12) return false;
+        header_len = p[8] | (p[9] << 8) | (p[10] << 16) | ((size_t)p[11] << 24);
+        offset = 12;
+    }
+    if (offset + header_len > map_len_) {
+        printf("ERROR: truncated .npy header in %s\n", path.c_str());
+        return false;
+    }
+    std::string header(reinterpret_cast<const char*>(p + offset), header_len);
+
+    // 'descr': '<f4'
+    size_t pos = header.find("'descr'");
+    size_t q0 = header.find('\'', header.find(':', pos) + 1);
+    size_t q1 = header.find('\'', q0 + 1);
+    if (pos == std::string::npos || q0 == std::string::npos || q1 == std::string::npos) {
+        printf("ERROR: no descr in .npy header of %s\n", path.c_str());
+        return false;
+    }
+    std::string descr = header.substr(q0 + 1, q1 - q0 - 1);
+    if (descr == "<f4") {
+        dtype_ = TensorDType::FP32;
+    } else if (descr == "<f2") {
+        dtype_ = TensorDType::FP16;
+    } else if (descr == "<u2" || descr == "<i2" || descr == "|V2" || descr == "<V2") {
+        // numpy 没有原生bf16, 通常以16位整数或void类型保存
+        dtype_ = TensorDType::BF16;
+    } else {
+        printf("ERROR: unsupported .npy descr '%s' in %s\n", descr.c_str(), path.c_str());
+        return false;
+    }
+    if (dtype_override) {
+        bool same_width = (*dtype_override == TensorDType::FP32) == (dtype_ == TensorDType::FP32);
+        if (!same_width) {
+            printf("ERROR: --trace-dtype does not match element width of %s\n", path.c_str());
+            return false;
+        }
+        dtype_ = *dtype_override;
+    }
+
+    // 'shape': (M, N, ...)
+    pos = header.find("'shape'");
+    size_t l = header.find('(', pos);
+    size_t r = header.find(')', l);
+    if (pos == std::string::npos || l == std::string::npos || r == std::string::npos) {
+        printf("ERROR: no shape in .npy header of %s\n", path.c_str());
+        return false;
+    }
+    shape_.clear();
+    count_ = 1;
+    const char* s = header.c_str() + l + 1;
+    const char* end = header.c_str() + r;
+    while (s < end) {
+        char* next;
+        unsigned long dim = strtoul(s, &next, 10);
+        if (next == s) { s++; continue; }
+        shape_.push_back(dim);
+        count_ *= dim;
+        s = next;
+    }
+    if (header.find("'fortran_order': True") != std::string::npos && shape_.size() > 1) {
+        printf("ERROR: fortran_order tensors are not supported (%s)\n", path.c_str());
+        return false;
+    }
+
+    data_ = p + offset + header_len;
+    size_t elem = dtype_ == TensorDType::FP32 ? 4 : 2;
+    if ((size_t)(p + map_len_ - data_) < count_ * elem) {
+        printf("ERROR: .npy payload of %s is shorter than its shape\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ===================================================================
+// 命令行选项
+// ===================================================================
+static bool parse_dtype(const char* s, TensorDType& dtype) {
+    if (!strcmp(s, "fp32")) dtype = TensorDType::FP32;
+    else if (!strcmp(s, "fp16")) dtype = TensorDType::FP16;
+    else if (!strcmp(s, "bf16")) dtype = TensorDType::BF16;
+    else return false;
+    return true;
+}
+
+bool parse_trace_option(const char* arg, TraceSpec& spec, bool& ok) {
+    auto value = [arg](const char* key) -> const char* {
+        size_t n = strlen(key);
+        return strncmp(arg, key, n) == 0 ? arg + n : nullptr;
+    };
+    const char* v;
+    ok = true;
+    if ((v = value("--trace-a="))) {
+        spec.a_path = v;
+    } else if ((v = value("--trace-b="))) {
+        spec.b_path = v;
+    } else if ((v = value("--trace-c="))) {
+        spec.c_path = v;
+    } else if ((v = value("--trace-dtype="))) {
+        ok = parse_dtype(v, spec.dtype);
+        spec.has_dtype = true;
+    } else if ((v = value("--trace-mode="))) {
+        ok = parse_test_mode(v, spec.mode);
+        spec.has_mode = true;
+    } else if ((v = value("--trace-layout="))) {
+        if (!strcmp(v, "elementwise")) {
+            spec.layout = TraceLayout::Elementwise;
+        } else if (!strcmp(v, "outer")) {
+            spec.layout = TraceLayout::OuterProduct;
+        } else if (!strncmp(v, "gemm:", 5)) {
+            spec.layout = TraceLayout::GemmTile;
+            ok = sscanf(v + 5, "%zu,%zu,%zu", &spec.M, &spec.N, &spec.K) == 3 &&
+                 spec.M > 0 && spec.N > 0 && spec.K > 0;
+        } else {
+            ok = false;
+        }
+    } else {
+        return false;
+    }
+    if (!ok) {
+        printf("ERROR: bad option %s\n", arg);
+    }
+    return true;
+}
+
+// ===================================================================
+// 格式转换与误差统计
+// ===================================================================
+static float bits_to_float(uint32_t bits, TensorDType t) {
+    switch (t) {
+        case TensorDType::FP16: return fp16_to_fp32(bits);
+        case TensorDType::BF16: return bf16_to_fp32(bits);
+        default: {
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+    }
+}
+
+static uint32_t float_to_bits(float f, TensorDType t) {
+    switch (t) {
+        case TensorDType::FP16: return fp32_to_fp16(f);
+        case TensorDType::BF16: return fp32_to_bf16(f);
+        default: {
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+    }
+}
+
+// 读取张量元素并转换为运算所需的格式 (同格式时直接取位模式)
+static uint32_t operand_bits(const MappedTensor& t, size_t i, TensorDType fmt) {
+    uint32_t bits = t.bits(i);
+    return t.dtype() == fmt ? bits : float_to_bits(bits_to_float(bits, t.dtype()), fmt);
+}
+
+// 符号-数值编码转换为有序整数, 用于计算跨零的ULP距离
+static int64_t ordered(uint32_t bits, TensorDType t) {
+    uint32_t sign_bit = t == TensorDType::FP32 ? 0x80000000u : 0x8000u;
+    int64_t mag = bits & (sign_bit - 1);
+    return (bits & sign_bit) ? -mag : mag;
+}
+
+struct AccuracyStats {
+    uint64_t count = 0, exact = 0, nonfinite = 0;
+    uint64_t max_ulp = 0;
+    double sum_ulp = 0, max_rel = 0;
+
+    void add(uint32_t dut_bits, double ref, TensorDType fmt) {
+        uint32_t ref_bits = float_to_bits((float)ref, fmt);
+        double dut = bits_to_float(dut_bits, fmt);
+        count++;
+        if (!std::isfinite(dut) || !std::isfinite(ref)) {
+            if (dut_bits != ref_bits) nonfinite++;
+            else exact++;
+            return;
+        }
+        uint64_t ulp = std::llabs(ordered(dut_bits, fmt) - ordered(ref_bits, fmt));
+        exact += (ulp == 0);
+        max_ulp = std::max(max_ulp, ulp);
+        sum_ulp += ulp;
+        if (ref != 0) {
+            max_rel = std::max(max_rel, std::fabs(dut - ref) / std::fabs(ref));
+        }
+    }
+
+    void print() const {
+        printf("Accuracy vs fp64 reference (%lu results):\n", count);
+        printf("  exact: %lu (%.2f%%), max ULP: %lu, mean ULP: %.4f, max relative error: %.6e\n",
+               exact, count ? 100.0 * exact / count : 0.0, max_ulp,
+               count ? sum_ulp / count : 0.0, max_rel);
+        if (nonfinite) {
+            printf("  inf/nan mismatches: %lu\n", nonfinite);
+        }
+    }
+};
+
+// ===================================================================
+// 张量回放
+// ===================================================================
+namespace {
+
+struct ModeFormat {
+    TensorDType in, out;
+    int lanes;
+};
+
+ModeFormat mode_format(TestMode mode) {
+    switch (mode) {
+        case TestMode::FP16:       return {TensorDType::FP16, TensorDType::FP16, 2};
+        case TestMode::BF16:       return {TensorDType::BF16, TensorDType::BF16, 2};
+        case TestMode::FP16_Widen: return {TensorDType::FP16, TensorDType::FP32, 1};
+        case TestMode::BF16_Widen: return {TensorDType::BF16, TensorDType::FP32, 1};
+        default:                   return {TensorDType::FP32, TensorDType::FP32, 1};
+    }
+}
+
+// 一次标量FMA在三个张量中的下标
+struct ScalarOp {
+    size_t a, b, c;
+};
+
+class TraceRunner {
+public:
+    TraceRunner(Simulator& sim, TestMode mode, const MappedTensor& a, const MappedTensor& b,
+                const MappedTensor* c)
+        : sim_(sim), fmt_(mode_format(mode)), a_(a), b_(b), c_(c) {
+        base_.is_fp32 = mode == TestMode::FP32;
+        base_.is_fp16 = mode == TestMode::FP16 || mode == TestMode::FP16_Widen;
+        base_.is_bf16 = mode == TestMode::BF16 || mode == TestMode::BF16_Widen;
+        base_.is_widen = mode == TestMode::FP16_Widen || mode == TestMode::BF16_Widen;
+    }
+
+    // 把 n 个标量FMA打包成DUT操作并背靠背发射
+    // c_bits: 每个标量FMA的加数 (输出格式); on_result: 按标量下标回收结果
+    template <typename OpAt, typename CBits, typename OnResult>
+    void stream(size_t n, OpAt op_at, CBits c_bits, OnResult on_result) {
+        size_t next = 0;
+        std::deque<size_t> inflight;
+        auto source = [&](DutInputs& in) {
+            if (next >= n) return false;
+            in = base_;
+            for (int l = 0; l < fmt_.lanes && next + l < n; l++) {
+                ScalarOp op = op_at(next + l);
+                uint32_t a = operand_bits(a_, op.a, fmt_.in);
+                uint32_t b = operand_bits(b_, op.b, fmt_.in);
+                uint32_t c = c_bits(next + l, op);
+                if (fmt_.lanes == 2) {
+                    in.a_in_16[l] = a;
+                    in.b_in_16[l] = b;
+                    in.c_in_16[l] = c;
+                } else if (base_.is_widen) {
+                    // widen: a,b 放在32位输入的高16位
+                    in.a_in_16[1] = a;
+                    in.b_in_16[1] = b;
+                    in.c_in_32 = c;
+                } else {
+                    in.a_in_32 = a;
+                    in.b_in_32 = b;
+                    in.c_in_32 = c;
+                }
+            }
+            inflight.push_back(next);
+            next += fmt_.lanes;
+            dut_ops_++;
+            return true;
+        };
+        auto sink = [&](const DutOutputs& out) {
+            size_t first = inflight.front();
+            inflight.pop_front();
+            if (fmt_.lanes == 2) {
+                on_result(first, out.res_out_16_0);
+                if (first + 1 < n) on_result(first + 1, out.res_out_16_1);
+            } else {
+                on_result(first, out.res_out_32);
+            }
+        };
+
+        auto t0 = std::chrono::steady_clock::now();
+        cycles_ += sim_.run_stream(source, sink);
+        seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        scalar_ops_ += n;
+    }
+
+    // 操作数的双精度值, 用于参考结果
+    double a_val(size_t i) const { return bits_to_float(operand_bits(a_, i, fmt_.in), fmt_.in); }
+    double b_val(size_t i) const { return bits_to_float(operand_bits(b_, i, fmt_.in), fmt_.in); }
+    double c_val(size_t i) const {
+        return c_ ? bits_to_float(operand_bits(*c_, i, fmt_.out), fmt_.out) : 0.0;
+    }
+    uint32_t c_in(size_t i) const { return c_ ? operand_bits(*c_, i, fmt_.out) : 0; }
+
+    const ModeFormat& fmt() const { return fmt_; }
+
+    void print_throughput() const {
+        printf("Throughput: %lu scalar FMAs in %lu DUT ops, %lu cycles (%.3f FMA/cycle)\n",
+               scalar_ops_, dut_ops_, cycles_, cycles_ ? (double)scalar_ops_ / cycles_ : 0.0);
+        printf("Simulation speed: %.3f s, %.0f FMA/s, %.0f cycles/s\n", seconds_,
+               seconds_ > 0 ? scalar_ops_ / seconds_ : 0.0, seconds_ > 0 ? cycles_ / seconds_ : 0.0);
+    }
+
+private:
+    Simulator& sim_;
+    ModeFormat fmt_;
+    const MappedTensor& a_;
+    const MappedTensor& b_;
+    const MappedTensor* c_;
+    DutInputs base_ = {};
+
+    uint64_t dut_ops_ = 0, scalar_ops_ = 0, cycles_ = 0;
+    double seconds_ = 0;
+};
+
+} // namespace
+
+bool run_tensor_trace(Simulator& sim, const TraceSpec& spec) {
+    if (spec.a_path.empty() || spec.b_path.empty()) {
+        printf("ERROR: --trace-a and --trace-b are required\n");
+        return false;
+    }
+    const TensorDType* dtype_override = spec.has_dtype ? &spec.dtype : nullptr;
+    MappedTensor a, b, c;
+    if (!a.open(spec.a_path, dtype_override) || !b.open(spec.b_path, dtype_override)) {
+        return false;
+    }
+    bool has_c = !spec.c_path.empty();
+    if (has_c && !c.open(spec.c_path, dtype_override)) {
+        return false;
+    }
+
+    TestMode mode = spec.mode;
+    if (!spec.has_mode) {
+        mode = a.dtype() == TensorDType::FP16 ? TestMode::FP16 :
+               a.dtype() == TensorDType::BF16 ? TestMode::BF16 : TestMode::FP32;
+    }
+    TraceRunner runner(sim, mode, a, b, has_c ? &c : nullptr);
+    TensorDType out_fmt = runner.fmt().out;
+    AccuracyStats stats;
+
+    printf("--- Tensor trace replay: a=%s (%zu), b=%s (%zu), c=%s (%zu) ---\n",
+           spec.a_path.c_str(), a.size(), spec.b_path.c_str(), b.size(),
+           has_c ? spec.c_path.c_str() : "0", has_c ? c.size() : 0);
+
+    switch (spec.layout) {
+        case TraceLayout::Elementwise:
+        case TraceLayout::OuterProduct: {
+            bool outer = spec.layout == TraceLayout::OuterProduct;
+            size_t N = b.size();
+            size_t n = outer ? a.size() * N : std::min(a.size(), b.size());
+            if (has_c && c.size() < n) {
+                if (outer) {
+                    printf("ERROR: c has %zu elements, outer product needs %zu\n", c.size(), n);
+                    return false;
+                }
+                n = c.size();
+            }
+            auto op_at = [&](size_t j) {
+                return outer ? ScalarOp{j / N, j % N, j} : ScalarOp{j, j, j};
+            };
+            auto c_bits = [&](size_t, const ScalarOp& op) { return runner.c_in(op.c); };
+            auto on_result = [&](size_t j, uint32_t res) {
+                ScalarOp op = op_at(j);
+                stats.add(res, runner.a_val(op.a) * runner.b_val(op.b) + runner.c_val(op.c), out_fmt);
+            };
+            runner.stream(n, op_at, c_bits, on_result);
+            break;
+        }
+        case TraceLayout::GemmTile: {
+            size_t M = spec.M, N = spec.N, K = spec.K;
+            if (a.size() < M * K || b.size() < K * N || (has_c && c.size() < M * N)) {
+                printf("ERROR: tensors are too small for a %zux%zux%zu GEMM tile\n", M, N, K);
+                return false;
+            }
+            // 累加器保存在输出格式中, 每一轮k的结果作为下一轮的c
+            std::vector<uint32_t> acc(M * N);
+            std::vector<double> ref(M * N);
+            for (size_t i = 0; i < M * N; i++) {
+                acc[i] = runner.c_in(i);
+                ref[i] = runner.c_val(i);
+            }
+            for (size_t k = 0; k < K; k++) {
+                auto op_at = [&](size_t j) { return ScalarOp{(j / N) * K + k, k * N + j % N, j}; };
+                auto c_bits = [&](size_t j, const ScalarOp&) { return acc[j]; };
+                auto on_result = [&](size_t j, uint32_t res) { acc[j] = res; };
+                // 同一轮内各(m,n)互不相关; 轮与轮之间依赖累加结果, 因此每轮排空流水线
+                runner.stream(M * N, op_at, c_bits, on_result);
+                for (size_t j = 0; j < M * N; j++) {
+                    ScalarOp op = op_at(j);
+                    ref[j] += runner.a_val(op.a) * runner.b_val(op.b);
+                }
+            }
+            for (size_t j = 0; j < M * N; j++) {
+                stats.add(acc[j], ref[j], out_fmt);
+            }
+            break;
+        }
+    }
+
+    runner.print_throughput();
+    stats.print();
+    return true;
+}
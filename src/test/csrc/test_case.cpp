@@ -1,9 +1,11 @@
 #include "include/test_case.h"
+#include "include/checker.h"
 #include <iostream>
 #include <bitset>
 #include <memory>
 #include <cmath>
 #include <cstring>
+#include <algorithm>
 
 // ===================================================================
 // TestCase 实现
@@ -27,6 +29,9 @@ TestCase::TestCase(const FMA_Operands_Hex& ops_hex, ErrorType error_type)
     // 计算期望结果
     float expected_fp = op_fp.a * op_fp.b + op_fp.c;
     memcpy(&expected_res_fp32, &expected_fp, sizeof(uint32_t));
+
+    rel_scale[0] = std::max(std::abs(op_fp.a * op_fp.b), std::abs(op_fp.c));
+    rel_scale[1] = 0;
 }
 
 // FP16 dual operation constructor
@@ -93,6 +98,9 @@ TestCase::TestCase(const FMA_Operands_Hex_16& op1, const FMA_Operands_Hex_16& op
     
     expected_res1_fp16 = fp32_to_fp16(expected_fp1);
     expected_res2_fp16 = fp32_to_fp16(expected_fp2);
+
+    rel_scale[0] = std::max(std::abs(op1_fp.a * op1_fp.b), std::abs(op1_fp.c));
+    rel_scale[1] = std::max(std::abs(op2_fp.a * op2_fp.b), std::abs(op2_fp.c));
 }
 
 // BF16 dual operation constructor
@@ -159,6 +167,9 @@ TestCase::TestCase(const FMA_Operands_Hex_BF16& op1, const FMA_Operands_Hex_BF16
     
     expected_res1_bf16 = fp32_to_bf16(expected_fp1);
     expected_res2_bf16 = fp32_to_bf16(expected_fp2);
+
+    rel_scale[0] = std::max(std::abs(op1_fp.a * op1_fp.b), std::abs(op1_fp.c));
+    rel_scale[1] = std::max(std::abs(op2_fp.a * op2_fp.b), std::abs(op2_fp.c));
 }
 
 // FP16 widen operation constructor
@@ -183,6 +194,9 @@ TestCase::TestCase(const FMA_Operands_FP16_Widen& ops_widen, ErrorType error_typ
     
     // 转换期望结果为位表示
     memcpy(&expected_res_fp32, &expected_fp, sizeof(uint32_t));
+
+    // Widen 只做ULP检查，不需要相对误差尺度
+    rel_scale[0] = rel_scale[1] = 0;
 }
 
 // BF16 widen operation constructor
@@ -207,6 +221,54 @@ TestCase::TestCase(const FMA_Operands_BF16_Widen& ops_widen, ErrorType error_typ
     
     // 转换期望结果为位表示
     memcpy(&expected_res_fp32, &expected_fp, sizeof(uint32_t));
+
+    // Widen 只做ULP检查，不需要相对误差尺度
+    rel_scale[0] = rel_scale[1] = 0;
+}
+
+DutInputs TestCase::dut_inputs() const {
+    DutInputs in = {};
+    in.is_fp32  = is_fp32;
+    in.is_fp16  = is_fp16;
+    in.is_bf16  = is_bf16;
+    in.is_widen = is_widen;
+
+    switch(mode) {
+        case TestMode::FP32:
+            in.a_in_32 = a_fp32_bits;
+            in.b_in_32 = b_fp32_bits;
+            in.c_in_32 = c_fp32_bits;
+            break;
+        case TestMode::FP16:
+            // 注意：Verilator会把 a_in_16: Vec(2, UInt(16.W)) 转换成 io_a_in_16_0, io_a_in_16_1
+            in.a_in_16[0] = a1_fp16_bits;
+            in.b_in_16[0] = b1_fp16_bits;
+            in.c_in_16[0] = c1_fp16_bits;
+            in.a_in_16[1] = a2_fp16_bits;
+            in.b_in_16[1] = b2_fp16_bits;
+            in.c_in_16[1] = c2_fp16_bits;
+            break;
+        case TestMode::BF16:
+            // BF16也使用16位端口
+            in.a_in_16[0] = a1_bf16_bits;
+            in.b_in_16[0] = b1_bf16_bits;
+            in.c_in_16[0] = c1_bf16_bits;
+            in.a_in_16[1] = a2_bf16_bits;
+            in.b_in_16[1] = b2_bf16_bits;
+            in.c_in_16[1] = c2_bf16_bits;
+            break;
+        case TestMode::FP16_Widen:
+        case TestMode::BF16_Widen:
+            // Widen: a,b是FP16/BF16, c是FP32
+            // 在test_case中，a,b的16位值被存在了a_fp32_bits的高16位
+            in.a_in_16[0] = 0;
+            in.a_in_16[1] = (a_fp32_bits >> 16) & 0xFFFF;
+            in.b_in_16[0] = 0;
+            in.b_in_16[1] = (b_fp32_bits >> 16) & 0xFFFF;
+            in.c_in_32 = c_fp32_bits;
+            break;
+    }
+    return in;
 }
 
 void TestCase::print_details() const {
@@ -271,270 +333,88 @@ void TestCase::print_details() const {
     }
 }
 
-bool TestCase::check_result(const DutOutputs& dut_res) const {
-    printf("--- Verification ---\n");
-    
-    // 辅助函数：检查两个FP32数是否都是零（忽略符号位）
-    auto both_fp32_zero = [](uint32_t a, uint32_t b) {
-        return ((a & 0x7FFFFFFF) == 0) && ((b & 0x7FFFFFFF) == 0);
-    };
-    
-    // 辅助函数：检查两个FP/BF16数是否都是零（忽略符号位）
-    auto both_f16_zero = [](uint16_t a, uint16_t b) {
-        return ((a & 0x7FFF) == 0) && ((b & 0x7FFF) == 0);
+template <TestMode M, ErrorType E>
+bool TestCase::check_impl(const DutOutputs& dut_res) const {
+    using Traits = ModeTraits<M>;
+    using Check = LaneCheck<typename Traits::Fmt, EffectiveError<M, E>::value>;
+    constexpr Tolerance tol = Traits::tol();
+
+    if (Traits::kLanes == 1) {
+        return Check::pass(dut_res.res_out_32, expected_res_fp32, rel_scale[0], tol);
+    }
+    uint32_t expected1 = M == TestMode::FP16 ? expected_res1_fp16 : expected_res1_bf16;
+    uint32_t expected2 = M == TestMode::FP16 ? expected_res2_fp16 : expected_res2_bf16;
+    // 两路都要检查，用按位与避免短路分支
+    return Check::pass(dut_res.res_out_16_0, expected1, rel_scale[0], tol) &
+           Check::pass(dut_res.res_out_16_1, expected2, rel_scale[1], tol);
+}
+
+bool TestCase::check_result(const DutOutputs& dut_res, bool verbose) const {
+    using CheckFn = bool (TestCase::*)(const DutOutputs&) const;
+#define CHECK_ROW(M) { &TestCase::check_impl<M, ErrorType::Precise>, \
+                       &TestCase::check_impl<M, ErrorType::ULP>, \
+                       &TestCase::check_impl<M, ErrorType::RelativeError>, \
+                       &TestCase::check_impl<M, ErrorType::ULP_or_RelativeError> }
+    // 下标与 TestMode / ErrorType 的枚举顺序一致
+    static const CheckFn check_table[5][4] = {
+        CHECK_ROW(TestMode::FP32),
+        CHECK_ROW(TestMode::FP16),
+        CHECK_ROW(TestMode::BF16),
+        CHECK_ROW(TestMode::FP16_Widen),
+        CHECK_ROW(TestMode::BF16_Widen),
     };
-    
-    bool pass = false;
-    switch(mode) {
-        case TestMode::FP32: {
-            float dut_res_fp;
-            memcpy(&dut_res_fp, &dut_res.res_out_32, sizeof(float));
-            printf("DUT Result: %.8f (HEX: 0x%08X)\n", dut_res_fp, dut_res.res_out_32);
-            float expected_fp;
-            memcpy(&expected_fp, &expected_res_fp32, sizeof(float));
-            int64_t ulp_diff = 0;
-            float relative_error = 0;
+#undef CHECK_ROW
 
-            bool precise_pass = (dut_res.res_out_32 == expected_res_fp32);
-            
-            // 如果两个数都是0（忽略符号位），认为通过
-            bool both_zero = both_fp32_zero(dut_res.res_out_32, expected_res_fp32);
-            
-            if (error_type == ErrorType::Precise) {
-                pass = precise_pass || both_zero;
-            }
-            if (error_type == ErrorType::ULP) {
-                // 允许8 ulp (unit in the last place) 的误差
-                ulp_diff = std::abs((int64_t)dut_res.res_out_32 - (int64_t)expected_res_fp32);
-                pass = (ulp_diff <= 8) || both_zero;
-            }
-            if (error_type == ErrorType::RelativeError) {
-                float max_abs = std::max(std::abs(op_fp.a * op_fp.b), std::abs(op_fp.c));
-                relative_error = std::abs(dut_res_fp - expected_fp) / max_abs;
-                pass = ((max_abs < std::pow(2, -60)) 
-                       ? (relative_error < 1e-3) //若ab或c的绝对值太小，则放宽误差要求
-                       : (relative_error < 1e-5)) 
-                       || precise_pass || both_zero;
-            }
-            if (!pass) {
-                if (error_type == ErrorType::Precise) {
-                    printf("ERROR: Expected 0x%08X, Got 0x%08X (Exact match required)\n", 
-                           expected_res_fp32, dut_res.res_out_32);
-                }
-                if (error_type == ErrorType::ULP) {
-                    printf("ERROR: Expected 0x%08X, Got 0x%08X, ULP diff: %ld\n", 
-                           expected_res_fp32, dut_res.res_out_32, ulp_diff);
-                }
-                if (error_type == ErrorType::RelativeError) {
-                    printf("ERROR: Expected 0x%08X, Got 0x%08X, Relative Error: %f\n", 
-                           expected_res_fp32, dut_res.res_out_32, relative_error);
-                }
-            }
-            if (error_type == ErrorType::ULP) {
-                printf("ULP diff: %ld\n", ulp_diff);
-            }
-            if (error_type == ErrorType::RelativeError) {
-                printf("Relative diff ratio: %.8e\n", relative_error);
-            }
-            break;
-        }
-        case TestMode::FP16: {
-            printf("DUT Result1: %.4f (HEX: 0x%x)\n", fp16_to_fp32(dut_res.res_out_16_0), dut_res.res_out_16_0);
-            printf("DUT Result2: %.4f (HEX: 0x%x)\n", fp16_to_fp32(dut_res.res_out_16_1), dut_res.res_out_16_1);
+    bool pass = (this->*check_table[(int)mode][(int)error_type])(dut_res);
+    if (!pass || verbose) {
+        report_result(dut_res, pass);
+    }
+    return pass;
+}
 
-            bool pass1 = false, pass2 = false;
-            
-            // 检查两个数是否都是0（忽略符号位）
-            bool both_zero1 = both_f16_zero(dut_res.res_out_16_0, expected_res1_fp16);
-            bool both_zero2 = both_f16_zero(dut_res.res_out_16_1, expected_res2_fp16);
-            
-            if (error_type == ErrorType::Precise) {
-                // 精确匹配
-                pass1 = (dut_res.res_out_16_0 == expected_res1_fp16) || both_zero1;
-                pass2 = (dut_res.res_out_16_1 == expected_res2_fp16) || both_zero2;
-            } else if (error_type == ErrorType::ULP) {
-                // 允许ULP误差（FP16允许2 ULP误差）
-                int32_t ulp_diff1 = std::abs((int32_t)dut_res.res_out_16_0 - (int32_t)expected_res1_fp16);
-                int32_t ulp_diff2 = std::abs((int32_t)dut_res.res_out_16_1 - (int32_t)expected_res2_fp16);
-                pass1 = (ulp_diff1 <= 5) || both_zero1;
-                pass2 = (ulp_diff2 <= 5) || both_zero2;
-                
-                if (!pass1) {
-                    printf("ERROR OP1: Expected 0x%x, Got 0x%x, ULP diff: %d\n", 
-                           expected_res1_fp16, dut_res.res_out_16_0, ulp_diff1);
-                }
-                if (!pass2) {
-                    printf("ERROR OP2: Expected 0x%x, Got 0x%x, ULP diff: %d\n", 
-                           expected_res2_fp16, dut_res.res_out_16_1, ulp_diff2);
-                }
-                printf("ULP diff1: %d, ULP diff2: %d\n", ulp_diff1, ulp_diff2);
-            } else if (error_type == ErrorType::RelativeError) {
-                // 相对误差检查（FP16）
-                float dut_res1_fp = fp16_to_fp32(dut_res.res_out_16_0);
-                float dut_res2_fp = fp16_to_fp32(dut_res.res_out_16_1);
-                float expected1_fp = fp16_to_fp32(expected_res1_fp16);
-                float expected2_fp = fp16_to_fp32(expected_res2_fp16);
-                
-                // 计算操作数1的相对误差
-                float max_abs1 = std::max(std::abs(op1_fp.a * op1_fp.b), std::abs(op1_fp.c));
-                float relative_error1 = std::abs(dut_res1_fp - expected1_fp) / max_abs1;
-                bool precise_pass1 = (dut_res.res_out_16_0 == expected_res1_fp16);
-                pass1 = ((max_abs1 < std::pow(2, -10))  // FP16精度较低，调整阈值
-                        ? (relative_error1 < 1e-2)      // 若ab或c的绝对值太小，则放宽误差要求
-                        : (relative_error1 < 1e-3))     // FP16相对误差要求比FP32宽松
-                        || precise_pass1 || both_zero1;
-                
-                // 计算操作数2的相对误差
-                float max_abs2 = std::max(std::abs(op2_fp.a * op2_fp.b), std::abs(op2_fp.c));
-                float relative_error2 = std::abs(dut_res2_fp - expected2_fp) / max_abs2;
-                bool precise_pass2 = (dut_res.res_out_16_1 == expected_res2_fp16);
-                pass2 = ((max_abs2 < std::pow(2, -10))  // FP16精度较低，调整阈值
-                        ? (relative_error2 < 1e-2)      // 若ab或c的绝对值太小，则放宽误差要求
-                        : (relative_error2 < 1e-3))     // FP16相对误差要求比FP32宽松
-                        || precise_pass2 || both_zero2;
-                
-                if (!pass1) {
-                    printf("ERROR OP1: Expected 0x%x (%.4f), Got 0x%x (%.4f), Relative Error: %e\n", 
-                           expected_res1_fp16, expected1_fp, dut_res.res_out_16_0, dut_res1_fp, relative_error1);
-                }
-                if (!pass2) {
-                    printf("ERROR OP2: Expected 0x%x (%.4f), Got 0x%x (%.4f), Relative Error: %e\n", 
-                           expected_res2_fp16, expected2_fp, dut_res.res_out_16_1, dut_res2_fp, relative_error2);
-                }
-                printf("Relative error1: %.6e, Relative error2: %.6e\n", relative_error1, relative_error2);
-            }
-            
-            pass = pass1 && pass2;
-            break;
-        }
-        case TestMode::BF16: {
-            printf("DUT Result1: %.4f (HEX: 0x%x)\n", bf16_to_fp32(dut_res.res_out_16_0), dut_res.res_out_16_0);
-            printf("DUT Result2: %.4f (HEX: 0x%x)\n", bf16_to_fp32(dut_res.res_out_16_1), dut_res.res_out_16_1);
+// 诊断信息: 只在失败或 verbose 时调用
+void TestCase::report_result(const DutOutputs& dut_res, bool pass) const {
+    if (!pass) {
+        print_details();
+    }
+    printf("--- Verification ---\n");
 
-            bool pass1 = false, pass2 = false;
-            
-            // 检查两个数是否都是0（忽略符号位）
-            bool both_zero1 = both_f16_zero(dut_res.res_out_16_0, expected_res1_bf16);
-            bool both_zero2 = both_f16_zero(dut_res.res_out_16_1, expected_res2_bf16);
-            
-            // 先计算ULP和RelativeError下的通过情况
-            bool ulp_pass1 = false, ulp_pass2 = false;
-            bool rel_pass1 = false, rel_pass2 = false;
-            
-            // ULP误差计算（BF16允许2 ULP误差）
-            int32_t ulp_diff1 = std::abs((int32_t)dut_res.res_out_16_0 - (int32_t)expected_res1_bf16);
-            int32_t ulp_diff2 = std::abs((int32_t)dut_res.res_out_16_1 - (int32_t)expected_res2_bf16);
-            ulp_pass1 = (ulp_diff1 <= 2) || both_zero1;
-            ulp_pass2 = (ulp_diff2 <= 2) || both_zero2;
-            
-            // 相对误差计算（BF16）
-            float dut_res1_fp = bf16_to_fp32(dut_res.res_out_16_0);
-            float dut_res2_fp = bf16_to_fp32(dut_res.res_out_16_1);
-            float expected1_fp = bf16_to_fp32(expected_res1_bf16);
-            float expected2_fp = bf16_to_fp32(expected_res2_bf16);
-            
-            // 计算操作数1的相对误差
-            float max_abs1 = std::max(std::abs(op1_fp.a * op1_fp.b), std::abs(op1_fp.c));
-            float relative_error1 = std::abs(dut_res1_fp - expected1_fp) / max_abs1;
-            bool precise_pass1 = (dut_res.res_out_16_0 == expected_res1_bf16);
-            rel_pass1 = ((max_abs1 < std::pow(2, -30))  // BF16有较好的指数范围，但尾数精度较低
-                    ? (relative_error1 < 1e-2)      // 若ab或c的绝对值太小，则放宽误差要求
-                    : (relative_error1 < 8e-3))     // BF16相对误差要求介于FP32和FP16之间
-                    || precise_pass1 || both_zero1;
-            
-            // 计算操作数2的相对误差
-            float max_abs2 = std::max(std::abs(op2_fp.a * op2_fp.b), std::abs(op2_fp.c));
-            float relative_error2 = std::abs(dut_res2_fp - expected2_fp) / max_abs2;
-            bool precise_pass2 = (dut_res.res_out_16_1 == expected_res2_bf16);
-            rel_pass2 = ((max_abs2 < std::pow(2, -30))  // BF16有较好的指数范围，但尾数精度较低
-                    ? (relative_error2 < 1e-2)      // 若ab或c的绝对值太小，则放宽误差要求
-                    : (relative_error2 < 8e-3))     // BF16相对误差要求介于FP32和FP16之间
-                    || precise_pass2 || both_zero2;
-            
-            // 根据错误类型决定最终的通过条件
-            if (error_type == ErrorType::Precise) {
-                // 精确匹配
-                pass1 = (dut_res.res_out_16_0 == expected_res1_bf16) || both_zero1;
-                pass2 = (dut_res.res_out_16_1 == expected_res2_bf16) || both_zero2;
-            } else if (error_type == ErrorType::ULP) {
-                // 只使用ULP误差
-                pass1 = ulp_pass1;
-                pass2 = ulp_pass2;
-                
-                if (!pass1) {
-                    printf("ERROR OP1: Expected 0x%x, Got 0x%x, ULP diff: %d\n", 
-                           expected_res1_bf16, dut_res.res_out_16_0, ulp_diff1);
-                }
-                if (!pass2) {
-                    printf("ERROR OP2: Expected 0x%x, Got 0x%x, ULP diff: %d\n", 
-                           expected_res2_bf16, dut_res.res_out_16_1, ulp_diff2);
-                }
-                printf("ULP diff1: %d, ULP diff2: %d\n", ulp_diff1, ulp_diff2);
-            } else if (error_type == ErrorType::RelativeError) {
-                // 只使用相对误差
-                pass1 = rel_pass1;
-                pass2 = rel_pass2;
-                
-                if (!pass1) {
-                    printf("ERROR OP1: Expected 0x%x (%.4f), Got 0x%x (%.4f), Relative Error: %e\n", 
-                           expected_res1_bf16, expected1_fp, dut_res.res_out_16_0, dut_res1_fp, relative_error1);
-                }
-                if (!pass2) {
-                    printf("ERROR OP2: Expected 0x%x (%.4f), Got 0x%x (%.4f), Relative Error: %e\n", 
-                           expected_res2_bf16, expected2_fp, dut_res.res_out_16_1, dut_res2_fp, relative_error2);
-                }
-                printf("Relative error1: %.6e, Relative error2: %.6e\n", relative_error1, relative_error2);
-            } else if (error_type == ErrorType::ULP_or_RelativeError) {
-                // ULP或相对误差：如果ULP通过则通过，否则如果相对误差通过则通过，否则不通过
-                pass1 = ulp_pass1 || rel_pass1;
-                pass2 = ulp_pass2 || rel_pass2;
-                
-                if (!pass1) {
-                    printf("ERROR OP1: ULP diff: %d (>2), Relative Error: %e (>8e-3)\n", ulp_diff1, relative_error1);
-                }
-                if (!pass2) {
-                    printf("ERROR OP2: ULP diff: %d (>2), Relative Error: %e (>8e-3)\n", ulp_diff2, relative_error2);
-                }
-                printf("ULP diff1: %d, ULP diff2: %d\n", ulp_diff1, ulp_diff2);
-                printf("Relative error1: %.6e, Relative error2: %.6e\n", relative_error1, relative_error2);
-            }
-            
-            pass = pass1 && pass2;
-            break;
-        }
+    const char* error_names[] = {"Precise", "ULP", "RelativeError", "ULP_or_RelativeError"};
+    printf("Error type: %s\n", error_names[(int)error_type]);
+
+    switch(mode) {
+        case TestMode::FP32:
         case TestMode::FP16_Widen:
-        case TestMode::BF16_Widen:
-        {
-            float dut_res_fp;
+        case TestMode::BF16_Widen: {
+            float dut_res_fp, expected_fp;
             memcpy(&dut_res_fp, &dut_res.res_out_32, sizeof(float));
-            printf("DUT Result: %.8f (HEX: 0x%08X)\n", dut_res_fp, dut_res.res_out_32);
-            
-            float expected_fp;
             memcpy(&expected_fp, &expected_res_fp32, sizeof(float));
-            
-            int64_t ulp_diff = std::abs((int64_t)dut_res.res_out_32 - (int64_t)expected_res_fp32);
-            bool both_zero = both_fp32_zero(dut_res.res_out_32, expected_res_fp32);
-
-            if (error_type == ErrorType::Precise) {
-                pass = (dut_res.res_out_32 == expected_res_fp32) || both_zero;
-            } else {
-                pass = (ulp_diff <= 2) || both_zero; // Widen to FP32, allow small ULP error
+            printf("DUT Result: %.8f (HEX: 0x%08X)\n", dut_res_fp, dut_res.res_out_32);
+            printf("Expected 0x%08X, Got 0x%08X, ULP diff: %u", expected_res_fp32, dut_res.res_out_32,
+                   ulp_diff(dut_res.res_out_32, expected_res_fp32));
+            if (mode == TestMode::FP32) {
+                printf(", Relative Error: %.8e", std::abs(dut_res_fp - expected_fp) / rel_scale[0]);
             }
-
-            if (!pass) {
-                printf("ERROR: Expected 0x%08X, Got 0x%08X, ULP diff: %ld\n", 
-                       expected_res_fp32, dut_res.res_out_32, ulp_diff);
+            printf("\n");
+            break;
+        }
+        case TestMode::FP16:
+        case TestMode::BF16: {
+            bool fp16 = mode == TestMode::FP16;
+            uint16_t dut[2] = {dut_res.res_out_16_0, dut_res.res_out_16_1};
+            uint16_t expected[2] = {fp16 ? expected_res1_fp16 : expected_res1_bf16,
+                                    fp16 ? expected_res2_fp16 : expected_res2_bf16};
+            for (int i = 0; i < 2; i++) {
+                float dut_fp = fp16 ? fp16_to_fp32(dut[i]) : bf16_to_fp32(dut[i]);
+                float expected_fp = fp16 ? fp16_to_fp32(expected[i]) : bf16_to_fp32(expected[i]);
+                printf("OP%d: Expected 0x%x (%.4f), Got 0x%x (%.4f), ULP diff: %u, Relative Error: %e\n",
+                       i + 1, expected[i], expected_fp, dut[i], dut_fp, ulp_diff(dut[i], expected[i]),
+                       std::abs(dut_fp - expected_fp) / rel_scale[i]);
             }
-            printf("ULP diff: %ld\n", ulp_diff);
             break;
         }
     }
-    
-    if (pass) {
-        printf("Result: PASS\n");
-    } else {
-        printf("Result: FAIL\n");
-    }
+
+    printf("Result: %s\n", pass ? "PASS" : "FAIL");
     printf("-----------------\n\n");
-    return pass;
-} 
\ No newline at end of file
+}
@@ -2,6 +2,114 @@
 #include "include/fp_utils.h"
 #include <vector>
 #include <cstdio>
+#include <cstring>
+
+// ===================================================================
+// 随机向量按 (模式, 指数范围) 分组, 每组一个生成函数
+//   create_all_tests 每组生成 count 个; --bandit 按各组发现失败/新覆盖的收益分配仿真时间 (见 bandit.h)
+// ===================================================================
+static TestCase fp32_band(int a0, int a1, int b0, int b1, int c0, int c1) {
+    FMA_Operands_Hex ops = {gen_random_fp32(a0, a1), gen_random_fp32(b0, b1), gen_random_fp32(c0, c1)};
+    return TestCase(ops, ErrorType::RelativeError);
+}
+
+// 指数范围依次为 a1 b1 c1 a2 b2 c2
+static TestCase fp16_band(const int (&e)[6][2]) {
+    FMA_Operands_Hex_16 ops1 = {gen_random_fp16(e[0][0], e[0][1]), gen_random_fp16(e[1][0], e[1][1]), gen_random_fp16(e[2][0], e[2][1])};
+    FMA_Operands_Hex_16 ops2 = {gen_random_fp16(e[3][0], e[3][1]), gen_random_fp16(e[4][0], e[4][1]), gen_random_fp16(e[5][0], e[5][1])};
+    return TestCase(ops1, ops2, ErrorType::ULP);
+}
+
+static TestCase bf16_band(const int (&e)[6][2]) {
+    FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(e[0][0], e[0][1]), gen_random_bf16(e[1][0], e[1][1]), gen_random_bf16(e[2][0], e[2][1])};
+    FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(e[3][0], e[3][1]), gen_random_bf16(e[4][0], e[4][1]), gen_random_bf16(e[5][0], e[5][1])};
+    return TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError);
+}
+
+const std::vector<RandomBand>& random_bands() {
+    static const std::vector<RandomBand> bands = {
+        // ---- FP32 ----
+        {TestMode::FP32, "fp32 any", 200, [] {
+            FMA_Operands_Hex ops = {gen_any_fp32(), gen_any_fp32(), gen_any_fp32()};
+            return TestCase(ops, ErrorType::RelativeError);
+        }},
+        // 小数 / 中等 / 大数范围
+        {TestMode::FP32, "fp32 [-50,-10]", 200, [] { return fp32_band(-50, -10, -50, -10, -50, -10); }},
+        {TestMode::FP32, "fp32 [-10,10]", 200, [] { return fp32_band(-10, 10, -10, 10, -10, 10); }},
+        {TestMode::FP32, "fp32 [10,50]", 200, [] { return fp32_band(10, 50, 10, 50, 10, 50); }},
+        // 非规格化数: 指数[-127, -126] 的操作数
+        {TestMode::FP32, "fp32 [-126,20]", 200, [] { return fp32_band(-126, 20, -126, 20, -126, 20); }},
+        {TestMode::FP32, "fp32 sub b", 200, [] { return fp32_band(-126, 20, -127, -126, -126, 20); }},
+        {TestMode::FP32, "fp32 sub a", 200, [] { return fp32_band(-127, -126, -126, 20, -126, 20); }},
+        {TestMode::FP32, "fp32 sub c", 200, [] { return fp32_band(-126, 20, -126, 20, -127, -126); }},
+        {TestMode::FP32, "fp32 sub bc", 200, [] { return fp32_band(-126, 20, -127, -126, -127, -126); }},
+        {TestMode::FP32, "fp32 sub abc", 200, [] { return fp32_band(-127, -126, -127, -126, -127, -126); }},
+        {TestMode::FP32, "fp32 [-127,10]", 200, [] { return fp32_band(-127, 10, -127, 10, -127, 10); }},
+
+        // ---- FP16 (两路) ----
+        {TestMode::FP16, "fp16 any", 200, [] {
+            FMA_Operands_Hex_16 ops1 = {gen_any_fp16(), gen_any_fp16(), gen_any_fp16()};
+            FMA_Operands_Hex_16 ops2 = {gen_any_fp16(), gen_any_fp16(), gen_any_fp16()};
+            return TestCase(ops1, ops2, ErrorType::ULP);
+        }},
+        {TestMode::FP16, "fp16 [-15,-5]", 200, [] { return fp16_band({{-15, -5}, {-15, -5}, {-15, -5}, {-15, -5}, {-15, -5}, {-15, -5}}); }},
+        {TestMode::FP16, "fp16 [-5,5]", 200, [] { return fp16_band({{-5, 5}, {-5, 5}, {-5, 5}, {-5, 5}, {-5, 5}, {-5, 5}}); }},
+        {TestMode::FP16, "fp16 [5,15]", 200, [] { return fp16_band({{5, 15}, {5, 15}, {5, 15}, {5, 15}, {5, 15}, {5, 15}}); }},
+        {TestMode::FP16, "fp16 [-15,15]", 200, [] { return fp16_band({{-15, 15}, {-15, 15}, {-15, 15}, {-15, 15}, {-15, 15}, {-15, 15}}); }},
+        // 非规格化数: 指数[-15, -14] 的操作数
+        {TestMode::FP16, "fp16 sub a1 b2", 200, [] { return fp16_band({{-15, -14}, {-15, 15}, {-15, 15}, {-15, 15}, {-15, -14}, {-15, 15}}); }},
+        {TestMode::FP16, "fp16 sub c1 b2 c2", 200, [] { return fp16_band({{-15, 15}, {-15, 15}, {-15, -14}, {-15, 15}, {-15, -14}, {-15, -14}}); }},
+        {TestMode::FP16, "fp16 sub ab1 abc2", 200, [] { return fp16_band({{-15, -14}, {-15, -14}, {-15, 15}, {-15, -14}, {-15, -14}, {-15, -14}}); }},
+        {TestMode::FP16, "fp16 sub all", 200, [] { return fp16_band({{-15, -14}, {-15, -14}, {-15, -14}, {-15, -14}, {-15, -14}, {-15, -14}}); }},
+
+        // ---- BF16 (两路) ----
+        {TestMode::BF16, "bf16 any", 200, [] {
+            FMA_Operands_Hex_BF16 ops1 = {gen_any_bf16(), gen_any_bf16(), gen_any_bf16()};
+            FMA_Operands_Hex_BF16 ops2 = {gen_any_bf16(), gen_any_bf16(), gen_any_bf16()};
+            return TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError);
+        }},
+        {TestMode::BF16, "bf16 [-50,-10]", 200, [] { return bf16_band({{-50, -10}, {-50, -10}, {-50, -10}, {-50, -10}, {-50, -10}, {-50, -10}}); }},
+        {TestMode::BF16, "bf16 [-10,10]", 200, [] { return bf16_band({{-10, 10}, {-10, 10}, {-10, 10}, {-10, 10}, {-10, 10}, {-10, 10}}); }},
+        {TestMode::BF16, "bf16 [10,50]", 200, [] { return bf16_band({{10, 50}, {10, 50}, {10, 50}, {10, 50}, {10, 50}, {10, 50}}); }},
+        // 极端范围
+        {TestMode::BF16, "bf16 [-126,127]", 200, [] { return bf16_band({{-126, 127}, {-126, 127}, {-126, 127}, {-126, 127}, {-126, 127}, {-126, 127}}); }},
+        // 非规格化数边界: 指数[-126, -125] 的操作数
+        {TestMode::BF16, "bf16 sub a1 b2", 200, [] { return bf16_band({{-126, -125}, {-126, 20}, {-126, 20}, {-126, 20}, {-126, -125}, {-126, 20}}); }},
+        {TestMode::BF16, "bf16 sub c1 b2 c2", 200, [] { return bf16_band({{-126, 20}, {-126, 20}, {-126, -125}, {-126, 20}, {-126, -125}, {-126, -125}}); }},
+        {TestMode::BF16, "bf16 sub ab1 abc2", 200, [] { return bf16_band({{-126, -125}, {-126, -125}, {-126, 20}, {-126, -125}, {-126, -125}, {-126, -125}}); }},
+        // 全范围混合
+        {TestMode::BF16, "bf16 [-127,10]", 200, [] { return bf16_band({{-127, 10}, {-127, 10}, {-127, 10}, {-127, 10}, {-127, 10}, {-127, 10}}); }},
+        // 较高精度要求
+        {TestMode::BF16, "bf16 [-20,20]", 40, [] { return bf16_band({{-20, 20}, {-20, 20}, {-20, 20}, {-20, 20}, {-20, 20}, {-20, 20}}); }},
+        // 极端范围: 指数[-127, -126]
+        {TestMode::BF16, "bf16 [-127,-126]", 200, [] { return bf16_band({{-127, -126}, {-127, -126}, {-127, -126}, {-127, -126}, {-127, -126}, {-127, -126}}); }},
+
+        // ---- FP16 / BF16 widen ----
+        {TestMode::FP16_Widen, "fp16w any", 200, [] {
+            FMA_Operands_FP16_Widen ops = {gen_any_fp16(), gen_any_fp16(), gen_any_fp32()};
+            return TestCase(ops, ErrorType::ULP);
+        }},
+        {TestMode::FP16_Widen, "fp16w [-10,10]", 200, [] {
+            FMA_Operands_FP16_Widen ops = {gen_random_fp16(-10, 10), gen_random_fp16(-10, 10), gen_random_fp32(-20, 20)};
+            return TestCase(ops, ErrorType::ULP);
+        }},
+        {TestMode::BF16_Widen, "bf16w any", 200, [] {
+            FMA_Operands_BF16_Widen ops = {gen_any_bf16(), gen_any_bf16(), gen_any_fp32()};
+            return TestCase(ops, ErrorType::ULP);
+        }},
+    };
+    return bands;
+}
+
+// 按表中顺序生成 mode 的全部随机向量
+static void add_random_tests(std::vector<TestCase>& tests, TestMode mode) {
+    for (const RandomBand& band : random_bands()) {
+        if (band.mode != mode) continue;
+        for (int i = 0; i < band.count; ++i) {
+            tests.push_back(band.gen());
+        }
+    }
+}
 
 std::vector<TestCase> create_all_tests() {
     std::vector<TestCase> tests;
@@ -27,57 +135,7 @@ std::vector<TestCase> create_all_tests() {
         tests.push_back(TestCase(FMA_Operands_Hex{0x816849E7, 0x00B6D8A2, 0x08F0CF76}, ErrorType::ULP));
 
         printf("\n---- Random tests for FP32 ----\n");
-        int num_random_tests_32 = 200;
-        // ---- FP32 任意值随机测试 ----
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_any_fp32(), gen_any_fp32(), gen_any_fp32()};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        // ---- 进行不同指数范围的测试 ----
-        // 小数范围测试：指数[-50, -10]
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-50, -10), gen_random_fp32(-50, -10), gen_random_fp32(-50, -10)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        // 中等数值范围测试：指数[-10, 10]
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-10, 10), gen_random_fp32(-10, 10), gen_random_fp32(-10, 10)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        // 大数范围测试：指数[10, 50]
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(10, 50), gen_random_fp32(10, 50), gen_random_fp32(10, 50)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        // 更多测试
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-126, 20), gen_random_fp32(-126, 20), gen_random_fp32(-126, 20)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-126, 20), gen_random_fp32(-127, -126), gen_random_fp32(-126, 20)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-127, -126), gen_random_fp32(-126, 20), gen_random_fp32(-126, 20)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-126, 20), gen_random_fp32(-126, 20), gen_random_fp32(-127, -126)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-126, 20), gen_random_fp32(-127, -126), gen_random_fp32(-127, -126)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-127, -126), gen_random_fp32(-127, -126), gen_random_fp32(-127, -126)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
-        for (int i = 0; i < num_random_tests_32; ++i) {
-            FMA_Operands_Hex ops = {gen_random_fp32(-127, 10), gen_random_fp32(-127, 10), gen_random_fp32(-127, 10)};
-            tests.push_back(TestCase(ops, ErrorType::RelativeError));
-        }
+        add_random_tests(tests, TestMode::FP32);
     }
 
     if (test_fp16) {
@@ -102,59 +160,7 @@ std::vector<TestCase> create_all_tests() {
         tests.push_back(TestCase(FMA_Operands_Hex_16{0x668, 0x5b00, 0xa59b}, FMA_Operands_Hex_16{0x8f63, 0x575, 0xb918}, ErrorType::Precise));
 
         printf("\n---- Random tests for FP16 ----\n");
-        int num_random_tests_16 = 200;
-        ErrorType errorType_fp16 = ErrorType::ULP;
-        // ---- FP16 任意值随机测试 ----
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_any_fp16(), gen_any_fp16(), gen_any_fp16()};
-            FMA_Operands_Hex_16 ops2 = {gen_any_fp16(), gen_any_fp16(), gen_any_fp16()};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        // ---- 进行不同指数范围的FP16随机测试 ----
-        // 小数范围测试：指数[-15, -5]
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(-15, -5), gen_random_fp16(-15, -5), gen_random_fp16(-15, -5)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(-15, -5), gen_random_fp16(-15, -5), gen_random_fp16(-15, -5)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        // 中等数值范围测试：指数[-5, 5]
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(-5, 5), gen_random_fp16(-5, 5), gen_random_fp16(-5, 5)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(-5, 5), gen_random_fp16(-5, 5), gen_random_fp16(-5, 5)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        // 大数范围测试：指数[5, 15]
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(5, 15), gen_random_fp16(5, 15), gen_random_fp16(5, 15)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(5, 15), gen_random_fp16(5, 15), gen_random_fp16(5, 15)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        // 更多测试
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(-15, 15), gen_random_fp16(-15, 15), gen_random_fp16(-15, 15)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(-15, 15), gen_random_fp16(-15, 15), gen_random_fp16(-15, 15)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(-15, -14), gen_random_fp16(-15, 15), gen_random_fp16(-15, 15)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(-15, 15), gen_random_fp16(-15, -14), gen_random_fp16(-15, 15)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(-15, 15), gen_random_fp16(-15, 15), gen_random_fp16(-15, -14)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(-15, 15), gen_random_fp16(-15, -14), gen_random_fp16(-15, -14)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(-15, -14), gen_random_fp16(-15, -14), gen_random_fp16(-15, 15)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(-15, -14), gen_random_fp16(-15, -14), gen_random_fp16(-15, -14)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
-        for (int i = 0; i < num_random_tests_16; ++i) {
-            FMA_Operands_Hex_16 ops1 = {gen_random_fp16(-15, -14), gen_random_fp16(-15, -14), gen_random_fp16(-15, -14)};
-            FMA_Operands_Hex_16 ops2 = {gen_random_fp16(-15, -14), gen_random_fp16(-15, -14), gen_random_fp16(-15, -14)};
-            tests.push_back(TestCase(ops1, ops2, errorType_fp16));
-        }
+        add_random_tests(tests, TestMode::FP16);
     }
 
     if (test_bf16) {
@@ -196,76 +202,7 @@ std::vector<TestCase> create_all_tests() {
         tests.push_back(TestCase(FMA_Operands_Hex_BF16{0xbf80, 0x0200, 0x0200}, FMA_Operands_Hex_BF16{0xbf80, 0x0200, 0x0200}, ErrorType::ULP));
     
         printf("\n---- Random tests for BF16 ----\n");
-        int num_random_tests_bf16 = 200;
-        
-        // ---- BF16 任意值随机测试 ----
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_any_bf16(), gen_any_bf16(), gen_any_bf16()};
-            FMA_Operands_Hex_BF16 ops2 = {gen_any_bf16(), gen_any_bf16(), gen_any_bf16()};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        
-        // ---- 进行不同指数范围的BF16随机测试 ----
-        // 小数范围测试：指数[-50, -10]
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-50, -10), gen_random_bf16(-50, -10), gen_random_bf16(-50, -10)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-50, -10), gen_random_bf16(-50, -10), gen_random_bf16(-50, -10)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 中等数值范围测试：指数[-10, 10]
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-10, 10), gen_random_bf16(-10, 10), gen_random_bf16(-10, 10)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-10, 10), gen_random_bf16(-10, 10), gen_random_bf16(-10, 10)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 大数范围测试：指数[10, 50]
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(10, 50), gen_random_bf16(10, 50), gen_random_bf16(10, 50)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(10, 50), gen_random_bf16(10, 50), gen_random_bf16(10, 50)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 极端范围测试：指数[-126, 127]
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-126, 127), gen_random_bf16(-126, 127), gen_random_bf16(-126, 127)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-126, 127), gen_random_bf16(-126, 127), gen_random_bf16(-126, 127)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 非规格化数边界测试：指数[-126, -125]
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-126, -125), gen_random_bf16(-126, 20), gen_random_bf16(-126, 20)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-126, 20), gen_random_bf16(-126, -125), gen_random_bf16(-126, 20)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 混合精度范围测试
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-126, 20), gen_random_bf16(-126, 20), gen_random_bf16(-126, -125)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-126, 20), gen_random_bf16(-126, -125), gen_random_bf16(-126, -125)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 高精度范围测试
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-126, -125), gen_random_bf16(-126, -125), gen_random_bf16(-126, 20)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-126, -125), gen_random_bf16(-126, -125), gen_random_bf16(-126, -125)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 全范围混合测试
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-127, 10), gen_random_bf16(-127, 10), gen_random_bf16(-127, 10)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-127, 10), gen_random_bf16(-127, 10), gen_random_bf16(-127, 10)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 相对误差测试（较高精度要求）
-        for (int i = 0; i < num_random_tests_bf16 / 5; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-20, 20), gen_random_bf16(-20, 20), gen_random_bf16(-20, 20)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-20, 20), gen_random_bf16(-20, 20), gen_random_bf16(-20, 20)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
-        // 极端范围测试：指数[-127, -126]
-        for (int i = 0; i < num_random_tests_bf16; ++i) {
-            FMA_Operands_Hex_BF16 ops1 = {gen_random_bf16(-127, -126), gen_random_bf16(-127, -126), gen_random_bf16(-127, -126)};
-            FMA_Operands_Hex_BF16 ops2 = {gen_random_bf16(-127, -126), gen_random_bf16(-127, -126), gen_random_bf16(-127, -126)};
-            tests.push_back(TestCase(ops1, ops2, ErrorType::ULP_or_RelativeError));
-        }
+        add_random_tests(tests, TestMode::BF16);
     }
 
     if (test_fp16_widen) {
@@ -276,18 +213,7 @@ std::vector<TestCase> create_all_tests() {
         tests.push_back(TestCase(FMA_Operands_FP16_Widen{0x0000, 0x4000, 0x40000000}, ErrorType::Precise)); // 0.0 * 2.0 + 2.0 = 2.0
       
         printf("\n---- Random tests for FP16 Widen ----\n");
-        int num_random_tests_fp16_widen = 200;
-        // ---- FP16 widen 任意值随机测试 ----
-        for (int i = 0; i < num_random_tests_fp16_widen; ++i) {
-            FMA_Operands_FP16_Widen ops = {gen_any_fp16(), gen_any_fp16(), gen_any_fp32()};
-            tests.push_back(TestCase(ops, ErrorType::ULP));
-        }
-        // 正常范围测试
-        for (int i = 0; i < num_random_tests_fp16_widen; ++i) {
-            FMA_Operands_FP16_Widen ops = {gen_random_fp16(-10, 10), gen_random_fp16(-10, 10), gen_random_fp32(-20, 20)};
-            tests.push_back(TestCase(ops, ErrorType::ULP));
-        }
-        // 更多不同范围的随机测试...
+        add_random_tests(tests, TestMode::FP16_Widen);
     }
 
     if (test_bf16_widen) {
@@ -298,14 +224,64 @@ std::vector<TestCase> create_all_tests() {
         tests.push_back(TestCase(FMA_Operands_BF16_Widen{0x0000, 0x4000, 0x40000000}, ErrorType::Precise)); // 0.0 * 2.0 + 2.0 = 2.0
 
         printf("\n---- Random tests for BF16 Widen ----\n");
-        int num_random_tests_bf16_widen = 200;
-        // ---- BF16 widen 任意值随机测试 ----
-        for (int i = 0; i < num_random_tests_bf16_widen; ++i) {
-            FMA_Operands_BF16_Widen ops = {gen_any_bf16(), gen_any_bf16(), gen_any_fp32()};
-            tests.push_back(TestCase(ops, ErrorType::ULP));
-        }
-        // 更多不同范围的随机测试...
+        add_random_tests(tests, TestMode::BF16_Widen);
     }
 
     return tests;
-} 
\ No newline at end of file
+} 
+TestCase make_test_case(TestMode mode, const uint32_t ops[6], ErrorType error_type) {
+    auto h = [ops](int i) { return uint16_t(ops[i]); };
+    switch (mode) {
+        case TestMode::FP32:
+            return TestCase(FMA_Operands_Hex{ops[0], ops[1], ops[2]}, error_type);
+        case TestMode::FP16:
+            return TestCase(FMA_Operands_Hex_16{h(0), h(1), h(2)}, FMA_Operands_Hex_16{h(3), h(4), h(5)}, error_type);
+        case TestMode::BF16:
+            return TestCase(FMA_Operands_Hex_BF16{h(0), h(1), h(2)}, FMA_Operands_Hex_BF16{h(3), h(4), h(5)}, error_type);
+        case TestMode::FP16_Widen:
+            return TestCase(FMA_Operands_FP16_Widen{h(0), h(1), ops[2]}, error_type);
+        default:
+            return TestCase(FMA_Operands_BF16_Widen{h(0), h(1), ops[2]}, error_type);
+    }
+}
+
+bool parse_test_mode(const char* s, TestMode& mode) {
+    if (!strcmp(s, "fp32")) mode = TestMode::FP32;
+    else if (!strcmp(s, "fp16")) mode = TestMode::FP16;
+    else if (!strcmp(s, "bf16")) mode = TestMode::BF16;
+    else if (!strcmp(s, "fp16_widen")) mode = TestMode::FP16_Widen;
+    else if (!strcmp(s, "bf16_widen")) mode = TestMode::BF16_Widen;
+    else return false;
+    return true;
+}
+
+const char* test_mode_name(TestMode mode) {
+    switch (mode) {
+        case TestMode::FP32: return "fp32";
+        case TestMode::FP16: return "fp16";
+        case TestMode::BF16: return "bf16";
+        case TestMode::FP16_Widen: return "fp16_widen";
+        default: return "bf16_widen";
+    }
+}
+
+void write_test_operands(FILE* fp, const TestCase& t) {
+    const DutInputs in = t.dut_inputs();
+    if (t.mode == TestMode::FP32) {
+        fprintf(fp, "%08x %08x %08x", in.a_in_32, in.b_in_32, in.c_in_32);
+    } else if (t.is_widen) {
+        fprintf(fp, "%04x %04x %08x", in.a_in_16[1], in.b_in_16[1], in.c_in_32);
+    } else {
+        fprintf(fp, "%04x %04x %04x %04x %04x %04x", in.a_in_16[0], in.b_in_16[0], in.c_in_16[0],
+                in.a_in_16[1], in.b_in_16[1], in.c_in_16[1]);
+    }
+}
+
+bool parse_error_type(const char* s, ErrorType& error_type) {
+    if (!strcmp(s, "precise")) error_type = ErrorType::Precise;
+    else if (!strcmp(s, "ulp")) error_type = ErrorType::ULP;
+    else if (!strcmp(s, "rel")) error_type = ErrorType::RelativeError;
+    else if (!strcmp(s, "ulp_rel")) error_type = ErrorType::ULP_or_RelativeError;
+    else return false;
+    return true;
+}
@@ -0,0 +1,399 @@
+#include "include/traffic.h"
+#include "include/simulator.h"
+#include "include/vfma_model.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+// 按 TestMode 顺序的模式名 (命令行和 trace 文件中使用)
+static const char* kModeNames[5] = {"fp32", "fp16", "bf16", "fp16w", "bf16w"};
+
+static int mode_index(const string& name) {
+    for (int i = 0; i < 5; ++i) {
+        if (name == kModeNames[i]) return i;
+    }
+    return -1;
+}
+
+// "fp32:W,fp16:W,..." -> 权重; 没有列出的模式权重为0
+static bool parse_mix(const string& s, double mix[5]) {
+    for (int i = 0; i < 5; ++i) mix[i] = 0;
+    stringstream ss(s);
+    string item;
+    double total = 0;
+    while (getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        int m = mode_index(item.substr(0, colon));
+        double w = colon == string::npos ? 1.0 : atof(item.c_str() + colon + 1);
+        if (m < 0 || w < 0) {
+            printf("ERROR: bad mode mix entry '%s' (expected fp32|fp16|bf16|fp16w|bf16w[:weight])\n", item.c_str());
+            return false;
+        }
+        mix[m] = w;
+        total += w;
+    }
+    if (total <= 0) {
+        printf("ERROR: mode mix '%s' has no positive weight\n", s.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool parse_model(const string& arg, TrafficModel& m) {
+    m.name = arg;
+    string model = arg, mix;
+    size_t at = arg.find('@');
+    if (at != string::npos) {
+        model = arg.substr(0, at);
+        mix = arg.substr(at + 1);
+    }
+    if (!mix.empty() && !parse_mix(mix, m.mix)) return false;
+
+    if (model == "b2b") {
+        m.kind = TrafficKind::BackToBack;
+    } else if (!model.compare(0, 10, "bernoulli:")) {
+        m.kind = TrafficKind::Bernoulli;
+        m.issue_pct = atoi(model.c_str() + 10);
+        if (m.issue_pct < 1 || m.issue_pct > 100) {
+            printf("ERROR: bernoulli:P needs 1 <= P <= 100\n");
+            return false;
+        }
+    } else if (!model.compare(0, 7, "bursty:")) {
+        m.kind = TrafficKind::Bursty;
+        if (sscanf(model.c_str() + 7, "%lf,%lf", &m.mean_on, &m.mean_off) != 2 || m.mean_on < 1 || m.mean_off < 1) {
+            printf("ERROR: bursty:ON,OFF needs mean burst and gap lengths >= 1\n");
+            return false;
+        }
+    } else if (!model.compare(0, 6, "trace:")) {
+        m.kind = TrafficKind::Trace;
+        m.trace_path = model.substr(6);
+    } else {
+        printf("ERROR: unknown traffic model '%s' (b2b, bernoulli:P, bursty:ON,OFF, trace:PATH)\n", model.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool parse_traffic_option(const char* arg, TrafficSpec& spec, bool& ok) {
+    ok = true;
+    if (!strcmp(arg, "--traffic")) {
+        spec.models.push_back(TrafficModel{});
+        spec.models.back().name = "b2b";
+    } else if (!strncmp(arg, "--traffic=", 10)) {
+        TrafficModel m;
+        ok = parse_model(arg + 10, m);
+        spec.models.push_back(m);
+    } else if (!strncmp(arg, "--traffic-idle=", 15)) {
+        const char* p = arg + 15;
+        if (!strcmp(p, "hold")) {
+            spec.idle = IdlePolicy::Hold;
+        } else if (!strcmp(p, "next")) {
+            spec.idle = IdlePolicy::Next;
+        } else if (!strcmp(p, "random")) {
+            spec.idle = IdlePolicy::Random;
+        } else {
+            printf("ERROR: --traffic-idle must be hold, next or random\n");
+            ok = false;
+        }
+    } else if (!strncmp(arg, "--traffic-ops=", 14)) {
+        spec.ops = strtoul(arg + 14, nullptr, 0);
+    } else if (!strncmp(arg, "--traffic-record=", 17)) {
+        spec.record_path = arg + 17;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+struct TraceEntry {
+    uint64_t cycle;
+    int mode; // -1: 按 mix 选取
+};
+
+// 读取发射时间线: 每行 "<周期> [模式]", '#' 开头为注释, 周期严格递增 (以第一行为0)
+bool load_timeline(const string& path, vector<TraceEntry>& out) {
+    ifstream f(path);
+    if (!f) {
+        printf("ERROR: cannot open issue timeline %s\n", path.c_str());
+        return false;
+    }
+    string line;
+    size_t lineno = 0;
+    while (getline(f, line)) {
+        lineno++;
+        if (line.empty() || line[0] == '#') continue;
+        istringstream ls(line);
+        TraceEntry e = {0, -1};
+        string mode;
+        if (!(ls >> e.cycle)) {
+            printf("ERROR: %s:%zu: expected '<cycle> [mode]'\n", path.c_str(), lineno);
+            return false;
+        }
+        if (ls >> mode && (e.mode = mode_index(mode)) < 0) {
+            printf("ERROR: %s:%zu: unknown mode '%s'\n", path.c_str(), lineno, mode.c_str());
+            return false;
+        }
+        if (!out.empty() && e.cycle <= out.back().cycle) {
+            printf("ERROR: %s:%zu: cycles must be strictly increasing\n", path.c_str(), lineno);
+            return false;
+        }
+        out.push_back(e);
+    }
+    if (out.empty()) {
+        printf("ERROR: issue timeline %s is empty\n", path.c_str());
+        return false;
+    }
+    const uint64_t first = out.front().cycle;
+    for (TraceEntry& e : out) e.cycle -= first;
+    return true;
+}
+
+bool same_mode(const FmaMode& x, const FmaMode& y) {
+    return x.is_fp32 == y.is_fp32 && x.is_fp16 == y.is_fp16 && x.is_bf16 == y.is_bf16 && x.is_widen == y.is_widen;
+}
+
+FmaMode mode_of(const DutInputs& in) {
+    return FmaMode{in.is_fp32, in.is_fp16, in.is_bf16, in.is_widen};
+}
+
+struct InFlight {
+    size_t test;
+    uint64_t cycle;
+    bool after_bubble;
+};
+
+struct TrafficResult {
+    uint64_t cycles = 0, issued = 0, idle_cycles = 0;
+    map<uint64_t, uint64_t> latency; // 延迟 -> 操作数
+    uint64_t after_bubble = 0, after_bubble_wrong = 0;
+    uint64_t exposed_by_issue = 0, exposed_by_idle = 0, affected = 0;
+    uint64_t rtl_model_mismatch = 0, wrong = 0, spurious = 0;
+};
+
+// 按模式分组的测试用例, 每组循环取用
+class OpPicker {
+public:
+    OpPicker(const vector<TestCase>& tests, const double mix[5], unsigned seed)
+        : rng_(seed), dist_(mix, mix + 5) {
+        for (size_t i = 0; i < tests.size(); ++i) pools_[(int)tests[i].mode].push_back(i);
+        for (int m = 0; m < 5; ++m) {
+            if (mix[m] > 0 && pools_[m].empty()) {
+                printf("ERROR: mode mix asks for %s but there are no %s test cases\n", kModeNames[m], kModeNames[m]);
+                ok_ = false;
+            }
+        }
+    }
+    bool ok() const { return ok_; }
+    size_t pick(int mode) {
+        if (mode < 0 || pools_[mode].empty()) mode = dist_(rng_);
+        return pools_[mode][next_[mode]++ % pools_[mode].size()];
+    }
+
+private:
+    mt19937 rng_;
+    discrete_distribution<int> dist_;
+    vector<size_t> pools_[5];
+    size_t next_[5] = {};
+    bool ok_ = true;
+};
+
+// 一个流量模型: Vtop 和 VfmaModel 同一时钟驱动, 逐周期比较输出
+bool run_model(Simulator& sim, const vector<TestCase>& tests, const TrafficSpec& spec, const TrafficModel& tm,
+               const string& record_path, TrafficResult& r) {
+    vector<TraceEntry> timeline;
+    if (tm.kind == TrafficKind::Trace && !load_timeline(tm.trace_path, timeline)) return false;
+    const size_t ops = tm.kind == TrafficKind::Trace ? timeline.size() : spec.ops ? spec.ops : tests.size();
+
+    OpPicker picker(tests, tm.mix, rand());
+    if (!picker.ok()) return false;
+    mt19937 rng(rand());
+    bernoulli_distribution leave_on(1.0 / tm.mean_on), leave_off(1.0 / tm.mean_off);
+    bool burst_on = true;
+
+    // 超时提前返回时也要关闭 (并写出) 已记录的部分
+    unique_ptr<FILE, decltype(&fclose)> rec(record_path.empty() ? nullptr : fopen(record_path.c_str(), "w"), &fclose);
+    if (!record_path.empty() && !rec) {
+        printf("ERROR: cannot write issue timeline %s\n", record_path.c_str());
+        return false;
+    }
+    if (rec) fprintf(rec.get(), "# issue timeline recorded from --traffic=%s\n", tm.name.c_str());
+
+    VfmaModel model;
+    sim.reset(2);
+    model.reset(2);
+
+    // 下一个要发射的操作提前选好 (IdlePolicy::Next 在空闲周期给出它的模式和数据)
+    size_t pending = picker.pick(timeline.empty() ? -1 : timeline[0].mode);
+    vector<FmaMode> port_mode; // 每个周期 io 上的模式端口
+    FmaMode cur_mode = {false, false, false, false};
+    deque<InFlight> inflight;
+    bool last_idle = false;
+    const size_t max_report = 10;
+    uint64_t cyc = 0, drain = 0;
+
+    while (r.issued < ops || !inflight.empty()) {
+        // 1. 本周期是否发射
+        bool issue = false;
+        if (r.issued < ops) {
+            switch (tm.kind) {
+                case TrafficKind::BackToBack: issue = true; break;
+                case TrafficKind::Bernoulli: issue = (int)(rng() % 100) < tm.issue_pct; break;
+                case TrafficKind::Bursty:
+                    issue = burst_on;
+                    burst_on = burst_on ? !leave_on(rng) : leave_off(rng);
+                    break;
+                case TrafficKind::Trace: issue = timeline[r.issued].cycle == cyc; break;
+            }
+        } else if (++drain > 100) {
+            printf("Timeout waiting for valid_out (%zu ops in flight)\n", inflight.size());
+            return false;
+        }
+
+        if (issue) {
+            const DutInputs in = tests[pending].dut_inputs();
+            sim.drive(in);
+            model.drive(in);
+            cur_mode = mode_of(in);
+            inflight.push_back({pending, cyc, last_idle && r.issued > 0});
+            if (rec) fprintf(rec.get(), "%lu %s\n", cyc, kModeNames[(int)tests[pending].mode]);
+            r.issued++;
+            if (r.issued < ops) pending = picker.pick(timeline.empty() ? -1 : timeline[r.issued].mode);
+        } else {
+            if (spec.idle != IdlePolicy::Hold && r.issued < ops) {
+                const DutInputs in = tests[spec.idle == IdlePolicy::Next ? pending : rng() % tests.size()].dut_inputs();
+                sim.drive(in);
+                model.drive(in);
+                cur_mode = mode_of(in);
+            }
+            sim.idle();
+            model.idle();
+            r.idle_cycles += r.issued < ops;
+        }
+        last_idle = !issue;
+        port_mode.push_back(cur_mode);
+
+        // 2. 时钟沿之后比较两个单元的输出
+        sim.step();
+        model.step();
+        cyc++;
+        const bool rtl_valid = sim.valid_out();
+        if (rtl_valid != model.valid_out()) {
+            if (r.rtl_model_mismatch++ < max_report) {
+                printf("MISMATCH at cycle %lu: Vtop valid_out %d, VfmaModel valid_out %d\n", cyc, rtl_valid,
+                       model.valid_out());
+            }
+        }
+        if (!rtl_valid) continue;
+        if (inflight.empty()) {
+            if (r.spurious++ < max_report) printf("SPURIOUS valid_out at cycle %lu (nothing in flight)\n", cyc);
+            continue;
+        }
+        const InFlight op = inflight.front();
+        inflight.pop_front();
+        r.latency[cyc - op.cycle]++;
+
+        const uint32_t res = sim.sample().res_out_32;
+        if (model.valid_out() && res != model.res_out() && r.rtl_model_mismatch++ < max_report) {
+            printf("MISMATCH on op issued at cycle %lu: Vtop 0x%08x, VfmaModel 0x%08x\n", op.cycle, res,
+                   model.res_out());
+        }
+
+        // 3. S2/S3 在发射后的两个周期采样 io 模式端口: 模式变化的操作只统计, 模式不变的必须与单独运行一致
+        const DutInputs in = tests[op.test].dut_inputs();
+        const FmaMode mode = mode_of(in);
+        bool by_issue = false, by_idle = false;
+        for (uint64_t c = op.cycle + 1; c <= op.cycle + 2 && c < port_mode.size(); ++c) {
+            if (same_mode(port_mode[c], mode)) continue;
+            bool issued_then = false;
+            for (const InFlight& later : inflight) issued_then |= later.cycle == c;
+            (issued_then ? by_issue : by_idle) = true;
+        }
+        const bool exposed = by_issue || by_idle;
+        r.exposed_by_issue += by_issue;
+        r.exposed_by_idle += by_idle && !by_issue;
+        const bool differs = res != fma_ref_result(in);
+        if (op.after_bubble) r.after_bubble++;
+        if (differs && exposed) {
+            r.affected++;
+        } else if (differs) {
+            r.wrong++;
+            r.after_bubble_wrong += op.after_bubble;
+            if (r.wrong <= max_report) {
+                tests[op.test].print_details();
+                printf("WRONG result on op issued at cycle %lu%s: 0x%08x, isolated op gives 0x%08x\n", op.cycle,
+                       op.after_bubble ? " (after a bubble)" : "", res, fma_ref_result(in));
+            }
+        }
+    }
+    r.cycles = cyc;
+    return true;
+}
+
+double offered_rate(const TrafficModel& tm, const TrafficResult& r) {
+    switch (tm.kind) {
+        case TrafficKind::BackToBack: return 1.0;
+        case TrafficKind::Bernoulli: return tm.issue_pct / 100.0;
+        case TrafficKind::Bursty: return tm.mean_on / (tm.mean_on + tm.mean_off);
+        case TrafficKind::Trace: return r.issued ? (double)r.issued / (r.issued + r.idle_cycles) : 0.0;
+    }
+    return 0.0;
+}
+
+} // namespace
+
+bool run_traffic(Simulator& sim, const vector<TestCase>& tests, const TrafficSpec& spec) {
+    static const char* kIdleNames[] = {"hold", "next", "random"};
+    bool pass = true;
+    for (size_t i = 0; i < spec.models.size(); ++i) {
+        const TrafficModel& tm = spec.models[i];
+        string mix;
+        for (int m = 0; m < 5; ++m) {
+            char buf[32];
+            if (tm.mix[m] <= 0) continue;
+            snprintf(buf, sizeof(buf), "%s%s:%g", mix.empty() ? "" : ",", kModeNames[m], tm.mix[m]);
+            mix += buf;
+        }
+        printf("--- Traffic %s (mix %s, idle ports %s) ---\n", tm.name.c_str(), mix.c_str(),
+               kIdleNames[(int)spec.idle]);
+
+        string record = spec.record_path;
+        if (!record.empty() && spec.models.size() > 1) record += "." + to_string(i);
+        TrafficResult r;
+        if (!run_model(sim, tests, spec, tm, record, r)) {
+            pass = false;
+            continue;
+        }
+
+        // 发射期间 (最后一个操作发射之前) 的吞吐, 不计排空周期
+        const uint64_t issue_span = r.issued + r.idle_cycles;
+        printf("Issued %lu ops in %lu cycles (%lu with drain): %.3f ops/cycle, model offers %.3f\n", r.issued,
+               issue_span, r.cycles, issue_span ? (double)r.issued / issue_span : 0.0, offered_rate(tm, r));
+        printf("Latency:");
+        for (const auto& [lat, n] : r.latency) printf(" %lu cycles x %lu (%.1f%%)", lat, n, 100.0 * n / r.issued);
+        printf("\n");
+        printf("Bubbles: %lu idle cycles, %lu ops issued right after a bubble (%lu wrong)\n", r.idle_cycles,
+               r.after_bubble, r.after_bubble_wrong);
+        printf("Mode ports changed within 2 cycles of issue: %lu ops by a later issue, %lu only by idle ports; "
+               "%lu results differ from the isolated op\n", r.exposed_by_issue, r.exposed_by_idle, r.affected);
+        if (r.rtl_model_mismatch || r.wrong || r.spurious) {
+            printf("Traffic %s FAILED: %lu Vtop/VfmaModel mismatches, %lu wrong results with unchanged mode, "
+                   "%lu spurious valid_out\n", tm.name.c_str(), r.rtl_model_mismatch, r.wrong, r.spurious);
+            pass = false;
+        } else {
+            printf("Traffic %s PASSED\n", tm.name.c_str());
+        }
+        if (!record.empty()) printf("Issue timeline written to %s\n", record.c_str());
+    }
+    return pass;
+}
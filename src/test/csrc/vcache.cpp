@@ -0,0 +1,163 @@
+#include "include/vcache.h"
+#include "include/signature.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <sys/file.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// 一条记录: 模式 (1 字节) + 端口取值 (24 字节) 为键, 后面是 DUT 输出 (8 字节)
+const size_t kKeyBytes = 25;
+const size_t kRecordBytes = kKeyBytes + 8;
+const char kMagic[] = "VCACHE1";
+
+string make_key(const DutInputs& in) {
+    char k[kKeyBytes];
+    k[0] = (char)(in.is_fp32 | in.is_fp16 << 1 | in.is_bf16 << 2 | in.is_widen << 3);
+    memcpy(k + 1, &in.a_in_32, 4);
+    memcpy(k + 5, &in.b_in_32, 4);
+    memcpy(k + 9, &in.c_in_32, 4);
+    memcpy(k + 13, in.a_in_16, 4);
+    memcpy(k + 17, in.b_in_16, 4);
+    memcpy(k + 21, in.c_in_16, 4);
+    return string(k, kKeyBytes);
+}
+
+// top.v 的内容 (按 8 字节折叠, 最后折叠长度) 和参考模型版本
+bool rtl_key(const string& path, Signature128& sig) {
+    ifstream f(path, ios::binary);
+    if (!f) return false;
+    vector<char> buf((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+    for (size_t i = 0; i < buf.size(); i += 8) {
+        uint64_t w = 0;
+        memcpy(&w, buf.data() + i, min<size_t>(8, buf.size() - i));
+        sig.fold(w);
+    }
+    sig.fold(buf.size());
+    sig.fold(kGoldenModelVersion);
+    return true;
+}
+
+} // namespace
+
+bool parse_vcache_option(const char* arg, VcacheSpec& spec, bool& ok) {
+    ok = true;
+    if (!strncmp(arg, "--vcache=", 9)) {
+        spec.dir = arg + 9;
+    } else if (!strncmp(arg, "--vcache-rtl=", 13)) {
+        spec.rtl_path = arg + 13;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+VectorCache::~VectorCache() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool VectorCache::open(const VcacheSpec& spec) {
+    if (spec.rtl_path.empty()) {
+        printf("ERROR: --vcache needs --vcache-rtl=<generated top.v>\n");
+        return false;
+    }
+    Signature128 sig;
+    if (!rtl_key(spec.rtl_path, sig)) {
+        printf("ERROR: cannot read %s\n", spec.rtl_path.c_str());
+        return false;
+    }
+    error_code ec;
+    filesystem::create_directories(spec.dir, ec);
+    char name[64];
+    snprintf(name, sizeof(name), "/%016lx%016lx.vc", sig.h[0], sig.h[1]);
+    path_ = spec.dir + name;
+
+    // 多个进程可以同时追加同一个文件: 每条记录用一次 write() 写到 O_APPEND 的描述符 (持共享锁),
+    // 打开时读入已有记录并截掉末尾不完整的记录 (写入时被中断) 期间持排他锁
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd_ < 0 || flock(fd_, LOCK_EX) != 0) {
+        printf("ERROR: cannot open %s\n", path_.c_str());
+        return false;
+    }
+    bool ok = true;
+    if (filesystem::file_size(path_, ec) == 0) {
+        ok = write(fd_, kMagic, sizeof(kMagic)) == (ssize_t)sizeof(kMagic);
+    } else {
+        FILE* in = fopen(path_.c_str(), "rb");
+        char magic[sizeof(kMagic)] = {};
+        if (!in || fread(magic, 1, sizeof(kMagic), in) != sizeof(kMagic) || memcmp(magic, kMagic, sizeof(kMagic))) {
+            printf("ERROR: %s is not a vector cache file\n", path_.c_str());
+            if (in) fclose(in);
+            flock(fd_, LOCK_UN);
+            return false;
+        }
+        // 并发运行可能各自写入同一个向量, 按读到的记录数 (而不是不同键的个数) 计算完整部分的长度
+        size_t records = 0;
+        char rec[kRecordBytes];
+        while (fread(rec, 1, kRecordBytes, in) == kRecordBytes) {
+            DutOutputs out;
+            memcpy(&out.res_out_32, rec + kKeyBytes, 4);
+            memcpy(&out.res_out_16_0, rec + kKeyBytes + 4, 2);
+            memcpy(&out.res_out_16_1, rec + kKeyBytes + 6, 2);
+            map_[string(rec, kKeyBytes)] = out;
+            records++;
+        }
+        fclose(in);
+        ok = ftruncate(fd_, (off_t)(sizeof(kMagic) + records * kRecordBytes)) == 0;
+    }
+    flock(fd_, LOCK_UN);
+    if (!ok) {
+        printf("ERROR: cannot write %s\n", path_.c_str());
+        return false;
+    }
+    loaded_ = map_.size();
+    printf("Vector cache %s: %zu vectors recorded for this RTL\n", path_.c_str(), loaded_);
+    return true;
+}
+
+bool VectorCache::lookup(const DutInputs& in, DutOutputs& out) {
+    auto it = map_.find(make_key(in));
+    if (it == map_.end()) {
+        misses_++;
+        return false;
+    }
+    hits_++;
+    out = it->second;
+    return true;
+}
+
+void VectorCache::insert(const DutInputs& in, const DutOutputs& out) {
+    string key = make_key(in);
+    if (!map_.emplace(key, out).second) return;
+    char rec[kRecordBytes];
+    memcpy(rec, key.data(), kKeyBytes);
+    memcpy(rec + kKeyBytes, &out.res_out_32, 4);
+    memcpy(rec + kKeyBytes + 4, &out.res_out_16_0, 2);
+    memcpy(rec + kKeyBytes + 6, &out.res_out_16_1, 2);
+    if (fd_ < 0) return;
+    flock(fd_, LOCK_SH);
+    const bool ok = write(fd_, rec, kRecordBytes) == (ssize_t)kRecordBytes;
+    flock(fd_, LOCK_UN);
+    if (!ok) {
+        // 只影响之后的复用, 本次运行照常进行
+        printf("ERROR: cannot append to %s, no longer recording vectors\n", path_.c_str());
+        close(fd_);
+        fd_ = -1;
+        return;
+    }
+    added_++;
+}
+
+void VectorCache::report() const {
+    const uint64_t lookups = hits_ + misses_;
+    printf("Vector cache: %lu lookups, %lu answered from the cache (%.1f%%), %lu simulated, "
+           "%lu new records (%zu total)\n", lookups, hits_, lookups ? 100.0 * hits_ / lookups : 0.0, misses_, added_, map_.size());
+}
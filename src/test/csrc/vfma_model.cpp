@@ -0,0 +1,215 @@
+#include "include/vfma_model.h"
+#include "include/simulator.h"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+// ===================================================================
+// VfmaModel 类实现
+// ===================================================================
+
+void VfmaModel::count_cycle(FmaOccupancy& occ) const {
+    occ.cycles++;
+    occ.active += valid_S1_ || valid_S2_ || valid_S3_;
+    occ.busy[0] += valid_S1_;
+    occ.busy[1] += valid_S2_;
+    occ.busy[2] += valid_S3_;
+    occ.issue_fp32 += valid_in && mode.is_fp32;
+    occ.issue_fp16 += valid_in && mode.is_fp16 && !mode.is_widen;
+    occ.issue_bf16 += valid_in && mode.is_bf16 && !mode.is_widen;
+    occ.issue_widen += valid_in && mode.is_widen;
+}
+
+void VfmaModel::tick() {
+    if (!reset_in) count_cycle(occupancy_);
+
+    // 所有寄存器都由上升沿之前的值计算, 后级先更新
+    // S2/S3 中直接采样 io 模式端口的寄存器使用当前的 mode (与 RTL 一致)
+    if (valid_S2_) s3_ = fma_s3(s2_, mode);
+    if (valid_S1_) s2_ = fma_s2(s1_, mode);
+    if (valid_in) s1_ = fma_s1(mode, a_in, b_in, c_in);
+
+    // valid 链为带复位的 RegNext, 数据寄存器 (RegEnable) 不受复位影响
+    valid_S3_ = !reset_in && valid_S2_;
+    valid_S2_ = !reset_in && valid_S1_;
+    valid_S1_ = !reset_in && valid_in;
+    cycles_++;
+}
+
+void VfmaModel::reset(int n) {
+    reset_in = true;
+    for (int i = 0; i < n; i++) {
+        tick();
+    }
+    reset_in = false;
+}
+
+void VfmaModel::drive(const DutInputs& in) {
+    valid_in = true;
+    fma_core_inputs(in, mode, a_in, b_in, c_in);
+}
+
+DutOutputs VfmaModel::sample() const {
+    uint32_t res = res_out();
+    return DutOutputs{res, uint16_t(res), uint16_t(res >> 16)};
+}
+
+bool VfmaModel::run_op(const DutInputs& in, DutOutputs& out) {
+    drive(in);
+    tick();
+    valid_in = false;
+
+    int timeout = 100;
+    while (!valid_out() && timeout > 0) {
+        tick();
+        timeout--;
+    }
+
+    if (!valid_out()) {
+        return false;
+    }
+    out = sample();
+    return true;
+}
+
+uint64_t VfmaModel::run_stream(const StreamSource& source, const StreamSink& sink) {
+    reset(2);
+    uint64_t start = cycles_;
+    uint64_t issued = 0, retired = 0;
+    bool has_more = true;
+    int timeout = 100;
+
+    DutInputs in;
+    while (has_more || retired < issued) {
+        if (has_more && source(in)) {
+            drive(in);
+            issued++;
+        } else {
+            // 与 Simulator::run_stream 相同: 只拉低valid_in, 保持模式信号不变
+            has_more = false;
+            valid_in = false;
+        }
+        tick();
+
+        if (valid_out()) {
+            sink(sample());
+            retired++;
+        } else if (!has_more && --timeout == 0) {
+            printf("Timeout waiting for valid_out (%lu of %lu retired)\n", retired, issued);
+            break;
+        }
+    }
+    return cycles_ - start;
+}
+
+// ===================================================================
+// 等价性检查
+// ===================================================================
+
+namespace {
+
+// 结果和它出现的周期 (相对 run_stream 开始)
+struct TimedResult {
+    uint64_t cycle;
+    uint32_t res;
+};
+
+template <class Unit>
+vector<TimedResult> record_stream(Unit& unit, const vector<TestCase>& tests, double& secs) {
+    vector<TimedResult> results;
+    results.reserve(tests.size());
+    size_t next = 0;
+    uint64_t start = unit.cycles();
+    auto t0 = chrono::steady_clock::now();
+    unit.run_stream(
+        [&](DutInputs& in) {
+            if (next == tests.size()) return false;
+            in = tests[next++].dut_inputs();
+            return true;
+        },
+        [&](const DutOutputs& out) { results.push_back({unit.cycles() - start, out.res_out_32}); });
+    secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return results;
+}
+
+void print_speed(const char* name, size_t ops, double secs) {
+    printf("  %-12s %zu ops in %.3f s (%.0f ops/s)\n", name, ops, secs, secs > 0 ? ops / secs : 0.0);
+}
+
+} // namespace
+
+bool run_equiv(Simulator& sim, const vector<TestCase>& tests) {
+    VfmaModel model;
+    size_t mismatches = 0;
+    const size_t max_report = 10;
+
+    // 1. 逐个发射: 复位后单个操作, 比较结果和 valid_out 的延迟
+    printf("--- Equivalence: %zu isolated ops ---\n", tests.size());
+    for (size_t i = 0; i < tests.size(); ++i) {
+        const DutInputs in = tests[i].dut_inputs();
+        DutOutputs rtl = {}, ref = {};
+        sim.reset(2);
+        model.reset(2);
+        uint64_t rtl_start = sim.cycles(), ref_start = model.cycles();
+        bool rtl_ok = sim.run_op(in, rtl);
+        bool ref_ok = model.run_op(in, ref);
+        uint64_t rtl_lat = sim.cycles() - rtl_start, ref_lat = model.cycles() - ref_start;
+        if (rtl_ok != ref_ok || rtl_lat != ref_lat || rtl.res_out_32 != ref.res_out_32) {
+            if (mismatches++ < max_report) {
+                tests[i].print_details();
+                printf("MISMATCH on test case %zu: Vtop %s latency %lu res 0x%08x, "
+                       "VfmaModel %s latency %lu res 0x%08x\n", i + 1,
+                       rtl_ok ? "ok" : "timeout", rtl_lat, rtl.res_out_32,
+                       ref_ok ? "ok" : "timeout", ref_lat, ref.res_out_32);
+            }
+        }
+    }
+
+    // 2. 背靠背流: 模式逐周期变化, 比较每个结果的值和出现周期
+    printf("--- Equivalence: %zu back-to-back ops ---\n", tests.size());
+    double rtl_secs, ref_secs;
+    FmaOccupancy rtl_occ0, rtl_occ1, ref_occ0, ref_occ1;
+    bool has_perf = sim.occupancy(rtl_occ0);
+    vector<TimedResult> rtl = record_stream(sim, tests, rtl_secs);
+    sim.occupancy(rtl_occ1);
+    model.occupancy(ref_occ0);
+    vector<TimedResult> ref = record_stream(model, tests, ref_secs);
+    model.occupancy(ref_occ1);
+    if (rtl.size() != ref.size()) {
+        printf("MISMATCH: Vtop retired %zu ops, VfmaModel retired %zu\n", rtl.size(), ref.size());
+        mismatches++;
+    }
+    for (size_t i = 0; i < rtl.size() && i < ref.size(); ++i) {
+        if (rtl[i].cycle != ref[i].cycle || rtl[i].res != ref[i].res) {
+            if (mismatches++ < max_report) {
+                printf("MISMATCH on stream op %zu: Vtop cycle %lu res 0x%08x, "
+                       "VfmaModel cycle %lu res 0x%08x\n", i + 1, rtl[i].cycle, rtl[i].res,
+                       ref[i].cycle, ref[i].res);
+            }
+        }
+    }
+
+    // perf 计数器 (probes=1 时): RTL 计数与模型计数一致
+    if (has_perf && !(rtl_occ1 - rtl_occ0 == ref_occ1 - ref_occ0)) {
+        printf("MISMATCH: occupancy counters of the stream differ\n");
+        report_occupancy("Vtop", rtl_occ1 - rtl_occ0);
+        report_occupancy("VfmaModel", ref_occ1 - ref_occ0);
+        mismatches++;
+    }
+
+    printf("Simulation speed (back-to-back stream):\n");
+    print_speed("Vtop", rtl.size(), rtl_secs);
+    print_speed("VfmaModel", ref.size(), ref_secs);
+    if (rtl_secs > 0 && ref_secs > 0) {
+        printf("  VfmaModel speedup: %.1fx\n", rtl_secs / ref_secs);
+    }
+
+    if (mismatches) {
+        printf("Equivalence FAILED: %zu mismatches\n", mismatches);
+        return false;
+    }
+    printf("Equivalence PASSED: VfmaModel matches Vtop bit- and cycle-exactly\n");
+    return true;
+}
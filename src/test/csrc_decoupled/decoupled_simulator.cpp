@@ -0,0 +1,121 @@
+#include "include/decoupled_simulator.h"
+#include "fma_stages.h"
+#include <verilated.h>
+#include "VtopDecoupled.h"
+
+#include <cstdio>
+#include <random>
+
+using namespace std;
+
+DecoupledSimulator::DecoupledSimulator(int argc, char* argv[]) {
+    contextp_ = make_unique<VerilatedContext>();
+    contextp_->commandArgs(argc, argv);
+    top_ = make_unique<VtopDecoupled>(contextp_.get());
+}
+
+DecoupledSimulator::~DecoupledSimulator() {
+    top_->final();
+}
+
+void DecoupledSimulator::reset(int n) {
+    top_->io_in_valid = 0;
+    top_->io_out_ready = 0;
+    top_->io_flush = 0;
+    top_->reset = 1;
+    for (int i = 0; i < n; i++) {
+        top_->clock = 0;
+        top_->eval();
+        contextp_->timeInc(1);
+        top_->clock = 1;
+        top_->eval();
+        contextp_->timeInc(1);
+        cycles_++;
+    }
+    top_->reset = 0;
+    top_->eval();
+}
+
+void DecoupledSimulator::drive(const DutInputs& in) {
+    FmaMode mode;
+    uint32_t a, b, c;
+    fma_core_inputs(in, mode, a, b, c);
+    top_->io_in_valid = 1;
+    top_->io_in_bits_is_fp32 = mode.is_fp32;
+    top_->io_in_bits_is_fp16 = mode.is_fp16;
+    top_->io_in_bits_is_bf16 = mode.is_bf16;
+    top_->io_in_bits_is_widen = mode.is_widen;
+    top_->io_in_bits_a_in = a;
+    top_->io_in_bits_b_in = b;
+    top_->io_in_bits_c_in = c;
+}
+
+bool DecoupledSimulator::run(const vector<DutInputs>& inputs, int stall_pct, unsigned seed, vector<uint32_t>& results,
+                             DecoupledStats& stats, size_t flush_after) {
+    mt19937 rng(seed);
+    stats = DecoupledStats();
+    reset(2);
+    const uint64_t start = cycles_;
+    size_t next = 0;
+    bool flush_pending = false, flushed = false;
+    uint64_t last_progress = cycles_;
+
+    // 100 个周期既没有握手也没有待取的结果时结束: 正常情况下此时已发射完且全部排空,
+    // 否则是死锁 (in_ready 一直为低)
+    while (cycles_ - last_progress < 100) {
+        // 1. 时钟低电平: 设置本周期的输入, 求值得到组合的 in_ready / out_valid
+        top_->clock = 0;
+        if (next < inputs.size()) {
+            drive(inputs[next]);
+        } else {
+            top_->io_in_valid = 0;
+        }
+        top_->io_out_ready = (int)(rng() % 100) >= stall_pct;
+        top_->io_flush = flush_pending;
+        top_->eval();
+        contextp_->timeInc(1);
+
+        // 2. 本周期的握手 (flush 周期不发射; 输出寄存器中的结果仍可以在这个周期取走)
+        if (top_->io_in_valid && top_->io_in_ready) {
+            next++;
+            last_progress = cycles_;
+            if (flush_after && !flushed && next == flush_after) flush_pending = true;
+        } else if (top_->io_in_valid) {
+            stats.in_blocked++;
+        }
+        if (top_->io_out_valid && top_->io_out_ready) {
+            results.push_back(top_->io_out_bits);
+            last_progress = cycles_;
+        } else if (top_->io_out_valid) {
+            stats.out_stalled++;
+            last_progress = cycles_;
+        }
+        if (top_->io_flush) {
+            stats.issued_before_flush = next;
+            stats.received_before_flush = results.size();
+            flush_pending = false;
+            flushed = true;
+        }
+
+        // 3. 上升沿
+        top_->clock = 1;
+        top_->eval();
+        contextp_->timeInc(1);
+        cycles_++;
+    }
+    top_->io_in_valid = 0;
+
+    // 最后一个结果取走的周期为止
+    stats.cycles = last_progress + 1 - start;
+    stats.issued = next;
+    stats.received = results.size();
+    if (!flushed) {
+        stats.issued_before_flush = stats.issued;
+        stats.received_before_flush = stats.received;
+    }
+    if (next < inputs.size()) {
+        printf("Timeout: %zu of %zu ops issued\n", next, inputs.size());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef __DECOUPLED_SIMULATOR_H__
+#define __DECOUPLED_SIMULATOR_H__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "test_case.h"
+
+// 前向声明Verilator相关类
+class VtopDecoupled;
+class VerilatedContext;
+
+// 一次运行的统计
+struct DecoupledStats {
+    uint64_t cycles = 0;
+    uint64_t issued = 0, received = 0;
+    uint64_t in_blocked = 0;   // in_valid 为高但 in_ready 为低的周期
+    uint64_t out_stalled = 0;  // out_valid 为高但 out_ready 为低的周期
+    // flush 之前已发射 / 已收到的操作数 (没有 flush 时等于 issued / received)
+    uint64_t issued_before_flush = 0, received_before_flush = 0;
+};
+
+// ===================================================================
+// DecoupledSimulator 类: 驱动 topDecoupled (VFMA_16_32_Decoupled)
+//   输入端每周期都有下一个操作 (in_valid 一直为高, 直到发射完),
+//   输出端每周期以 stall_pct% 的概率拉低 out_ready; 结果按到达顺序收集
+// ===================================================================
+class DecoupledSimulator {
+public:
+    DecoupledSimulator(int argc, char* argv[]);
+    ~DecoupledSimulator();
+
+    void reset(int n);
+    // flush_after > 0: 发射完第 flush_after 个操作后的下一个周期拉高一拍 flush
+    // 结果超时 (最后一次握手后 100 个周期没有进展) 返回false
+    bool run(const std::vector<DutInputs>& inputs, int stall_pct, unsigned seed, std::vector<uint32_t>& results,
+             DecoupledStats& stats, size_t flush_after = 0);
+    uint64_t cycles() const { return cycles_; }
+
+private:
+    void drive(const DutInputs& in);
+
+    std::unique_ptr<VerilatedContext> contextp_;
+    std::unique_ptr<VtopDecoupled> top_;
+    uint64_t cycles_ = 0;
+};
+
+#endif // __DECOUPLED_SIMULATOR_H__
@@ -0,0 +1,107 @@
+#include "include/decoupled_simulator.h"
+#include "fma_stages.h"
+#include "test_factory.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+// 单个操作 (模式不变) 的逐位参考结果; VFMA_16_32_Decoupled 在模式变化时等待 S1/S2 排空,
+// 因此每个操作的结果都与单独运行时一致
+static uint32_t reference_result(const DutInputs& in) {
+  FmaMode mode;
+  uint32_t a, b, c;
+  fma_core_inputs(in, mode, a, b, c);
+  return fma_res_out(fma_s3(fma_s2(fma_s1(mode, a, b, c), mode), mode));
+}
+
+// 按顺序比较收到的结果和期望序列 expected[first, last), 打印前几个错位; 返回不一致的个数
+static size_t compare_results(const std::vector<uint32_t>& got, size_t got_from, size_t got_to,
+                              const std::vector<uint32_t>& expected, size_t first, size_t last) {
+  size_t bad = 0;
+  if (got_to - got_from != last - first) {
+    printf("  received %zu results, expected %zu (dropped or duplicated results)\n", got_to - got_from,
+           last - first);
+    bad++;
+  }
+  for (size_t i = 0; got_from + i < got_to && first + i < last; i++) {
+    if (got[got_from + i] != expected[first + i] && bad++ < 5) {
+      printf("  result %zu: DUT 0x%08x, expected 0x%08x (op %zu)\n", got_from + i, got[got_from + i],
+             expected[first + i], first + i);
+    }
+  }
+  return bad;
+}
+
+int main(int argc, char *argv[]) {
+  // 0. 解析命令行选项
+  std::vector<int> stall_rates = {0, 10, 25, 50, 75, 90};
+  for (int i = 1; i < argc; ++i) {
+    if (!strncmp(argv[i], "--stall=", 8)) {
+      int p = atoi(argv[i] + 8);
+      if (p < 0 || p > 99) {
+        printf("ERROR: --stall=P needs 0 <= P <= 99\n");
+        return 2;
+      }
+      stall_rates = {p};
+    }
+  }
+
+  // 1. 初始化随机数生成器种子
+  srand(time(NULL));
+
+  // 2. 初始化仿真器
+  DecoupledSimulator sim(argc, argv);
+
+  // 3. 使用 TestFactory 创建所有测试用例, 计算逐位的期望结果
+  printf("--- Creating all test cases ---\n");
+  std::vector<TestCase> tests = create_all_tests();
+  printf("--- All test cases created ---\n\n");
+  std::vector<DutInputs> inputs;
+  std::vector<uint32_t> expected;
+  for (const TestCase& t : tests) {
+    inputs.push_back(t.dut_inputs());
+    expected.push_back(reference_result(inputs.back()));
+  }
+
+  // 4. 不同的输出阻塞率: 输入端一直有数据, 检查结果不丢失、不重复、顺序正确, 测量持续吞吐
+  size_t total_bad = 0;
+  printf("topDecoupled: %zu ops per run, out_ready deasserted at random\n", inputs.size());
+  printf("%7s %9s %10s %9s %11s %11s %10s\n", "stall%", "cycles", "ops/cycle", "ideal", "in blocked",
+         "out stalled", "mismatches");
+  for (int p : stall_rates) {
+    std::vector<uint32_t> results;
+    DecoupledStats st;
+    if (!sim.run(inputs, p, rand(), results, st)) return 1;
+    size_t bad = compare_results(results, 0, results.size(), expected, 0, expected.size());
+    total_bad += bad;
+    printf("%6d%% %9lu %10.3f %9.3f %10.1f%% %10.1f%% %10zu\n", p, st.cycles, (double)st.received / st.cycles,
+           (100 - p) / 100.0, 100.0 * st.in_blocked / st.cycles, 100.0 * st.out_stalled / st.cycles, bad);
+  }
+
+  // 5. 运行中途 flush: flush 之前取走的结果是前缀, 之后只出现 flush 之后发射的操作
+  {
+    std::vector<uint32_t> results;
+    DecoupledStats st;
+    const size_t flush_after = inputs.size() / 2;
+    if (!sim.run(inputs, 25, rand(), results, st, flush_after)) return 1;
+    printf("Flush after op %lu: %lu results taken before, %lu dropped, %zu after\n", st.issued_before_flush,
+           st.received_before_flush, st.issued_before_flush - st.received_before_flush,
+           results.size() - st.received_before_flush);
+    size_t bad = compare_results(results, 0, st.received_before_flush, expected, 0, st.received_before_flush) +
+                 compare_results(results, st.received_before_flush, results.size(), expected,
+                                 st.issued_before_flush, expected.size());
+    total_bad += bad;
+  }
+
+  printf("\n=================================\n");
+  if (total_bad) {
+    printf("      TEST FAILED! (%zu mismatches)\n", total_bad);
+    printf("=================================\n");
+    return 1;
+  }
+  printf("      ALL TESTS PASSED!\n");
+  printf("=================================\n");
+  return 0;
+}
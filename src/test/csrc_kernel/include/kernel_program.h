@@ -0,0 +1,40 @@
+#ifndef __KERNEL_PROGRAM_H__
+#define __KERNEL_PROGRAM_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kernel_simulator.h"
+
+// ===================================================================
+// 内核: vfmacc 循环 + 累加器折叠 + vfredusum
+//   dot:   f[0] = sum(a[i] * b[i])
+//   sumsq: f[0] = sum(a[i] * a[i])   (范数的平方)
+// ===================================================================
+enum class KernelKind { DOT, SUMSQ };
+
+struct KernelSpec {
+    KernelKind kind = KernelKind::DOT;
+    int n = 1024;     // 元素个数, kVlenWords 的倍数
+    int acc = 1;      // 累加器个数 (循环展开), 1..8, 2 的幂
+    int iters = 100;  // 内核调用次数
+};
+
+// 一次内核调用的输入数据 (fp32 位模式)
+struct KernelData {
+    std::vector<uint32_t> a, b;
+};
+
+// 解析 --kernel=dot|sumsq --n=N --acc=U --iters=I, 出错时打印原因并返回false
+bool parse_kernel_option(const char* arg, KernelSpec& spec, bool& ok);
+bool check_kernel_spec(const KernelSpec& spec);
+const char* kernel_name(KernelKind kind);
+
+KernelData make_kernel_data(const KernelSpec& spec);
+// 追加一次内核调用的 uop 到 prog; 结果写入 f[fd]
+void append_kernel(const KernelSpec& spec, const KernelData& data, int fd, std::vector<KernelUop>& prog);
+// fp64 参考结果
+double kernel_reference(const KernelSpec& spec, const KernelData& data);
+
+#endif // __KERNEL_PROGRAM_H__
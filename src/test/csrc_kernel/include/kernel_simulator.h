@@ -0,0 +1,103 @@
+#ifndef __KERNEL_SIMULATOR_H__
+#define __KERNEL_SIMULATOR_H__
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// 前向声明Verilator相关类
+class VtopKernel;
+class VerilatedContext;
+
+// ===================================================================
+// 与 VParameters.scala (VParams) 和 vred.scala (Vreduction.Params) 保持一致
+// ===================================================================
+constexpr int kVlen = 1024;          // VParams.VLEN
+constexpr int kRedVlen = 512;        // Vreduction.Params.VLEN
+constexpr int kIssueDelay = 1;       // VParams.issueDelay (读寄存器堆)
+constexpr int kWbDelay = 0;          // VParams.wbDelay
+constexpr int kDelayBias = kIssueDelay + kWbDelay;
+constexpr int log2i(int x) { return x <= 1 ? 0 : 1 + log2i(x / 2); }
+constexpr int kFmaDelay = 3 + kDelayBias;                           // VParams.fmaDelay
+constexpr int kFredFp32Delay = log2i(kVlen / 32) + 1 + kDelayBias;  // VParams.fredFp32Delay
+
+constexpr int kVlenWords = kVlen / 32;
+constexpr int kRedWords = kRedVlen / 32;
+// 一个 VLEN 的向量寄存器交给归约单元需要的 uop 数 (对归约单元相当于 LMUL>1)
+constexpr int kRedUops = kVlenWords / kRedWords;
+static_assert(kRedUops == 1 || kRedUops == 2 || kRedUops == 4 || kRedUops == 8,
+              "VLEN / reduction VLEN must be 1, 2, 4 or 8");
+
+using VReg = std::array<uint32_t, kVlenWords>;
+
+// ===================================================================
+// 内核程序中的 uop (SEW = 32, LMUL = 1)
+//   VLE:       vd <- mem[0 .. kVlenWords), 理想访存, 不占用周期
+//   VFMUL_VV:  vd = vs2 * vs1
+//   VFMACC_VV: vd = vs2 * vs1 + vd
+//   VFMACC_VF: vd = vs2 * f(rs1) + vd
+//   VFREDUSUM: f[vd] = sum(vs2) + f(rs1)
+// ===================================================================
+enum class KernelOp { VLE, VFMUL_VV, VFMACC_VV, VFMACC_VF, VFREDUSUM };
+
+struct KernelUop {
+    KernelOp op;
+    int vd, vs1, vs2;
+    uint32_t rs1;              // 标量操作数 (fp32 位模式)
+    const uint32_t* mem;       // VLE 的数据
+};
+
+// 每周期的归类: 发射了uop, 或队首 uop 在等 FMA/归约 的结果, 或程序已发射完等待排空
+struct KernelStats {
+    uint64_t cycles = 0;
+    uint64_t issue_cycles = 0;
+    uint64_t stall_fma = 0;
+    uint64_t stall_red = 0;
+    uint64_t fma_uops = 0, red_insts = 0;
+    uint64_t fma_latency_sum = 0, red_latency_sum = 0; // 发射到写回
+};
+
+// ===================================================================
+// KernelSimulator 类: 驱动 topKernel (NLanes 个 VFMAWrapper + Vfreduction)
+//   按程序顺序发射 uop, 用模型化的寄存器堆在 FMA 和归约单元之间传递数据:
+//   结果在 valid_out/finish 时写回, kIssueDelay 个周期后才能被后续 uop 读出
+// ===================================================================
+class KernelSimulator {
+public:
+    KernelSimulator(int argc, char* argv[]);
+    ~KernelSimulator();
+
+    void reset(int n);
+    // 执行程序直到所有结果写回, 统计累加到 stats, 超时返回false
+    bool run(const std::vector<KernelUop>& prog, KernelStats& stats);
+
+    VReg& vreg(int i) { return vrf_[i]; }
+    uint32_t freg(int i) const { return frf_[i]; }
+
+private:
+    struct Pending {
+        int vd;
+        uint64_t issue_cycle;
+    };
+
+    void single_cycle();
+    void issue_fma(const KernelUop& u);
+    void issue_red(const KernelUop& u, int index);
+    // uop 的源/目的寄存器是否可读; 不可读时 by_red 表示在等归约结果
+    bool operands_ready(const KernelUop& u, bool& by_red) const;
+
+    std::unique_ptr<VerilatedContext> contextp_;
+    std::unique_ptr<VtopKernel> top_;
+    uint64_t cycles_ = 0;
+
+    std::array<VReg, 32> vrf_ = {};
+    std::array<uint32_t, 32> frf_ = {};
+    // 寄存器可读的周期, UINT64_MAX 表示结果还未写回
+    std::array<uint64_t, 32> vready_ = {};
+    std::array<uint64_t, 32> fready_ = {};
+    std::deque<Pending> fma_q_, red_q_;
+};
+
+#endif // __KERNEL_SIMULATOR_H__
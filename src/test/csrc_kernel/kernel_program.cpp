@@ -0,0 +1,113 @@
+#include "include/kernel_program.h"
+#include "fp_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// 寄存器分配: v0..v7 累加器, v8..v23 每个累加器一对 a/b 暂存寄存器
+static const int kAccBase = 0;
+static const int kStageBase = 8;
+static const uint32_t kFp32One = 0x3f800000;
+
+static float as_float(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+bool parse_kernel_option(const char* arg, KernelSpec& spec, bool& ok) {
+    auto value = [arg](const char* key) -> const char* {
+        size_t n = strlen(key);
+        return strncmp(arg, key, n) == 0 ? arg + n : nullptr;
+    };
+    const char* v;
+    ok = true;
+    if ((v = value("--kernel="))) {
+        if (!strcmp(v, "dot")) {
+            spec.kind = KernelKind::DOT;
+        } else if (!strcmp(v, "sumsq")) {
+            spec.kind = KernelKind::SUMSQ;
+        } else {
+            ok = false;
+        }
+    } else if ((v = value("--n="))) {
+        spec.n = atoi(v);
+    } else if ((v = value("--acc="))) {
+        spec.acc = atoi(v);
+    } else if ((v = value("--iters="))) {
+        spec.iters = atoi(v);
+    } else {
+        return false;
+    }
+    if (!ok) {
+        printf("ERROR: bad option %s\n", arg);
+    }
+    return true;
+}
+
+bool check_kernel_spec(const KernelSpec& spec) {
+    if (spec.n <= 0 || spec.n % kVlenWords) {
+        printf("ERROR: --n must be a positive multiple of %d\n", kVlenWords);
+        return false;
+    }
+    if (spec.acc < 1 || spec.acc > 8 || (spec.acc & (spec.acc - 1))) {
+        printf("ERROR: --acc must be 1, 2, 4 or 8\n");
+        return false;
+    }
+    if (spec.iters < 1) {
+        printf("ERROR: --iters must be at least 1\n");
+        return false;
+    }
+    return true;
+}
+
+const char* kernel_name(KernelKind kind) {
+    return kind == KernelKind::DOT ? "dot" : "sumsq";
+}
+
+KernelData make_kernel_data(const KernelSpec& spec) {
+    KernelData d;
+    d.a.resize(spec.n);
+    for (uint32_t& x : d.a) x = gen_random_fp32(-4, 4);
+    if (spec.kind == KernelKind::DOT) {
+        d.b.resize(spec.n);
+        for (uint32_t& x : d.b) x = gen_random_fp32(-4, 4);
+    }
+    return d;
+}
+
+void append_kernel(const KernelSpec& spec, const KernelData& data, int fd, vector<KernelUop>& prog) {
+    const int chunks = spec.n / kVlenWords;
+    const int acc = spec.acc < chunks ? spec.acc : chunks;
+    const vector<uint32_t>& b = spec.kind == KernelKind::DOT ? data.b : data.a;
+
+    // 1. 每个分块: 载入 a/b, 第一次写累加器用 vfmul, 之后 vfmacc
+    for (int k = 0; k < chunks; k++) {
+        int va = kStageBase + 2 * (k % acc), vb = va + 1, vacc = kAccBase + k % acc;
+        prog.push_back({KernelOp::VLE, va, 0, 0, 0, &data.a[k * kVlenWords]});
+        prog.push_back({KernelOp::VLE, vb, 0, 0, 0, &b[k * kVlenWords]});
+        prog.push_back({k < acc ? KernelOp::VFMUL_VV : KernelOp::VFMACC_VV, vacc, vb, va, 0, nullptr});
+    }
+
+    // 2. 累加器两两折叠: acc[j] = acc[j+s] * 1.0 + acc[j]
+    for (int s = 1; s < acc; s *= 2) {
+        for (int j = 0; j + s < acc; j += 2 * s) {
+            prog.push_back({KernelOp::VFMACC_VF, kAccBase + j, 0, kAccBase + j + s, kFp32One, nullptr});
+        }
+    }
+
+    // 3. 归约到标量, 初值 0.0
+    prog.push_back({KernelOp::VFREDUSUM, fd, 0, kAccBase, 0, nullptr});
+}
+
+double kernel_reference(const KernelSpec& spec, const KernelData& data) {
+    const vector<uint32_t>& b = spec.kind == KernelKind::DOT ? data.b : data.a;
+    double sum = 0.0;
+    for (int i = 0; i < spec.n; i++) {
+        sum += (double)as_float(data.a[i]) * (double)as_float(b[i]);
+    }
+    return sum;
+}
@@ -0,0 +1,203 @@
+#include "include/kernel_simulator.h"
+#include <verilated.h>
+#include "VtopKernel.h"
+
+#include <cstdio>
+
+using namespace std;
+
+static_assert(sizeof(VtopKernel::io_fma_vs1) == kVlen / 8, "kVlen does not match the generated topKernel");
+static_assert(sizeof(VtopKernel::io_red_vs2) == kRedVlen / 8, "kRedVlen does not match the generated topKernel");
+
+// VFMAWrapper 的译码输入 (RVV funct6/funct3)
+static const uint8_t kFunct6Vfmul = 0x24;   // 100100
+static const uint8_t kFunct6Vfmacc = 0x2c;  // 101100
+static const uint8_t kFunct3Opfvv = 0x1;
+static const uint8_t kFunct3Opfvf = 0x5;
+static const uint8_t kSewOhFp32 = 0x4;      // SewFpOH: bf16, fp16, fp32, fp64
+static const uint8_t kFpFormatFp32 = 0x2;
+
+KernelSimulator::KernelSimulator(int argc, char* argv[]) {
+    contextp_ = make_unique<VerilatedContext>();
+    contextp_->commandArgs(argc, argv);
+    top_ = make_unique<VtopKernel>(contextp_.get());
+
+    // 模式信号在整个仿真中保持不变 (FMA/归约内部部分寄存器在发射之后才采样控制信号)
+    top_->io_fma_sew_oh = kSewOhFp32;
+    top_->io_red_is_vfredsum = 1;
+    top_->io_red_vlmul = log2i(kRedUops);
+    top_->io_red_round_mode = 0;  // RNE
+    top_->io_red_fp_format = kFpFormatFp32;
+    top_->io_red_is_vec = 1;
+    for (int w = 0; w < kRedWords; w++) {
+        top_->io_red_mask[w] = 0xffffffff;
+    }
+}
+
+KernelSimulator::~KernelSimulator() {
+    top_->final();
+}
+
+void KernelSimulator::single_cycle() {
+    top_->clock = 0;
+    top_->eval();
+    contextp_->timeInc(1);
+
+    top_->clock = 1;
+    top_->eval();
+    contextp_->timeInc(1);
+    cycles_++;
+}
+
+void KernelSimulator::reset(int n) {
+    top_->io_fma_valid_in = 0;
+    top_->io_red_fire = 0;
+    top_->reset = 1;
+    for (int i = 0; i < n; i++) {
+        single_cycle();
+    }
+    top_->reset = 0;
+    top_->eval();
+    fma_q_.clear();
+    red_q_.clear();
+    vready_.fill(0);
+    fready_.fill(0);
+}
+
+bool KernelSimulator::operands_ready(const KernelUop& u, bool& by_red) const {
+    by_red = false;
+    switch (u.op) {
+    case KernelOp::VLE:
+        return vready_[u.vd] <= cycles_;
+    case KernelOp::VFMUL_VV:
+        return vready_[u.vs1] <= cycles_ && vready_[u.vs2] <= cycles_ && vready_[u.vd] <= cycles_;
+    case KernelOp::VFMACC_VV:
+        return vready_[u.vs1] <= cycles_ && vready_[u.vs2] <= cycles_ && vready_[u.vd] <= cycles_;
+    case KernelOp::VFMACC_VF:
+        return vready_[u.vs2] <= cycles_ && vready_[u.vd] <= cycles_;
+    case KernelOp::VFREDUSUM:
+        if (fready_[u.vd] > cycles_) {
+            by_red = true;
+            return false;
+        }
+        return vready_[u.vs2] <= cycles_;
+    }
+    return false;
+}
+
+void KernelSimulator::issue_fma(const KernelUop& u) {
+    const VReg& vs1 = vrf_[u.vs1];
+    const VReg& vs2 = vrf_[u.vs2];
+    const VReg& vs3 = vrf_[u.vd];
+    top_->io_fma_valid_in = 1;
+    top_->io_fma_funct6 = u.op == KernelOp::VFMUL_VV ? kFunct6Vfmul : kFunct6Vfmacc;
+    top_->io_fma_funct3 = u.op == KernelOp::VFMACC_VF ? kFunct3Opfvf : kFunct3Opfvv;
+    top_->io_fma_widen = 0;
+    top_->io_fma_vd_val = u.op != KernelOp::VFMUL_VV;
+    top_->io_fma_uop_idx = 0;
+    top_->io_fma_rs1 = u.rs1;
+    for (int w = 0; w < kVlenWords; w++) {
+        top_->io_fma_vs1[w] = vs1[w];
+        top_->io_fma_vs2[w] = vs2[w];
+        top_->io_fma_vs3[w] = vs3[w];
+    }
+    fma_q_.push_back({u.vd, cycles_});
+    vready_[u.vd] = UINT64_MAX;
+}
+
+void KernelSimulator::issue_red(const KernelUop& u, int index) {
+    const VReg& vs2 = vrf_[u.vs2];
+    top_->io_red_fire = 1;
+    top_->io_red_index = index;
+    top_->io_red_vs1 = u.rs1;
+    for (int w = 0; w < kRedWords; w++) {
+        top_->io_red_vs2[w] = vs2[index * kRedWords + w];
+    }
+    if (index == 0) {
+        red_q_.push_back({u.vd, cycles_});
+        fready_[u.vd] = UINT64_MAX;
+    }
+}
+
+bool KernelSimulator::run(const vector<KernelUop>& prog, KernelStats& stats) {
+    uint64_t start = cycles_;
+    size_t pc = 0;
+    int red_index = 0;  // 正在发射的归约指令的下一个 uop, 0 表示没有
+    int timeout = 1000;
+
+    while (pc < prog.size() || !fma_q_.empty() || !red_q_.empty()) {
+        top_->io_fma_valid_in = 0;
+        top_->io_red_fire = 0;
+
+        // 1. 按序发射, 每周期最多一个 uop; VLE 不占用周期
+        while (pc < prog.size() && prog[pc].op == KernelOp::VLE && vready_[prog[pc].vd] <= cycles_) {
+            VReg& vd = vrf_[prog[pc].vd];
+            for (int w = 0; w < kVlenWords; w++) vd[w] = prog[pc].mem[w];
+            pc++;
+        }
+        bool by_red = false;
+        if (red_index) {
+            // 一条归约指令拆成 kRedUops 个 uop, 连续发射
+            issue_red(prog[pc], red_index);
+            if (++red_index == kRedUops) {
+                red_index = 0;
+                pc++;
+            }
+            stats.issue_cycles++;
+        } else if (pc < prog.size() && operands_ready(prog[pc], by_red)) {
+            const KernelUop& u = prog[pc];
+            if (u.op == KernelOp::VFREDUSUM) {
+                issue_red(u, 0);
+                stats.red_insts++;
+                if (kRedUops > 1) {
+                    red_index = 1;
+                } else {
+                    pc++;
+                }
+            } else {
+                issue_fma(u);
+                stats.fma_uops++;
+                pc++;
+            }
+            stats.issue_cycles++;
+        } else if (pc < prog.size()) {
+            (by_red ? stats.stall_red : stats.stall_fma)++;
+        } else {
+            // 程序已发射完, 等待最后的结果写回
+            (red_q_.empty() ? stats.stall_fma : stats.stall_red)++;
+        }
+
+        single_cycle();
+
+        // 2. 写回寄存器堆, kIssueDelay 个周期后可被读出
+        bool progress = false;
+        if (top_->io_fma_valid_out && !fma_q_.empty()) {
+            Pending p = fma_q_.front();
+            fma_q_.pop_front();
+            VReg& vd = vrf_[p.vd];
+            for (int w = 0; w < kVlenWords; w++) vd[w] = top_->io_fma_vd[w];
+            vready_[p.vd] = cycles_ + kIssueDelay;
+            stats.fma_latency_sum += cycles_ - p.issue_cycle;
+            progress = true;
+        }
+        if (top_->io_red_finish && !red_q_.empty()) {
+            Pending p = red_q_.front();
+            red_q_.pop_front();
+            frf_[p.vd] = top_->io_red_vd;
+            fready_[p.vd] = cycles_ + kIssueDelay;
+            stats.red_latency_sum += cycles_ - p.issue_cycle;
+            progress = true;
+        }
+
+        if (progress || top_->io_fma_valid_in || top_->io_red_fire) {
+            timeout = 1000;
+        } else if (--timeout == 0) {
+            printf("Timeout: no progress at uop %zu (%zu FMA, %zu reduction results outstanding)\n",
+                   pc, fma_q_.size(), red_q_.size());
+            stats.cycles += cycles_ - start;
+            return false;
+        }
+    }
+    stats.cycles += cycles_ - start;
+    return true;
+}
@@ -0,0 +1,113 @@
+#include "include/kernel_simulator.h"
+#include "include/kernel_program.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+static float as_float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static void print_breakdown(const KernelStats& s) {
+  printf("  issue %lu, stall on FMA result %lu, stall on reduction %lu (%.1f%% of cycles)\n",
+         s.issue_cycles, s.stall_fma, s.stall_red, s.cycles ? 100.0 * s.stall_red / s.cycles : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+  // 0. 解析命令行选项
+  KernelSpec spec;
+  for (int i = 1; i < argc; ++i) {
+    bool ok;
+    if (parse_kernel_option(argv[i], spec, ok) && !ok) return 2;
+  }
+  if (!check_kernel_spec(spec)) return 2;
+
+  // 1. 初始化随机数生成器种子
+  srand(time(NULL));
+
+  // 2. 初始化仿真器和每次调用的输入数据
+  KernelSimulator sim(argc, argv);
+  std::vector<KernelData> data;
+  for (int i = 0; i < spec.iters; ++i) {
+    data.push_back(make_kernel_data(spec));
+  }
+  const int acc = std::min(spec.acc, spec.n / kVlenWords);
+  printf("Kernel %s: n=%d, %d accumulators, %d iterations (VLEN=%d, reduction VLEN=%d)\n",
+         kernel_name(spec.kind), spec.n, acc, spec.iters, kVlen, kRedVlen);
+
+  // 3. 单次调用的端到端延迟 (流水线排空)
+  KernelStats lat;
+  std::vector<KernelUop> prog;
+  append_kernel(spec, data[0], 0, prog);
+  sim.reset(2);
+  if (!sim.run(prog, lat)) return 1;
+  printf("Uops per iteration: %lu FMA, %lu vfredusum (%d reduction uops each)\n",
+         lat.fma_uops, lat.red_insts, kRedUops);
+  printf("Latency (one iteration, pipeline drained): %lu cycles\n", lat.cycles);
+  print_breakdown(lat);
+
+  // 4. 连续调用: 每批最多 32 次 (结果写 f0..f31), 批内各次调用的 FMA 与归约重叠
+  KernelStats thr;
+  std::vector<uint32_t> results(spec.iters);
+  sim.reset(2);
+  for (int base = 0; base < spec.iters; base += 32) {
+    int n = std::min(32, spec.iters - base);
+    prog.clear();
+    for (int i = 0; i < n; ++i) {
+      append_kernel(spec, data[base + i], i, prog);
+    }
+    if (!sim.run(prog, thr)) return 1;
+    for (int i = 0; i < n; ++i) {
+      results[base + i] = sim.freg(i);
+    }
+  }
+  printf("Throughput (iterations back to back): %.2f cycles/iteration\n",
+         (double)thr.cycles / spec.iters);
+  print_breakdown(thr);
+
+  printf("Measured FMA latency %.2f cycles (fmaDelay - delayBias = %d)\n",
+         thr.fma_uops ? (double)thr.fma_latency_sum / thr.fma_uops : 0.0, kFmaDelay - kDelayBias);
+  printf("Measured reduction latency %.2f cycles (fredFp32Delay - delayBias = %d)\n",
+         thr.red_insts ? (double)thr.red_latency_sum / thr.red_insts : 0.0, kFredFp32Delay - kDelayBias);
+
+  // 5. 数值误差: 与 fp64 参考比较, 归一化误差 |dut - ref| / sum|a*b| 的上界取 n * 2^-23
+  double max_rel = 0.0, sum_rel = 0.0, max_norm = 0.0;
+  int bad = 0;
+  for (int i = 0; i < spec.iters; ++i) {
+    double ref = kernel_reference(spec, data[i]);
+    KernelData abs_data = data[i];
+    for (uint32_t& x : abs_data.a) x &= 0x7fffffff;
+    for (uint32_t& x : abs_data.b) x &= 0x7fffffff;
+    double scale = kernel_reference(spec, abs_data);
+    double dut = as_float(results[i]);
+    double err = std::fabs(dut - ref);
+    double rel = ref != 0.0 ? err / std::fabs(ref) : err;
+    double norm = scale != 0.0 ? err / scale : err;
+    if (!std::isfinite(dut) || norm > spec.n * std::ldexp(1.0, -23)) {
+      if (bad++ < 10) {
+        printf("Iteration %d: DUT %.9g (0x%08x), fp64 reference %.9g\n", i, dut, results[i], ref);
+      }
+    }
+    max_rel = std::max(max_rel, rel);
+    sum_rel += rel;
+    max_norm = std::max(max_norm, norm);
+  }
+  printf("Numeric error vs fp64: max rel %.3e, mean rel %.3e, max normalized %.3e (bound %.3e)\n",
+         max_rel, sum_rel / spec.iters, max_norm, spec.n * std::ldexp(1.0, -23));
+
+  printf("\n=================================\n");
+  if (bad) {
+    printf("      KERNEL FAILED! (%d of %d iterations out of bound)\n", bad, spec.iters);
+    printf("=================================\n");
+    return 1;
+  }
+  printf("      KERNEL PASSED!\n");
+  printf("=================================\n");
+  return 0;
+}
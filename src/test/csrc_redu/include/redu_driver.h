@@ -0,0 +1,51 @@
+#ifndef __REDU_DRIVER_H__
+#define __REDU_DRIVER_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "redu_simulator.h"
+
+// ===================================================================
+// 归约指令 (fp32 / fp16 / bf16 的 vfredusum / vfredmax) 及其 uop 展开
+//   LMUL = 2^vlmul 个寄存器组成一组, 每个 uop 处理 n = uop_elements(fp_format) 个元素,
+//   第 k 个 uop 处理元素 [k*n, (k+1)*n); 16 位元素每字两个, 低半字在前
+//   Vfreduction 目前不使用 io.mask, 展开时把非活跃元素替换为单位元 (sum: -0.0, max: -inf),
+//   mask 端口仍按 uop 驱动该 uop 的元素掩码 (bit e 对应 uop 内第 e 个元素)
+// ===================================================================
+struct ReduInst {
+    bool is_sum = true;
+    int vlmul = 0;                 // 0..3
+    int fp_format = 2;             // 0 bf16, 1 fp16, 2 fp32
+    uint32_t vs1 = 0;              // 标量初值 (16 位格式在低半字)
+    std::vector<uint32_t> vs2;     // LMUL * n 个元素
+    std::vector<uint8_t> active;   // 每个元素的 v0 掩码位
+
+    // 展开后的 uop 操作数 (expand_reduction 填写)
+    std::vector<uint32_t> uop_vs2, uop_mask;
+};
+
+// 每个 uop 的元素个数: fp32 为 kWords, fp16/bf16 为 2 * kWords
+int uop_elements(int fp_format);
+const char* format_name(int fp_format);
+
+// 随机生成一条指令, density 为活跃元素的比例
+ReduInst make_reduction(bool is_sum, int vlmul, double density, int fp_format = 2);
+
+// 按 RTL 的要求展开成 LMUL 个连续发射的 uop (index 0..LMUL-1), 追加到 uops
+void expand_reduction(ReduInst& inst, std::vector<ReduUop>& uops);
+
+// Vfreduction 的求和顺序 (两两相加的归约树, 偶/奇 uop 两条累加链, 最后相加) 的参考 (RNE),
+// fflags 为这些加法的异常标志 (RISC-V 顺序: NV DZ OF UF NX).
+// 16 位格式: 每字的两个元素先以 fp19 (8 位指数, 11 位有效位) 相加, 之后的树在 fp32 中累加,
+// 最后把 fp32 累加结果舍入到 fp16 / bf16 (vd 低半字, 高半字为 0)
+void reduction_reference(const ReduInst& inst, uint32_t& vd, uint8_t& fflags);
+
+// LMUL 1/2/4/8 x 掩码密度的矩阵: 每格 n_insts 条 fp_format 的指令背靠背发射, 报告每条指令的周期数,
+// 逐位检查 vd (check_fflags 时同时检查 fflags); 全部通过返回true
+bool run_lmul_matrix(ReduSimulator& sim, int n_insts, bool check_fflags, int fp_format = 2);
+
+// 单条 LMUL=1 vfredsum 从发射到 finish 的周期数, 超时返回0
+uint64_t measure_latency(ReduSimulator& sim, int fp_format);
+
+#endif // __REDU_DRIVER_H__
@@ -0,0 +1,60 @@
+#ifndef __REDU_SIMULATOR_H__
+#define __REDU_SIMULATOR_H__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifndef REDU_VLEN
+#define REDU_VLEN 512
+#endif
+
+// 前向声明Verilator相关类
+class VtopRedu;
+class VerilatedContext;
+
+// topRedu 的一个 uop (fp_format 与 VectorElementFormat 一致: 0 bf16, 1 fp16, 2 fp32)
+struct ReduUop {
+    bool is_sum = true;          // vfredsum / vfredmax
+    uint8_t vlmul = 0;           // 0..3: LMUL 1/2/4/8
+    uint8_t index = 0;           // 寄存器组中的第几个 uop
+    uint8_t fp_format = 2;
+    uint32_t vs1 = 0;            // 标量初值 (只在 index 0 使用)
+    const uint32_t* vs2 = nullptr;   // kWords 个字
+    const uint32_t* mask = nullptr;  // kWords 个字, nullptr 表示全 1
+};
+
+// finish 时的输出和它出现的周期 (相对 run 开始)
+struct ReduResult {
+    uint32_t vd;
+    uint8_t fflags;
+    uint64_t cycle;
+};
+
+// ===================================================================
+// ReduSimulator 类: 驱动 topRedu (Vfreduction, VLEN = REDU_VLEN)
+// ===================================================================
+class ReduSimulator {
+public:
+    static constexpr int kVlen = REDU_VLEN;
+    static constexpr int kWords = kVlen / 32;
+
+    ReduSimulator(int argc, char* argv[]);
+    ~ReduSimulator();
+
+    void reset(int n);
+    // 每周期发射一个 uop (fire), 之后等待所有 finish; expected 为期望的 finish 个数
+    // 结果按出现顺序追加到 results, 超时返回false
+    bool run(const std::vector<ReduUop>& uops, size_t expected, std::vector<ReduResult>& results);
+    uint64_t cycles() const { return cycles_; }
+
+private:
+    void single_cycle();
+    void drive(const ReduUop& u);
+
+    std::unique_ptr<VerilatedContext> contextp_;
+    std::unique_ptr<VtopRedu> top_;
+    uint64_t cycles_ = 0;
+};
+
+#endif // __REDU_SIMULATOR_H__
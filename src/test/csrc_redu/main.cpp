@@ -0,0 +1,181 @@
+#include "include/redu_simulator.h"
+#include "include/redu_driver.h"
+#include "fp_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+// 与 VParameters.scala 一致: fredFp32Delay = log2(VLEN/32) + 1 + delayBias,
+// fredFp16Delay = log2(VLEN/32) + 2 + delayBias
+static const int kDelayBias = 1;
+
+static float as_float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static int log2_words() {
+  int l = 0;
+  while ((1 << l) < ReduSimulator::kWords) l++;
+  return l;
+}
+
+// 半精度归约的延迟: 以 fp32 的实测延迟除以 fredFp32Delay 的级数得到每级周期数,
+// fp16 / bf16 必须恰好用 fredFp16Delay 的级数 (比 fp32 多一级, 即每字两个元素的 fp19 加法)
+static bool check_half_latency(ReduSimulator& sim) {
+  const int levels32 = log2_words() + 1, levels16 = log2_words() + 2;
+  uint64_t lat32 = measure_latency(sim, 2);
+  if (!lat32) return false;
+  printf("Latency fp32: %lu cycles, fredFp32Delay - delayBias = %d levels (%.1f cycles/level)\n", lat32, levels32,
+         (double)lat32 / levels32);
+  bool ok = lat32 % levels32 == 0;
+  uint64_t expected = lat32 / levels32 * levels16;
+  for (int fmt : {1, 0}) {
+    uint64_t lat = measure_latency(sim, fmt);
+    printf("Latency %s: %lu cycles, fredFp16Delay - delayBias = %d levels -> expected %lu cycles: %s\n",
+           format_name(fmt), lat, levels16, expected, lat && lat == expected ? "ok" : "MISMATCH");
+    ok &= lat && lat == expected;
+  }
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  // 0. 解析命令行选项
+  int ops = 1000;
+  int lmul_insts = 0;  // >0: LMUL x 掩码密度矩阵, 每格的指令数
+  int half_insts = 0;  // >0: fp16/bf16 延迟检查和矩阵, 每格的指令数
+  bool check_fflags = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strncmp(argv[i], "--ops=", 6)) {
+      ops = atoi(argv[i] + 6);
+      if (ops < 1) {
+        printf("ERROR: --ops must be at least 1\n");
+        return 2;
+      }
+    } else if (!strcmp(argv[i], "--lmul")) {
+      lmul_insts = 200;
+    } else if (!strncmp(argv[i], "--lmul=", 7)) {
+      lmul_insts = atoi(argv[i] + 7);
+      if (lmul_insts < 1) {
+        printf("ERROR: --lmul=N needs at least 1 instruction\n");
+        return 2;
+      }
+    } else if (!strcmp(argv[i], "--half")) {
+      half_insts = 100;
+    } else if (!strncmp(argv[i], "--half=", 7)) {
+      half_insts = atoi(argv[i] + 7);
+      if (half_insts < 1) {
+        printf("ERROR: --half=N needs at least 1 instruction\n");
+        return 2;
+      }
+    } else if (!strcmp(argv[i], "--check-fflags")) {
+      check_fflags = true;
+    }
+  }
+  const int kWords = ReduSimulator::kWords;
+
+  // 1. 初始化随机数生成器种子和工作负载: ops 个 LMUL=1 的 fp32 vfredsum
+  srand(time(NULL));
+  std::vector<uint32_t> vs2((size_t)ops * kWords);
+  std::vector<uint32_t> vs1(ops);
+  for (uint32_t& x : vs2) x = gen_random_fp32(-4, 4);
+  for (uint32_t& x : vs1) x = gen_random_fp32(-4, 4);
+  std::vector<ReduUop> uops(ops);
+  for (int i = 0; i < ops; ++i) {
+    uops[i].vs1 = vs1[i];
+    uops[i].vs2 = &vs2[(size_t)i * kWords];
+  }
+
+  // 2. 初始化仿真器
+  ReduSimulator sim(argc, argv);
+
+  // LMUL 序列模式: 按 LMUL 1/2/4/8 展开归约指令, 背靠背发射并逐位检查结果
+  if (lmul_insts) {
+    printf("topRedu: VLEN=%d, LMUL x mask density matrix, %d instructions per cell%s\n",
+           ReduSimulator::kVlen, lmul_insts, check_fflags ? ", checking fflags" : "");
+    bool pass = run_lmul_matrix(sim, lmul_insts, check_fflags);
+    printf("\n=================================\n");
+    printf(pass ? "      ALL TESTS PASSED!\n" : "      TEST FAILED!\n");
+    printf("=================================\n");
+    return pass ? 0 : 1;
+  }
+
+  // 半精度模式: 延迟与 fredFp16Delay 比较, 再以 fp16 / bf16 跑 LMUL 矩阵 (逐位检查 vd 和 fflags)
+  if (half_insts) {
+    printf("topRedu: VLEN=%d, fp16/bf16 reductions, %d instructions per cell\n", ReduSimulator::kVlen,
+           half_insts);
+    bool pass = check_half_latency(sim);
+    for (int fmt : {1, 0}) {
+      pass &= run_lmul_matrix(sim, half_insts, true, fmt);
+    }
+    printf("\n=================================\n");
+    printf(pass ? "      ALL TESTS PASSED!\n" : "      TEST FAILED!\n");
+    printf("=================================\n");
+    return pass ? 0 : 1;
+  }
+  printf("topRedu: VLEN=%d (%d fp32 elements), %d reductions\n", ReduSimulator::kVlen, kWords, ops);
+
+  // 3. 单个归约的延迟
+  std::vector<ReduResult> results;
+  sim.reset(2);
+  if (!sim.run({uops[0]}, 1, results)) return 1;
+  uint64_t latency = results[0].cycle;
+  int modeled = log2_words() + 1 + kDelayBias;
+  printf("Latency: %lu cycles (fredFp32Delay at this VLEN = %d, minus delayBias = %d)\n",
+         latency, modeled, modeled - kDelayBias);
+
+  // 4. 背靠背吞吐和仿真开销
+  results.clear();
+  sim.reset(2);
+  auto t0 = std::chrono::steady_clock::now();
+  if (!sim.run(uops, ops, results)) return 1;
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  uint64_t cycles = results.back().cycle;
+  double ops_per_cycle = (double)ops / cycles;
+  double ns_per_cycle = secs * 1e9 / cycles;
+  printf("Throughput: %d reductions in %lu cycles (%.3f reductions/cycle)\n", ops, cycles, ops_per_cycle);
+  printf("Simulation cost: %.1f ns/cycle, %.1f ns/reduction\n", ns_per_cycle, secs * 1e9 / ops);
+
+  // 5. 检查结果: 与 fp64 参考比较, 归一化误差 |dut - ref| / (|vs1| + sum|vs2|) 上界取 n * 2^-23
+  int bad = 0;
+  double max_norm = 0.0, bound = (kWords + 1) * std::ldexp(1.0, -23);
+  for (int i = 0; i < ops; ++i) {
+    double ref = as_float(vs1[i]), scale = std::fabs(ref);
+    for (int w = 0; w < kWords; ++w) {
+      double x = as_float(vs2[(size_t)i * kWords + w]);
+      ref += x;
+      scale += std::fabs(x);
+    }
+    double dut = as_float(results[i].vd);
+    double norm = std::fabs(dut - ref) / scale;
+    max_norm = std::max(max_norm, norm);
+    if (!std::isfinite(dut) || norm > bound) {
+      if (bad++ < 10) {
+        printf("Reduction %d: DUT %.9g (0x%08x), fp64 reference %.9g\n", i, dut, results[i].vd, ref);
+      }
+    }
+  }
+  printf("Max normalized error %.3e (bound %.3e)\n", max_norm, bound);
+
+  // 6. 供 make redu_sweep 汇总的一行
+  printf("SWEEP vlen=%d latency=%lu modeled=%d ops_per_cycle=%.3f ns_per_cycle=%.1f pass=%d\n",
+         ReduSimulator::kVlen, latency, modeled - kDelayBias, ops_per_cycle, ns_per_cycle, bad == 0);
+  // 供 make bench 记录的一行
+  printf("BENCH ops_per_s=%.0f cycles_per_s=%.0f\n", ops / secs, cycles / secs);
+
+  printf("\n=================================\n");
+  if (bad) {
+    printf("      TEST FAILED! (%d of %d reductions out of bound)\n", bad, ops);
+    printf("=================================\n");
+    return 1;
+  }
+  printf("      ALL TESTS PASSED!\n");
+  printf("=================================\n");
+  return 0;
+}
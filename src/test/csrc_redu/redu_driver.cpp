@@ -0,0 +1,257 @@
+#include "include/redu_driver.h"
+#include "fp_utils.h"
+
+#include <cfenv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+static const int kWords = ReduSimulator::kWords;
+static const uint32_t kFp32NegZero = 0x80000000;
+static const uint32_t kFp32NegInf = 0xff800000;
+static const uint32_t kHalfNegZero = 0x8000;
+static const uint32_t kFp16NegInf = 0xfc00;
+static const uint32_t kBf16NegInf = 0xff80;
+
+static float as_float(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static uint32_t as_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+// RISC-V fmax: +0 大于 -0
+static float fp32_max(float a, float b) {
+    if (a == b) return std::signbit(a) ? b : a;
+    return a > b ? a : b;
+}
+
+static float combine(bool is_sum, float a, float b) {
+    volatile float x = a, y = b;
+    return is_sum ? x + y : fp32_max(x, y);
+}
+
+// 把 x 按 RNE 舍入到 exp_w 位指数, sig_w 位有效位 (含隐藏位) 的格式, 异常标志并入 fflags
+// (溢出得到 inf, 下溢按舍入后判断 tininess); 返回值仍用 double 表示
+static double round_to_format(double x, int exp_w, int sig_w, uint8_t& fflags) {
+    if (x == 0 || !std::isfinite(x)) return x;
+    const int emin = 2 - (1 << (exp_w - 1)), emax = (1 << (exp_w - 1)) - 1;
+    const double ax = std::fabs(x);
+    int e;
+    std::frexp(ax, &e);
+    e -= 1;  // ax 在 [2^e, 2^(e+1)) 中
+    int q = std::max(e, emin) - (sig_w - 1);
+    double r = std::ldexp(std::nearbyint(std::ldexp(ax, -q)), q);
+    double r_unbounded = std::ldexp(std::nearbyint(std::ldexp(ax, -(e - (sig_w - 1)))), e - (sig_w - 1));
+    bool inexact = r != ax;
+    if (r >= std::ldexp(1.0, emax + 1)) {
+        fflags |= 0x05;  // OF NX
+        return std::copysign(INFINITY, x);
+    }
+    if (inexact) fflags |= 0x01;
+    if (inexact && r_unbounded < std::ldexp(1.0, emin)) fflags |= 0x02;
+    return std::copysign(r, x);
+}
+
+static bool is_half(int fp_format) {
+    return fp_format != 2;
+}
+
+// 16 位元素 <-> float (精确)
+static float half_to_float(int fp_format, uint32_t bits) {
+    return fp_format == 1 ? fp16_to_fp32(bits) : bf16_to_fp32(bits);
+}
+
+static uint32_t float_to_half(int fp_format, float f) {
+    if (std::isnan(f)) return fp_format == 1 ? 0x7e00 : 0x7fc0;  // canonical NaN
+    return fp_format == 1 ? fp32_to_fp16(f) : fp32_to_bf16(f);
+}
+
+int uop_elements(int fp_format) {
+    return is_half(fp_format) ? 2 * kWords : kWords;
+}
+
+const char* format_name(int fp_format) {
+    return fp_format == 0 ? "bf16" : fp_format == 1 ? "fp16" : "fp32";
+}
+
+static uint32_t gen_element(int fp_format) {
+    return fp_format == 0 ? gen_random_bf16(-4, 4) : fp_format == 1 ? gen_random_fp16(-4, 4) : gen_random_fp32(-4, 4);
+}
+
+static uint32_t identity_bits(bool is_sum, int fp_format) {
+    if (is_half(fp_format)) return is_sum ? kHalfNegZero : fp_format == 1 ? kFp16NegInf : kBf16NegInf;
+    return is_sum ? kFp32NegZero : kFp32NegInf;
+}
+
+static float element_value(int fp_format, uint32_t bits) {
+    return is_half(fp_format) ? half_to_float(fp_format, bits) : as_float(bits);
+}
+
+ReduInst make_reduction(bool is_sum, int vlmul, double density, int fp_format) {
+    ReduInst inst;
+    inst.is_sum = is_sum;
+    inst.vlmul = vlmul;
+    inst.fp_format = fp_format;
+    inst.vs1 = gen_element(fp_format);
+    int n = (1 << vlmul) * uop_elements(fp_format);
+    inst.vs2.resize(n);
+    inst.active.resize(n);
+    for (int i = 0; i < n; i++) {
+        inst.vs2[i] = gen_element(fp_format);
+        inst.active[i] = rand() < density * ((double)RAND_MAX + 1.0);
+    }
+    return inst;
+}
+
+void expand_reduction(ReduInst& inst, vector<ReduUop>& uops) {
+    const int lmul = 1 << inst.vlmul;
+    const int n = uop_elements(inst.fp_format);
+    const int shift = is_half(inst.fp_format) ? 16 : 0;
+    const uint32_t identity = identity_bits(inst.is_sum, inst.fp_format);
+    inst.uop_vs2.assign((size_t)lmul * kWords, 0);
+    inst.uop_mask.assign((size_t)lmul * kWords, 0);
+    for (int i = 0; i < lmul * n; i++) {
+        int k = i / n, e = i % n;
+        uint32_t bits = inst.active[i] ? inst.vs2[i] : identity;
+        if (shift) {
+            inst.uop_vs2[k * kWords + e / 2] |= bits << (e % 2 * shift);
+        } else {
+            inst.uop_vs2[i] = bits;
+        }
+        if (inst.active[i]) {
+            inst.uop_mask[k * kWords + e / 32] |= 1u << (e % 32);
+        }
+    }
+    for (int k = 0; k < lmul; k++) {
+        ReduUop u;
+        u.is_sum = inst.is_sum;
+        u.vlmul = inst.vlmul;
+        u.index = k;
+        u.fp_format = inst.fp_format;
+        u.vs1 = inst.vs1;
+        u.vs2 = &inst.uop_vs2[(size_t)k * kWords];
+        u.mask = &inst.uop_mask[(size_t)k * kWords];
+        uops.push_back(u);
+    }
+}
+
+void reduction_reference(const ReduInst& inst, uint32_t& vd, uint8_t& fflags) {
+    const int lmul = 1 << inst.vlmul;
+    const bool half = is_half(inst.fp_format);
+    const float identity = element_value(inst.fp_format, identity_bits(inst.is_sum, inst.fp_format));
+
+    // 16 位格式: 每字的两个元素先在 fp19 中相加 (这一级的标志单独记录)
+    uint8_t soft_fflags = 0;
+    vector<float> words((size_t)lmul * kWords);
+    for (size_t w = 0; w < words.size(); w++) {
+        if (!half) {
+            words[w] = inst.active[w] ? as_float(inst.vs2[w]) : identity;
+            continue;
+        }
+        float a = inst.active[2 * w] ? element_value(inst.fp_format, inst.vs2[2 * w]) : identity;
+        float b = inst.active[2 * w + 1] ? element_value(inst.fp_format, inst.vs2[2 * w + 1]) : identity;
+        words[w] = inst.is_sum ? (float)round_to_format((double)a + b, 8, 11, soft_fflags) : fp32_max(a, b);
+    }
+
+    feclearexcept(FE_ALL_EXCEPT);
+    // 每个 uop: 相邻两个元素相加, 逐级减半
+    vector<float> chain(lmul);
+    for (int k = 0; k < lmul; k++) {
+        vector<float> level(words.begin() + (size_t)k * kWords, words.begin() + (size_t)(k + 1) * kWords);
+        for (int n = kWords; n > 1; n /= 2) {
+            for (int e = 0; e < n / 2; e++) {
+                level[e] = combine(inst.is_sum, level[2 * e], level[2 * e + 1]);
+            }
+        }
+        // uop 0 加上 vs1, uop 1 加上单位元, 之后偶/奇 uop 各自累加到两条链上
+        float seed = k == 0 ? element_value(inst.fp_format, inst.vs1) : k == 1 ? identity : chain[k - 2];
+        chain[k] = combine(inst.is_sum, level[0], seed);
+    }
+    float res = lmul == 1 ? chain[0] : combine(inst.is_sum, chain[lmul - 1], chain[lmul - 2]);
+
+    fflags = (fetestexcept(FE_INVALID) ? 0x10 : 0) | (fetestexcept(FE_DIVBYZERO) ? 0x08 : 0) |
+             (fetestexcept(FE_OVERFLOW) ? 0x04 : 0) | (fetestexcept(FE_UNDERFLOW) ? 0x02 : 0) |
+             (fetestexcept(FE_INEXACT) ? 0x01 : 0);
+    fflags |= soft_fflags;
+    if (!half) {
+        vd = as_bits(res);
+        return;
+    }
+    // fp32 累加结果舍入到 16 位格式
+    const int exp_w = inst.fp_format == 1 ? 5 : 8, sig_w = inst.fp_format == 1 ? 11 : 8;
+    vd = float_to_half(inst.fp_format, (float)round_to_format(res, exp_w, sig_w, fflags));
+}
+
+uint64_t measure_latency(ReduSimulator& sim, int fp_format) {
+    ReduInst inst = make_reduction(true, 0, 1.0, fp_format);
+    vector<ReduUop> uops;
+    expand_reduction(inst, uops);
+    vector<ReduResult> results;
+    sim.reset(2);
+    if (!sim.run(uops, 1, results)) return 0;
+    return results[0].cycle;
+}
+
+bool run_lmul_matrix(ReduSimulator& sim, int n_insts, bool check_fflags, int fp_format) {
+    static const double densities[] = {1.0, 0.5, 0.1, 0.0};
+    size_t total_bad = 0;
+
+    printf("%-4s %-4s %4s %7s %7s %8s %11s %8s %10s\n", "fmt", "op", "LMUL", "density", "insts", "cycles",
+           "cycles/inst", "latency", "mismatches");
+    for (bool is_sum : {true, false}) {
+        for (int vlmul = 0; vlmul <= 3; vlmul++) {
+            for (double density : densities) {
+                vector<ReduInst> insts;
+                insts.reserve(n_insts);
+                for (int i = 0; i < n_insts; i++) {
+                    insts.push_back(make_reduction(is_sum, vlmul, density, fp_format));
+                }
+                vector<ReduUop> uops;
+                for (ReduInst& inst : insts) {
+                    expand_reduction(inst, uops);
+                }
+
+                // 单条指令的延迟 (第一个 uop 发射到 finish)
+                vector<ReduResult> results;
+                const size_t lmul = size_t(1) << vlmul;
+                sim.reset(2);
+                if (!sim.run(vector<ReduUop>(uops.begin(), uops.begin() + lmul), 1, results)) return false;
+                uint64_t latency = results[0].cycle;
+
+                // 背靠背发射所有指令
+                results.clear();
+                sim.reset(2);
+                if (!sim.run(uops, insts.size(), results)) return false;
+                uint64_t cycles = results.back().cycle;
+
+                size_t bad = 0;
+                for (int i = 0; i < n_insts; i++) {
+                    uint32_t vd;
+                    uint8_t fflags;
+                    reduction_reference(insts[i], vd, fflags);
+                    bool ok = results[i].vd == vd && (!check_fflags || results[i].fflags == fflags);
+                    if (!ok && bad++ < 3) {
+                        printf("  %s %s LMUL=%zu inst %d: DUT vd 0x%08x fflags 0x%02x, "
+                               "expected vd 0x%08x fflags 0x%02x\n", format_name(fp_format),
+                               is_sum ? "sum" : "max", lmul, i,
+                               results[i].vd, results[i].fflags, vd, fflags);
+                    }
+                }
+                total_bad += bad;
+                printf("%-4s %-4s %4zu %7.2f %7d %8lu %11.2f %8lu %10zu\n", format_name(fp_format),
+                       is_sum ? "sum" : "max", lmul,
+                       density, n_insts, cycles, (double)cycles / n_insts, latency, bad);
+            }
+        }
+    }
+    return total_bad == 0;
+}
@@ -0,0 +1,81 @@
+#include "include/redu_simulator.h"
+#include <verilated.h>
+#include "VtopRedu.h"
+
+#include <cstdio>
+
+using namespace std;
+
+static_assert(sizeof(VtopRedu::io_vs2) == ReduSimulator::kVlen / 8, "REDU_VLEN does not match the generated topRedu");
+
+ReduSimulator::ReduSimulator(int argc, char* argv[]) {
+    contextp_ = make_unique<VerilatedContext>();
+    contextp_->commandArgs(argc, argv);
+    top_ = make_unique<VtopRedu>(contextp_.get());
+}
+
+ReduSimulator::~ReduSimulator() {
+    top_->final();
+}
+
+void ReduSimulator::single_cycle() {
+    top_->clock = 0;
+    top_->eval();
+    contextp_->timeInc(1);
+
+    top_->clock = 1;
+    top_->eval();
+    contextp_->timeInc(1);
+    cycles_++;
+}
+
+void ReduSimulator::reset(int n) {
+    top_->io_fire = 0;
+    top_->reset = 1;
+    for (int i = 0; i < n; i++) {
+        single_cycle();
+    }
+    top_->reset = 0;
+    top_->eval();
+}
+
+void ReduSimulator::drive(const ReduUop& u) {
+    top_->io_fire = 1;
+    top_->io_is_vfredsum = u.is_sum;
+    top_->io_is_vfredmax = !u.is_sum;
+    top_->io_vlmul = u.vlmul;
+    top_->io_index = u.index;
+    top_->io_round_mode = 0;  // RNE
+    top_->io_fp_format = u.fp_format;
+    top_->io_is_vec = 1;
+    top_->io_vs1 = u.vs1;
+    for (int w = 0; w < kWords; w++) {
+        top_->io_vs2[w] = u.vs2[w];
+        top_->io_mask[w] = u.mask ? u.mask[w] : 0xffffffff;
+    }
+}
+
+bool ReduSimulator::run(const vector<ReduUop>& uops, size_t expected, vector<ReduResult>& results) {
+    uint64_t start = cycles_;
+    size_t next = 0, finished = 0;
+    int timeout = 100; // 发射结束后等待finish的超时周期
+
+    while (next < uops.size() || finished < expected) {
+        if (next < uops.size()) {
+            drive(uops[next++]);
+        } else {
+            // 只拉低fire, 控制信号保持不变 (输出选择使用流水线末级的控制信号)
+            top_->io_fire = 0;
+        }
+        single_cycle();
+
+        if (top_->io_finish) {
+            results.push_back({top_->io_vd, top_->io_fflags, cycles_ - start});
+            finished++;
+        } else if (next == uops.size() && --timeout == 0) {
+            printf("Timeout waiting for finish (%zu of %zu finished)\n", finished, expected);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef __VFADD_REF_H__
+#define __VFADD_REF_H__
+
+#include <cstdint>
+
+#include "vfadd_simulator.h"
+
+// ===================================================================
+// topVfadd 的逐位参考模型 (软件浮点, 不依赖主机 FPU 的舍入模式)
+//   fadd/fsub: IEEE 754 加法, 五种舍入模式, NaN 结果为规范 NaN,
+//              下溢按 RISC-V 规定在舍入之后判断 (tiny 且 inexact 时置 UF)
+//   fmin/fmax: minimumNumber/maximumNumber, -0 < +0, 两个 NaN 时为规范 NaN
+//   比较: 结果 0/1 放在元素最低位; feq/fne 只在 sNaN 时置 NV, 其余比较遇 NaN 置 NV
+//   fclass: RISC-V 10 位分类; fsgnj*/fmerge/fmove 只搬移位
+//   加宽: fp16 先精确转换为 fp32, 再按 fp32 运算
+// ===================================================================
+
+// 一个 uop 的 64 位结果和 20 位 fflags
+void vfadd_reference(const VfaddUop& u, uint64_t& result, uint32_t& fflags);
+
+// 每种格式的元素个数 (加宽时结果为 2 个 fp32)
+int vfadd_elements(const VfaddUop& u);
+
+// 日志用的名字
+const char* vfadd_op_name(uint8_t op_code);
+const char* vfadd_format_name(const VfaddUop& u);
+
+#endif // __VFADD_REF_H__
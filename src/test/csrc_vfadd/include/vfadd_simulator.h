@@ -0,0 +1,68 @@
+#ifndef __VFADD_SIMULATOR_H__
+#define __VFADD_SIMULATOR_H__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 前向声明Verilator相关类
+class VtopVfadd;
+class VerilatedContext;
+
+// 与 redu_Bundles.scala 中的 VfaddOpCode 一致
+namespace VfaddOp {
+constexpr uint8_t fadd = 0x00, fsub = 0x01, fmin = 0x02, fmax = 0x03;
+constexpr uint8_t fmerge = 0x04, fmove = 0x05;
+constexpr uint8_t fsgnj = 0x06, fsgnjn = 0x07, fsgnjx = 0x08;
+constexpr uint8_t feq = 0x09, fne = 0x0a, flt = 0x0b, fle = 0x0c, fgt = 0x0d, fge = 0x0e;
+constexpr uint8_t fclass = 0x0f;
+}
+
+// 与 VectorElementFormat 一致
+enum VfaddFormat : uint8_t { FMT_BF16 = 0, FMT_FP16 = 1, FMT_FP32 = 2 };
+
+// topVfadd 的一个 uop (一个 64 位 lane: 4 个 bf16/fp16 或 2 个 fp32 元素)
+struct VfaddUop {
+    uint8_t op_code = VfaddOp::fadd;
+    uint8_t fp_format = FMT_FP32;     // 结果格式
+    uint8_t round_mode = 0;           // 0 RNE, 1 RTZ, 2 RDN, 3 RUP, 4 RMM
+    bool is_vec = true;               // false: 只有元素 0 有效, 其余输出为 0
+    bool is_frs1 = false;             // vs1 的每个元素都换成 frs1 的低位元素
+    bool res_widening = false;        // fp16 -> fp32 (vfwadd.vv)
+    bool opb_widening = false;        // 只有 vs1 为 fp16 (vfwadd.wv)
+    bool uop_idx = false;             // 加宽时取 fp16 元素 0/1 (false) 或 2/3 (true)
+    uint8_t mask = 0xf;               // 每个元素一位, 只用于 fmerge
+    uint64_t vs1 = 0, vs2 = 0, frs1 = 0;
+};
+
+// valid_out 时的输出和它出现的周期 (相对 run 开始)
+struct VfaddResult {
+    uint64_t result;
+    uint32_t fflags;   // 每个元素 5 位 (NV DZ OF UF NX), 元素 k 在 [5k+4, 5k]
+    uint64_t cycle;
+};
+
+// ===================================================================
+// VfaddSimulator 类: 驱动 topVfadd (VectorFloatAdder_Width64)
+// ===================================================================
+class VfaddSimulator {
+public:
+    VfaddSimulator(int argc, char* argv[]);
+    ~VfaddSimulator();
+
+    void reset(int n);
+    // 每周期发射一个 uop (fire), 之后等待所有 valid_out
+    // 结果按出现顺序追加到 results, 超时返回false
+    bool run(const std::vector<VfaddUop>& uops, std::vector<VfaddResult>& results);
+    uint64_t cycles() const { return cycles_; }
+
+private:
+    void single_cycle();
+    void drive(const VfaddUop& u);
+
+    std::unique_ptr<VerilatedContext> contextp_;
+    std::unique_ptr<VtopVfadd> top_;
+    uint64_t cycles_ = 0;
+};
+
+#endif // __VFADD_SIMULATOR_H__
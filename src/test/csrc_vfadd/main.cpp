@@ -0,0 +1,202 @@
+#include "include/vfadd_simulator.h"
+#include "include/vfadd_ref.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+static uint32_t rand32() {
+  return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+// 随机元素: 偏向 1.0 附近, 也覆盖次正规数, ±0, 上溢/下溢边界, ±inf, qNaN, sNaN
+static uint32_t random_element(int ebits, int mbits) {
+  const uint32_t emax = (1u << ebits) - 1, mmask = (1u << mbits) - 1, qbit = 1u << (mbits - 1);
+  const int bias = (1 << (ebits - 1)) - 1;
+  uint32_t sign = rand() & 1, m = rand32() & mmask, e;
+  int c = rand() % 100;
+  if (c < 40) {
+    e = bias - 3 + rand() % 7;
+  } else if (c < 60) {
+    e = 1 + rand() % (emax - 1);
+  } else if (c < 68) {
+    e = 0;
+    m |= m ? 0 : 1;
+  } else if (c < 72) {
+    e = 0;
+    m = 0;
+  } else if (c < 78) {
+    e = emax - 1;
+  } else if (c < 84) {
+    e = 1;
+  } else if (c < 89) {
+    e = emax;
+    m = 0;
+  } else if (c < 94) {
+    e = emax;
+    m |= qbit;
+  } else {
+    e = emax;
+    m &= ~qbit;
+    m |= m ? 0 : 1;
+  }
+  return (sign << (ebits + mbits)) | (e << mbits) | m;
+}
+
+// 与 a 相近的元素 (同指数或相邻指数, 随机符号), 覆盖相减抵消的 close path
+static uint32_t near_element(uint32_t a, int ebits, int mbits) {
+  const uint32_t emax = (1u << ebits) - 1;
+  uint32_t e = (a >> mbits) & emax;
+  uint32_t r = a ^ (rand32() & 0xf);
+  if (rand() & 1) r ^= 1u << (ebits + mbits);
+  if (e >= 2 && e + 2 <= emax && rand() % 4 == 0) r += (rand() & 1) ? (1u << mbits) : -(1u << mbits);
+  return r;
+}
+
+// 一个 uop 的操作数: 元素 k 放在 [w*k + w-1, w*k]
+static void fill_operands(VfaddUop& u, int ebits, int mbits, int n) {
+  const int w = 1 + ebits + mbits;
+  u.vs1 = u.vs2 = 0;
+  for (int k = 0; k < n; ++k) {
+    uint32_t a = random_element(ebits, mbits);
+    uint32_t b = rand() % 100 < 30 ? near_element(a, ebits, mbits) : random_element(ebits, mbits);
+    u.vs2 |= (uint64_t)a << (w * k);
+    u.vs1 |= (uint64_t)b << (w * k);
+  }
+  u.frs1 = random_element(ebits, mbits);
+}
+
+static VfaddUop make_uop(uint8_t op, uint8_t fmt, bool res_widening, bool opb_widening, uint8_t rm) {
+  VfaddUop u;
+  u.op_code = op;
+  u.fp_format = fmt;
+  u.round_mode = rm;
+  u.res_widening = res_widening;
+  u.opb_widening = opb_widening;
+  u.uop_idx = rand() & 1;
+  u.is_vec = rand() % 10 != 0;
+  u.is_frs1 = op != VfaddOp::fclass && rand() % 4 == 0;
+  u.mask = rand() & 0xf;
+  if (res_widening) {
+    fill_operands(u, 5, 10, 4);
+    if (opb_widening) {
+      // .wv: vs2 为 2 个 fp32
+      VfaddUop w;
+      fill_operands(w, 8, 23, 2);
+      u.vs2 = w.vs2;
+    }
+  } else if (fmt == FMT_FP32) {
+    fill_operands(u, 8, 23, 2);
+  } else if (fmt == FMT_FP16) {
+    fill_operands(u, 5, 10, 4);
+  } else {
+    fill_operands(u, 8, 7, 4);
+  }
+  return u;
+}
+
+int main(int argc, char *argv[]) {
+  // 0. 解析命令行选项
+  int per = 100;  // 每个 (操作, 格式, 舍入模式) 的 uop 数
+  bool verbose = false;
+  long seed = -1;  // -1: 按时间取种子
+  for (int i = 1; i < argc; ++i) {
+    if (!strncmp(argv[i], "--per=", 6)) {
+      per = atoi(argv[i] + 6);
+      if (per < 1) {
+        printf("ERROR: --per must be at least 1\n");
+        return 2;
+      }
+    } else if (!strcmp(argv[i], "--verbose")) {
+      verbose = true;
+    } else if (!strncmp(argv[i], "--seed=", 7)) {
+      seed = strtoul(argv[i] + 7, nullptr, 0);
+    }
+  }
+
+  // 1. 初始化随机数生成器种子和工作负载: 所有操作 x 格式 x 舍入模式, 打乱后背靠背发射
+  if (seed < 0) seed = time(NULL);
+  srand((unsigned)seed);
+  std::vector<VfaddUop> uops;
+  for (uint8_t op = VfaddOp::fadd; op <= VfaddOp::fclass; ++op) {
+    for (uint8_t rm = 0; rm < 5; ++rm) {
+      for (int i = 0; i < per; ++i) {
+        uops.push_back(make_uop(op, FMT_BF16, false, false, rm));
+        uops.push_back(make_uop(op, FMT_FP16, false, false, rm));
+        uops.push_back(make_uop(op, FMT_FP32, false, false, rm));
+        if (op == VfaddOp::fadd || op == VfaddOp::fsub) {
+          uops.push_back(make_uop(op, FMT_FP32, true, false, rm));
+          uops.push_back(make_uop(op, FMT_FP32, true, true, rm));
+        }
+      }
+    }
+  }
+  std::shuffle(uops.begin(), uops.end(), std::mt19937(rand()));
+  size_t elements = 0;
+  for (const VfaddUop& u : uops) elements += u.is_vec ? vfadd_elements(u) : 1;
+
+  // 2. 初始化仿真器
+  VfaddSimulator sim(argc, argv);
+  printf("topVfadd: %zu uops (%zu elements), %d per op/format/rounding mode (seed %u, rerun with --seed=%u)\n",
+         uops.size(), elements, per, (unsigned)seed, (unsigned)seed);
+
+  // 3. 单个 uop 的延迟
+  std::vector<VfaddResult> results;
+  sim.reset(2);
+  if (!sim.run({uops[0]}, results)) return 1;
+  printf("Latency: %lu cycles\n", results[0].cycle);
+
+  // 4. 背靠背吞吐和仿真开销
+  results.clear();
+  sim.reset(2);
+  auto t0 = std::chrono::steady_clock::now();
+  if (!sim.run(uops, results)) return 1;
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  uint64_t cycles = results.back().cycle;
+  printf("Throughput: %zu uops in %lu cycles (%.3f uops/cycle, %.3f elements/cycle)\n",
+         uops.size(), cycles, (double)uops.size() / cycles, (double)elements / cycles);
+  printf("Simulation cost: %.1f ns/cycle, %.2f Muops/s\n", secs * 1e9 / cycles, uops.size() / secs / 1e6);
+
+  // 5. 逐位检查结果和 fflags, 按 (操作, 格式) 统计
+  std::map<std::string, std::pair<int, int>> table;  // 失败数, 总数
+  int bad = 0;
+  for (size_t i = 0; i < uops.size(); ++i) {
+    const VfaddUop& u = uops[i];
+    uint64_t ref;
+    uint32_t ref_fflags;
+    vfadd_reference(u, ref, ref_fflags);
+    bool ok = results[i].result == ref && results[i].fflags == ref_fflags;
+    auto& cell = table[std::string(vfadd_op_name(u.op_code)) + " " + vfadd_format_name(u)];
+    cell.second++;
+    if (!ok) cell.first++;
+    if (!ok || verbose) {
+      if (ok || bad++ < 20) {
+        printf("%s %-6s %-11s rm=%d vec=%d frs1=%d idx=%d mask=%x vs2=%016lx vs1=%016lx frs1=%016lx: "
+               "DUT %016lx/%05x, expected %016lx/%05x\n", ok ? "PASS" : "FAIL",
+               vfadd_op_name(u.op_code), vfadd_format_name(u), u.round_mode, u.is_vec, u.is_frs1,
+               u.uop_idx, u.mask, u.vs2, u.vs1, u.frs1, results[i].result, results[i].fflags, ref, ref_fflags);
+      }
+    }
+  }
+
+  printf("\n%-20s %8s %8s\n", "op format", "uops", "failed");
+  for (const auto& kv : table) {
+    printf("%-20s %8d %8d\n", kv.first.c_str(), kv.second.second, kv.second.first);
+  }
+
+  printf("\n=================================\n");
+  if (bad) {
+    printf("      TEST FAILED! (%d of %zu uops)\n", bad, uops.size());
+    printf("=================================\n");
+    return 1;
+  }
+  printf("      ALL TESTS PASSED!\n");
+  printf("=================================\n");
+  return 0;
+}
@@ -0,0 +1,276 @@
+#include "include/vfadd_ref.h"
+
+using namespace std;
+
+// 浮点格式: 指数位数和尾数 (小数) 位数
+struct FpFormat {
+    int ebits, mbits;
+    int width() const { return 1 + ebits + mbits; }
+    int bias() const { return (1 << (ebits - 1)) - 1; }
+    uint32_t emax_field() const { return (1u << ebits) - 1; }
+    uint32_t mask() const { return (uint32_t)((1ull << width()) - 1); }
+    uint32_t canonical_nan() const { return (emax_field() << mbits) | (1u << (mbits - 1)); }
+};
+
+static const FpFormat kBf16 = {8, 7};
+static const FpFormat kFp16 = {5, 10};
+static const FpFormat kFp32 = {8, 23};
+
+static const uint32_t NV = 0x10, OF = 0x04, UF = 0x02, NX = 0x01;
+
+// 解码后的元素: 有限值为 sig * 2^exp
+struct Unpacked {
+    bool sign, zero, inf, nan, snan;
+    uint64_t sig;
+    int exp;
+};
+
+static Unpacked unpack(uint32_t bits, const FpFormat& f) {
+    Unpacked u;
+    uint32_t e = (bits >> f.mbits) & f.emax_field();
+    uint32_t m = bits & ((1u << f.mbits) - 1);
+    u.sign = (bits >> (f.width() - 1)) & 1;
+    u.nan = e == f.emax_field() && m != 0;
+    u.snan = u.nan && !((m >> (f.mbits - 1)) & 1);
+    u.inf = e == f.emax_field() && m == 0;
+    u.zero = e == 0 && m == 0;
+    u.sig = e ? (m | (1u << f.mbits)) : m;
+    u.exp = (e ? (int)e : 1) - f.bias() - f.mbits;
+    return u;
+}
+
+static uint32_t pack(bool sign, uint32_t e, uint32_t m, const FpFormat& f) {
+    return ((uint32_t)sign << (f.width() - 1)) | (e << f.mbits) | m;
+}
+
+// 把 sig * 2^exp 舍入为 2^qexp 的整数倍, 返回倍数; inexact 表示有舍弃的位
+static uint64_t round_to(bool sign, uint64_t sig, int exp, int qexp, int rm, bool& inexact) {
+    int shift = qexp - exp;
+    if (shift <= 0) {
+        inexact = false;
+        return sig << -shift;
+    }
+    uint64_t q, rem, half;
+    if (shift > 63) {
+        // sig < 2^63, 不足半个 2^qexp
+        q = 0;
+        rem = 1;
+        half = 2;
+    } else {
+        q = sig >> shift;
+        rem = sig & ((1ull << shift) - 1);
+        half = 1ull << (shift - 1);
+    }
+    inexact = rem != 0;
+    bool up = false;
+    switch (rm) {
+    case 0: up = rem > half || (rem == half && (q & 1)); break;  // RNE
+    case 1: up = false; break;                                   // RTZ
+    case 2: up = inexact && sign; break;                         // RDN
+    case 3: up = inexact && !sign; break;                        // RUP
+    case 4: up = rem >= half; break;                             // RMM
+    }
+    return q + up;
+}
+
+static int msb(uint64_t x) {
+    return 63 - __builtin_clzll(x);
+}
+
+// 舍入并打包非零的 sig * 2^exp
+static uint32_t round_pack(bool sign, uint64_t sig, int exp, const FpFormat& f, int rm, uint32_t& flags) {
+    const int emin = 1 - f.bias();
+    int e_unb = msb(sig) + exp;  // 最高位的指数
+
+    // 下溢按舍入之后判断: 指数范围不受限时舍入的结果仍小于 2^emin
+    bool tiny = false;
+    if (e_unb < emin) {
+        bool ix;
+        uint64_t q = round_to(sign, sig, exp, e_unb - f.mbits, rm, ix);
+        tiny = !(q >> (f.mbits + 1)) || e_unb + 1 < emin;
+    }
+
+    int qexp = (e_unb < emin ? emin : e_unb) - f.mbits;
+    bool inexact;
+    uint64_t q = round_to(sign, sig, exp, qexp, rm, inexact);
+    if (q >> (f.mbits + 1)) {  // 舍入进位, 多出的一位一定是 0
+        q >>= 1;
+        qexp++;
+    }
+    uint32_t e = (q >> f.mbits) ? (uint32_t)(qexp + f.mbits + f.bias()) : 0;
+
+    if (inexact) flags |= NX;
+    if (tiny && inexact) flags |= UF;
+    if (e >= f.emax_field()) {
+        flags |= OF | NX;
+        bool to_inf = rm == 0 || rm == 4 || (rm == 2 && sign) || (rm == 3 && !sign);
+        return to_inf ? pack(sign, f.emax_field(), 0, f)
+                      : pack(sign, f.emax_field() - 1, (1u << f.mbits) - 1, f);
+    }
+    return pack(sign, e, (uint32_t)q & ((1u << f.mbits) - 1), f);
+}
+
+static uint32_t fp_add(uint32_t a_bits, uint32_t b_bits, bool sub, const FpFormat& f, int rm, uint32_t& flags) {
+    Unpacked a = unpack(a_bits, f), b = unpack(b_bits, f);
+    b.sign ^= sub;
+    if (a.nan || b.nan) {
+        if (a.snan || b.snan) flags |= NV;
+        return f.canonical_nan();
+    }
+    if (a.inf && b.inf && a.sign != b.sign) {
+        flags |= NV;
+        return f.canonical_nan();
+    }
+    if (a.inf) return pack(a.sign, f.emax_field(), 0, f);
+    if (b.inf) return pack(b.sign, f.emax_field(), 0, f);
+    if (a.zero && b.zero) return pack(a.sign == b.sign ? a.sign : rm == 2, 0, 0, f);
+    if (a.zero) return (b_bits & (f.mask() >> 1)) | ((uint32_t)b.sign << (f.width() - 1));
+    if (b.zero) return a_bits;
+
+    // a 的指数较大; a 左移最多 32 位, b 右移的部分并入粘滞位
+    if (a.exp < b.exp) swap(a, b);
+    int diff = a.exp - b.exp;
+    int s = diff < 32 ? diff : 32;
+    uint64_t sa = a.sig << s, sb;
+    int rs = diff - s;
+    if (rs == 0) {
+        sb = b.sig;
+    } else {
+        sb = rs > 63 ? 0 : b.sig >> rs;
+        if (rs > 63 || (b.sig & ((1ull << rs) - 1))) sb |= 1;
+    }
+    int exp = a.exp - s;
+
+    bool sign;
+    uint64_t sig;
+    if (a.sign == b.sign) {
+        sig = sa + sb;
+        sign = a.sign;
+    } else if (sa >= sb) {
+        sig = sa - sb;
+        sign = a.sign;
+    } else {
+        sig = sb - sa;
+        sign = b.sign;
+    }
+    if (sig == 0) return pack(rm == 2, 0, 0, f);  // 精确抵消: RDN 为 -0, 其余为 +0
+    return round_pack(sign, sig, exp, f, rm, flags);
+}
+
+// a < b (两者都不是 NaN)
+static bool fp_lt(const Unpacked& a, const Unpacked& b, uint32_t a_bits, uint32_t b_bits, const FpFormat& f) {
+    if (a.zero && b.zero) return false;
+    if (a.sign != b.sign) return a.sign;
+    uint32_t ma = a_bits & (f.mask() >> 1), mb = b_bits & (f.mask() >> 1);
+    return a.sign ? ma > mb : ma < mb;
+}
+
+static bool fp_eq(const Unpacked& a, const Unpacked& b, uint32_t a_bits, uint32_t b_bits) {
+    return (a.zero && b.zero) || a_bits == b_bits;
+}
+
+static uint32_t fp_minmax(uint32_t a_bits, uint32_t b_bits, bool is_max, const FpFormat& f, uint32_t& flags) {
+    Unpacked a = unpack(a_bits, f), b = unpack(b_bits, f);
+    if (a.snan || b.snan) flags |= NV;
+    if (a.nan && b.nan) return f.canonical_nan();
+    if (a.nan) return b_bits;
+    if (b.nan) return a_bits;
+    bool a_lt_b = fp_lt(a, b, a_bits, b_bits, f) || (a.zero && b.zero && a.sign && !b.sign);
+    return a_lt_b != is_max ? a_bits : b_bits;
+}
+
+static uint32_t fp_compare(uint32_t a_bits, uint32_t b_bits, uint8_t op, const FpFormat& f, uint32_t& flags) {
+    Unpacked a = unpack(a_bits, f), b = unpack(b_bits, f);
+    if (a.nan || b.nan) {
+        bool signaling = op == VfaddOp::feq || op == VfaddOp::fne ? (a.snan || b.snan) : true;
+        if (signaling) flags |= NV;
+        return op == VfaddOp::fne;
+    }
+    bool lt = fp_lt(a, b, a_bits, b_bits, f), eq = fp_eq(a, b, a_bits, b_bits);
+    switch (op) {
+    case VfaddOp::feq: return eq;
+    case VfaddOp::fne: return !eq;
+    case VfaddOp::flt: return lt;
+    case VfaddOp::fle: return lt || eq;
+    case VfaddOp::fgt: return !lt && !eq;
+    default:           return !lt;  // fge
+    }
+}
+
+static uint32_t fp_class(uint32_t bits, const FpFormat& f) {
+    Unpacked u = unpack(bits, f);
+    bool sub = !u.zero && (bits & (f.emax_field() << f.mbits)) == 0;
+    if (u.nan) return u.snan ? 1u << 8 : 1u << 9;
+    if (u.inf) return u.sign ? 1u << 0 : 1u << 7;
+    if (u.zero) return u.sign ? 1u << 3 : 1u << 4;
+    if (sub) return u.sign ? 1u << 2 : 1u << 5;
+    return u.sign ? 1u << 1 : 1u << 6;
+}
+
+// fp16 -> fp32, 精确
+static uint32_t widen_fp16(uint32_t h) {
+    Unpacked u = unpack(h, kFp16);
+    if (u.nan) return ((uint32_t)u.sign << 31) | 0x7f800000 | ((h & 0x3ff) << 13);
+    if (u.inf) return pack(u.sign, kFp32.emax_field(), 0, kFp32);
+    if (u.zero) return (uint32_t)u.sign << 31;
+    // sig * 2^exp 在 fp32 中一定是规格化数
+    int e_unb = msb(u.sig) + u.exp;
+    uint32_t m = (uint32_t)((u.sig << (23 - msb(u.sig))) & 0x7fffff);
+    return pack(u.sign, e_unb + kFp32.bias(), m, kFp32);
+}
+
+static uint32_t element_op(const VfaddUop& u, uint32_t a, uint32_t b, bool mask, const FpFormat& f, uint32_t& flags) {
+    const uint32_t sign_bit = 1u << (f.width() - 1);
+    switch (u.op_code) {
+    case VfaddOp::fadd:   return fp_add(a, b, false, f, u.round_mode, flags);
+    case VfaddOp::fsub:   return fp_add(a, b, true, f, u.round_mode, flags);
+    case VfaddOp::fmin:   return fp_minmax(a, b, false, f, flags);
+    case VfaddOp::fmax:   return fp_minmax(a, b, true, f, flags);
+    case VfaddOp::fmerge: return mask ? b : a;
+    case VfaddOp::fmove:  return b;
+    case VfaddOp::fsgnj:  return (a & ~sign_bit) | (b & sign_bit);
+    case VfaddOp::fsgnjn: return (a & ~sign_bit) | (~b & sign_bit);
+    case VfaddOp::fsgnjx: return a ^ (b & sign_bit);
+    case VfaddOp::fclass: return fp_class(a, f);
+    default:              return fp_compare(a, b, u.op_code, f, flags);
+    }
+}
+
+int vfadd_elements(const VfaddUop& u) {
+    return u.fp_format == FMT_FP32 ? 2 : 4;
+}
+
+void vfadd_reference(const VfaddUop& u, uint64_t& result, uint32_t& fflags) {
+    const FpFormat& f = u.fp_format == FMT_FP32 ? kFp32 : u.fp_format == FMT_FP16 ? kFp16 : kBf16;
+    const int w = f.width(), n = vfadd_elements(u);
+    const bool widen = u.fp_format == FMT_FP32 && u.res_widening;
+    result = 0;
+    fflags = 0;
+    for (int k = 0; k < (u.is_vec ? n : 1); k++) {
+        uint32_t a, b;
+        if (widen) {
+            // 结果元素 k 来自 fp16 元素 k (uop_idx = 0) 或 k + 2 (uop_idx = 1)
+            int src = k + (u.uop_idx ? 2 : 0);
+            a = u.opb_widening ? (uint32_t)(u.vs2 >> (32 * k)) : widen_fp16((uint32_t)(u.vs2 >> (16 * src)) & 0xffff);
+            b = widen_fp16((uint32_t)((u.is_frs1 ? u.frs1 : u.vs1 >> (16 * src)) & 0xffff));
+        } else {
+            a = (uint32_t)(u.vs2 >> (w * k)) & f.mask();
+            b = (uint32_t)(u.is_frs1 ? u.frs1 : u.vs1 >> (w * k)) & f.mask();
+        }
+        uint32_t flags = 0;
+        uint32_t r = element_op(u, a, b, (u.mask >> k) & 1, f, flags);
+        result |= (uint64_t)(r & f.mask()) << (w * k);
+        fflags |= flags << (5 * k);
+    }
+}
+
+const char* vfadd_op_name(uint8_t op_code) {
+    static const char* names[] = {"fadd", "fsub", "fmin", "fmax", "fmerge", "fmove", "fsgnj", "fsgnjn",
+                                  "fsgnjx", "feq", "fne", "flt", "fle", "fgt", "fge", "fclass"};
+    return op_code < 16 ? names[op_code] : "?";
+}
+
+const char* vfadd_format_name(const VfaddUop& u) {
+    if (u.fp_format == FMT_FP32 && u.res_widening) return u.opb_widening ? "fp16->32.wv" : "fp16->32.vv";
+    return u.fp_format == FMT_FP32 ? "fp32" : u.fp_format == FMT_FP16 ? "fp16" : "bf16";
+}
@@ -0,0 +1,78 @@
+#include "include/vfadd_simulator.h"
+#include <verilated.h>
+#include "VtopVfadd.h"
+
+#include <cstdio>
+
+using namespace std;
+
+VfaddSimulator::VfaddSimulator(int argc, char* argv[]) {
+    contextp_ = make_unique<VerilatedContext>();
+    contextp_->commandArgs(argc, argv);
+    top_ = make_unique<VtopVfadd>(contextp_.get());
+}
+
+VfaddSimulator::~VfaddSimulator() {
+    top_->final();
+}
+
+void VfaddSimulator::single_cycle() {
+    top_->clock = 0;
+    top_->eval();
+    contextp_->timeInc(1);
+
+    top_->clock = 1;
+    top_->eval();
+    contextp_->timeInc(1);
+    cycles_++;
+}
+
+void VfaddSimulator::reset(int n) {
+    top_->io_fire = 0;
+    top_->reset = 1;
+    for (int i = 0; i < n; i++) {
+        single_cycle();
+    }
+    top_->reset = 0;
+    top_->eval();
+}
+
+void VfaddSimulator::drive(const VfaddUop& u) {
+    top_->io_fire = 1;
+    top_->io_op_code = u.op_code;
+    top_->io_fp_format = u.fp_format;
+    top_->io_round_mode = u.round_mode;
+    top_->io_is_vec = u.is_vec;
+    top_->io_is_frs1 = u.is_frs1;
+    top_->io_res_widening = u.res_widening;
+    top_->io_opb_widening = u.opb_widening;
+    top_->io_uop_idx = u.uop_idx;
+    top_->io_mask = u.mask;
+    top_->io_vs1 = u.vs1;
+    top_->io_vs2 = u.vs2;
+    top_->io_frs1 = u.frs1;
+}
+
+bool VfaddSimulator::run(const vector<VfaddUop>& uops, vector<VfaddResult>& results) {
+    uint64_t start = cycles_;
+    size_t next = 0, finished = 0;
+    int timeout = 100; // 发射结束后等待valid_out的超时周期
+
+    while (finished < uops.size()) {
+        if (next < uops.size()) {
+            drive(uops[next++]);
+        } else {
+            top_->io_fire = 0;
+        }
+        single_cycle();
+
+        if (top_->io_valid_out) {
+            results.push_back({top_->io_result, top_->io_fflags, cycles_ - start});
+            finished++;
+        } else if (next == uops.size() && --timeout == 0) {
+            printf("Timeout waiting for valid_out (%zu of %zu finished)\n", finished, uops.size());
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef __WIDE_SIMULATOR_H__
+#define __WIDE_SIMULATOR_H__
+
+#include <cstdint>
+#include <memory>
+#include "test_case.h"
+
+#ifndef WIDE_LANES
+#define WIDE_LANES 8
+#endif
+
+// 前向声明Verilator相关类
+class VtopWide;
+class VerilatedContext;
+
+// ===================================================================
+// WideSimulator 类: 驱动 topWide (WIDE_LANES 个独立的 VFMA_16_32)
+//   每个周期把数据源中的下一批操作同时发射到所有 lane,
+//   一次 eval() 推进全部 lane, 摊薄每次 eval 的固定开销;
+//   某个 lane 的模式要改变时先等该 lane 排空 (S2/S3 采样实时的模式端口)
+// ===================================================================
+class WideSimulator {
+public:
+    static constexpr int kLanes = WIDE_LANES;
+
+    WideSimulator(int argc, char* argv[]);
+    ~WideSimulator();
+
+    void reset(int n);
+    // 每周期最多发射 kLanes 个操作, 按发射顺序把结果交给 sink, 返回消耗的周期数
+    uint64_t run_stream(const StreamSource& source, const StreamSink& sink);
+    uint64_t cycles() const { return cycles_; }
+    // 上一次 run_stream 中因等待 lane 排空 (模式改变) 而少发射的周期数
+    uint64_t mode_stall_cycles() const { return mode_stall_cycles_; }
+
+private:
+    void single_cycle();
+    void drive(int lane, const DutInputs& in);
+    DutOutputs sample(int lane) const;
+
+    std::unique_ptr<VerilatedContext> contextp_;
+    std::unique_ptr<VtopWide> top_;
+    uint64_t cycles_ = 0;
+    uint64_t mode_stall_cycles_ = 0;
+};
+
+#endif // __WIDE_SIMULATOR_H__
@@ -0,0 +1,54 @@
+#include "include/wide_simulator.h"
+#include "test_factory.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+  // 1. 初始化随机数生成器种子
+  srand(time(NULL));
+
+  // 2. 初始化仿真器
+  WideSimulator sim(argc, argv);
+
+  // 3. 使用 TestFactory 创建所有测试用例
+  printf("--- Creating all test cases ---\n");
+  std::vector<TestCase> tests = create_all_tests();
+  printf("--- All test cases created ---\n\n");
+
+  // 4. 每周期向所有 lane 发射测试用例, 结果按发射顺序检查; 整个流 (含模式切换处) 都必须逐位通过
+  size_t next = 0, checked = 0, failed = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  uint64_t cycles = sim.run_stream(
+      [&](DutInputs& in) {
+        if (next == tests.size()) return false;
+        in = tests[next++].dut_inputs();
+        return true;
+      },
+      [&](const DutOutputs& out) {
+        size_t i = checked++;
+        if (!tests[i].check_result(out)) {
+          printf("Failed on test case %zu.\n", i + 1);
+          failed++;
+        }
+      });
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  // 5. 打印吞吐和结果
+  printf("\n=================================\n");
+  printf("topWide: %d lanes, %zu ops in %lu cycles (%.2f ops/cycle)\n",
+         WideSimulator::kLanes, checked, cycles, cycles ? double(checked) / cycles : 0.0);
+  printf("Mode changes: %lu issue cycles stalled draining a lane\n", sim.mode_stall_cycles());
+  printf("Simulated %.0f ops/s, %.0f cycles/s\n", secs > 0 ? checked / secs : 0.0,
+         secs > 0 ? cycles / secs : 0.0);
+  if (failed || checked != tests.size()) {
+    printf("      TEST FAILED! (%zu failed, %zu of %zu checked)\n", failed, checked, tests.size());
+    printf("=================================\n");
+    return 1;
+  }
+  printf("      ALL TESTS PASSED!\n");
+  printf("=================================\n");
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include "include/wide_simulator.h"
+#include "fma_stages.h"
+#include <verilated.h>
+#include "VtopWide.h"
+
+#include <cstdio>
+
+using namespace std;
+
+static_assert(sizeof(VtopWide::io_a_in) == 4 * WIDE_LANES, "WIDE_LANES does not match the generated topWide");
+
+// 设置/清除多位端口中 lane 对应的位
+template <class T>
+static inline void set_lane_bit(T& port, int lane, bool v) {
+    port = T((port & ~(T(1) << lane)) | (T(v) << lane));
+}
+
+WideSimulator::WideSimulator(int argc, char* argv[]) {
+    contextp_ = make_unique<VerilatedContext>();
+    contextp_->commandArgs(argc, argv);
+    top_ = make_unique<VtopWide>(contextp_.get());
+}
+
+WideSimulator::~WideSimulator() {
+    top_->final();
+}
+
+void WideSimulator::single_cycle() {
+    top_->clock = 0;
+    top_->eval();
+    contextp_->timeInc(1);
+
+    top_->clock = 1;
+    top_->eval();
+    contextp_->timeInc(1);
+    cycles_++;
+}
+
+void WideSimulator::reset(int n) {
+    top_->reset = 1;
+    for (int i = 0; i < n; i++) {
+        single_cycle();
+    }
+    top_->reset = 0;
+    top_->eval();
+}
+
+void WideSimulator::drive(int lane, const DutInputs& in) {
+    FmaMode mode;
+    uint32_t a, b, c;
+    fma_core_inputs(in, mode, a, b, c);
+
+    set_lane_bit(top_->io_valid_in, lane, true);
+    set_lane_bit(top_->io_is_fp32, lane, mode.is_fp32);
+    set_lane_bit(top_->io_is_fp16, lane, mode.is_fp16);
+    set_lane_bit(top_->io_is_bf16, lane, mode.is_bf16);
+    set_lane_bit(top_->io_is_widen, lane, mode.is_widen);
+    top_->io_a_in[lane] = a;
+    top_->io_b_in[lane] = b;
+    top_->io_c_in[lane] = c;
+}
+
+static bool same_mode(const FmaMode& x, const FmaMode& y) {
+    return x.is_fp32 == y.is_fp32 && x.is_fp16 == y.is_fp16 && x.is_bf16 == y.is_bf16 && x.is_widen == y.is_widen;
+}
+
+DutOutputs WideSimulator::sample(int lane) const {
+    uint32_t res = top_->io_res_out[lane];
+    return DutOutputs{res, uint16_t(res), uint16_t(res >> 16)};
+}
+
+uint64_t WideSimulator::run_stream(const StreamSource& source, const StreamSink& sink) {
+    reset(2);
+    uint64_t start = cycles_;
+    uint64_t issued = 0, retired = 0;
+    bool has_more = true;
+    int timeout = 100; // 发射结束后等待valid_out的超时周期
+
+    // VFMA 的 S2/S3 在下一级直接采样 io 模式端口, 某个 lane 上还有操作在飞时不能改变该 lane 的模式:
+    // 模式不同的下一个操作留在 pending 中, 本周期其余 lane 不再发射 (保持发射顺序), 等该 lane 排空
+    int inflight[kLanes] = {};
+    FmaMode lane_mode[kLanes] = {};
+    DutInputs in;
+    bool pending = false;
+    mode_stall_cycles_ = 0;
+    while (has_more || retired < issued) {
+        // 空闲的 lane 只拉低 valid_in, 模式信号保持不变
+        top_->io_valid_in = 0;
+        for (int lane = 0; lane < kLanes && has_more; lane++) {
+            if (!pending && !source(in)) {
+                has_more = false;
+                break;
+            }
+            pending = true;
+            FmaMode mode;
+            uint32_t a, b, c;
+            fma_core_inputs(in, mode, a, b, c);
+            if (inflight[lane] && !same_mode(mode, lane_mode[lane])) {
+                mode_stall_cycles_++;
+                break;
+            }
+            drive(lane, in);
+            lane_mode[lane] = mode;
+            inflight[lane]++;
+            pending = false;
+            issued++;
+        }
+        single_cycle();
+
+        // 各 lane 延迟相同, 按 lane 顺序取结果即为发射顺序
+        uint32_t valid_out = top_->io_valid_out;
+        if (valid_out) {
+            for (int lane = 0; lane < kLanes; lane++) {
+                if ((valid_out >> lane) & 1) {
+                    sink(sample(lane));
+                    inflight[lane]--;
+                    retired++;
+                }
+            }
+        } else if (!has_more && --timeout == 0) {
+            printf("Timeout waiting for valid_out (%lu of %lu retired)\n", retired, issued);
+            break;
+        }
+    }
+    return cycles_ - start;
+}
@@ -0,0 +1,71 @@
+// libFuzzer 入口: 以覆盖率为引导生成FMA操作数
+//   make fuzz  (需要 clang, 见 Makefile)
+#include "simulator.h"
+#include "fuzz_input.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// 整个模糊测试过程共用一个DUT, 只在初始化时复位一次,
+// 这样流水线寄存器中残留的状态也能参与测试
+static Simulator* sim = nullptr;
+
+#if VM_COVERAGE
+// Verilator --coverage 的行/翻转计数器作为 libFuzzer 的额外反馈
+// 每次输入后把各计数器的增量(饱和到255)写入额外计数器, libFuzzer 在每次运行前清零
+// 每个输入都要读, 因此直接读内存中的计数器数组 (导出到文件的 coverage_counters 比仿真一个操作还慢)
+static constexpr size_t kExtraCounters = 1 << 16;
+__attribute__((used, section("__libfuzzer_extra_counters")))
+static uint8_t extra_counters[kExtraCounters];
+static std::vector<uint32_t> last_cov;
+
+static void snapshot_coverage() {
+    size_t n;
+    const uint32_t* cov = sim->coverage_array(n);
+    last_cov.assign(cov, cov + n);
+}
+
+static void update_extra_counters() {
+    size_t n;
+    const uint32_t* cov = sim->coverage_array(n);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t delta = cov[i] - last_cov[i];
+        if (delta) {
+            uint8_t& c = extra_counters[i % kExtraCounters];
+            c = delta > 255 ? 255 : (delta > c ? delta : c);
+            last_cov[i] = cov[i];
+        }
+    }
+}
+#endif
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    sim = new Simulator(*argc, *argv);
+    sim->reset(2);
+#if VM_COVERAGE
+    snapshot_coverage();
+#endif
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    TestCase test = decode_fuzz_input(data, size);
+
+    DutOutputs dut_res;
+    bool done = sim->run_op(test.dut_inputs(), dut_res);
+#if VM_COVERAGE
+    update_extra_counters();
+#endif
+
+    if (!done) {
+        test.print_details();
+        printf("Timeout waiting for valid_out\n");
+        abort();
+    }
+    // check_result 在失败时已打印诊断信息
+    if (!test.check_result(dut_res)) {
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+// 分层编译 (make hier / hier_vfadd) 的辅助工具, 两种用法:
+//
+// 1. 依赖: hier_deps --vdir=DIR --top=NAME --blocks="A B ..." --var=PREFIX (逗号或空格分隔)
+//    读取分模块生成的 DIR/<模块>.v (每个文件一个 module), 重建例化树, 向标准输出写 make 片段:
+//      PREFIX_BLOCKS      作为独立库编译的 Verilog 模块 (Chisel 类名 A 匹配模块 A 和 A_<n>)
+//      PREFIX_SRCS_<块>   该块子树的全部 .v (块的库只依赖这些文件)
+//      PREFIX_TOP_VSRCS   从顶层出发、不进入块就能到达的模块 (顶层编译时块由库的包装模块代替)
+//    块之间不能嵌套; 顶层中找不到的类名只给出提示 (HIER_BLOCKS 由多个顶层共用). 错误写到标准错误
+//
+// 2. 报告: hier_deps --report=DIR --since=UNIX_TIME
+//    DIR/*.time 每个文件一行 "<名字> <Verilog 模块数> <耗时秒> <结束时间>", 由 Makefile 在每次
+//    编译一个块 (或顶层) 后写入. 结束时间不早于 --since 的为本次重新编译, 其余为复用的库
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct VModule {
+    string file;
+    vector<string> children; // 例化的模块 (去重)
+};
+
+static vector<string> list_dir(const string& dir, const string& suffix) {
+    vector<string> names;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return names;
+    while (dirent* e = readdir(d)) {
+        const string n = e->d_name;
+        if (n.size() > suffix.size() && n.compare(n.size() - suffix.size(), suffix.size(), suffix) == 0)
+            names.push_back(n);
+    }
+    closedir(d);
+    sort(names.begin(), names.end());
+    return names;
+}
+
+static bool load_modules(const string& dir, map<string, VModule>& mods) {
+    static const regex mod_re("^\\s*module\\s+(\\w+)");
+    static const regex inst_re("^\\s*(\\w+)\\s+(\\w+)\\s*\\(");
+    // 形如 "Name inst (" 的行, 读完全部文件后只保留 Name 为模块的
+    vector<pair<string, string>> insts;
+    for (const string& name : list_dir(dir, ".v")) {
+        ifstream f(dir + "/" + name);
+        string line, cur;
+        while (getline(f, line)) {
+            smatch m;
+            if (regex_search(line, m, mod_re)) {
+                cur = m[1].str();
+                mods[cur].file = dir + "/" + name;
+            } else if (!cur.empty() && line.find("endmodule") != string::npos) {
+                cur.clear();
+            } else if (!cur.empty() && regex_search(line, m, inst_re)) {
+                insts.emplace_back(cur, m[1].str());
+            }
+        }
+    }
+    for (const auto& [parent, child] : insts) {
+        auto& c = mods[parent].children;
+        if (mods.count(child) && find(c.begin(), c.end(), child) == c.end()) c.push_back(child);
+    }
+    if (mods.empty()) {
+        fprintf(stderr, "ERROR: no modules in %s\n", dir.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Chisel 对同一个类的不同参数化生成 Foo, Foo_1, Foo_2 ...
+static bool is_instance_of(const string& vname, const string& cls) {
+    if (vname == cls) return true;
+    if (vname.size() <= cls.size() + 1 || vname.compare(0, cls.size(), cls) != 0 || vname[cls.size()] != '_')
+        return false;
+    return all_of(vname.begin() + cls.size() + 1, vname.end(), [](char c) { return isdigit((unsigned char)c); });
+}
+
+// 从 name 出发收集子树, 遇到 stop 中的模块时不进入 (也不收集)
+static void collect(const map<string, VModule>& mods, const string& name, const set<string>& stop,
+                    set<string>& out) {
+    if (!out.insert(name).second) return;
+    for (const string& c : mods.at(name).children) {
+        if (!stop.count(c)) collect(mods, c, stop, out);
+    }
+}
+
+static void print_files(const map<string, VModule>& mods, const string& var, const set<string>& names) {
+    printf("%s =", var.c_str());
+    for (const string& n : names) printf(" \\\n\t%s", mods.at(n).file.c_str());
+    printf("\n");
+}
+
+static int emit_deps(const string& dir, const string& top, const string& blocks_arg, const string& var) {
+    map<string, VModule> mods;
+    if (!load_modules(dir, mods)) return 1;
+    if (!mods.count(top)) {
+        fprintf(stderr, "ERROR: top module %s not found in %s\n", top.c_str(), dir.c_str());
+        return 1;
+    }
+
+    // 只考虑从顶层可达的模块
+    set<string> reachable;
+    collect(mods, top, {}, reachable);
+    set<string> blocks;
+    string list = blocks_arg;
+    replace(list.begin(), list.end(), ',', ' ');
+    stringstream ss(list);
+    string cls;
+    while (ss >> cls) {
+        size_t found = 0;
+        for (const string& v : reachable) {
+            if (v != top && is_instance_of(v, cls)) {
+                blocks.insert(v);
+                found++;
+            }
+        }
+        if (!found) fprintf(stderr, "hier_deps: note: no module of class %s under %s\n", cls.c_str(), top.c_str());
+    }
+
+    map<string, set<string>> subtree;
+    for (const string& b : blocks) {
+        collect(mods, b, {}, subtree[b]);
+        for (const string& m : subtree[b]) {
+            if (m != b && blocks.count(m)) {
+                fprintf(stderr, "ERROR: hierarchical block %s contains block %s; blocks must not nest\n", b.c_str(),
+                        m.c_str());
+                return 1;
+            }
+        }
+    }
+    set<string> top_mods;
+    collect(mods, top, blocks, top_mods);
+
+    printf("# generated by hier_deps from %s (top %s)\n", dir.c_str(), top.c_str());
+    printf("%s_BLOCKS =", var.c_str());
+    for (const string& b : blocks) printf(" %s", b.c_str());
+    printf("\n");
+    print_files(mods, var + "_TOP_VSRCS", top_mods);
+    for (const auto& [b, names] : subtree) print_files(mods, var + "_SRCS_" + b, names);
+    return 0;
+}
+
+struct TimeRecord {
+    string name;
+    int modules = 0;
+    double secs = 0;
+    double end = 0;
+};
+
+static int report(const string& dir, double since) {
+    vector<TimeRecord> recs;
+    for (const string& n : list_dir(dir, ".time")) {
+        ifstream f(dir + "/" + n);
+        TimeRecord r;
+        if (f >> r.name >> r.modules >> r.secs >> r.end) recs.push_back(r);
+    }
+    if (recs.empty()) {
+        printf("ERROR: no compile times in %s\n", dir.c_str());
+        return 1;
+    }
+    // 重新编译的在前, 各自按耗时从大到小
+    stable_sort(recs.begin(), recs.end(), [&](const TimeRecord& a, const TimeRecord& b) {
+        const bool ra = a.end >= since, rb = b.end >= since;
+        if (ra != rb) return ra;
+        return a.secs > b.secs;
+    });
+
+    double built = 0, reused = 0;
+    size_t nbuilt = 0;
+    printf("\n=== Hierarchical build: compile time per block ===\n");
+    printf("%-44s %8s %10s  %s\n", "block", "modules", "seconds", "this build");
+    for (const TimeRecord& r : recs) {
+        const bool fresh = r.end >= since;
+        printf("%-44s %8d %10.1f  %s\n", r.name.c_str(), r.modules, r.secs, fresh ? "rebuilt" : "reused");
+        if (fresh) {
+            built += r.secs;
+            nbuilt++;
+        } else {
+            reused += r.secs;
+        }
+    }
+    printf("Rebuilt %zu of %zu: %.1f s; reusing the rest saved about %.1f s (their last compile time)\n", nbuilt,
+           recs.size(), built, reused);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    string vdir, top, blocks, var = "HIER", report_dir;
+    double since = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        if (!strncmp(a, "--vdir=", 7)) vdir = a + 7;
+        else if (!strncmp(a, "--top=", 6)) top = a + 6;
+        else if (!strncmp(a, "--blocks=", 9)) blocks = a + 9;
+        else if (!strncmp(a, "--var=", 6)) var = a + 6;
+        else if (!strncmp(a, "--report=", 9)) report_dir = a + 9;
+        else if (!strncmp(a, "--since=", 8)) since = atof(a + 8);
+        else {
+            printf("ERROR: unknown option %s\n", a);
+            return 2;
+        }
+    }
+    if (!report_dir.empty()) return report(report_dir, since);
+    if (vdir.empty() || top.empty()) {
+        printf("usage: hier_deps --vdir=DIR --top=NAME [--blocks=\"A B ...\"] [--var=PREFIX]\n"
+               "       hier_deps --report=DIR --since=UNIX_TIME\n");
+        return 2;
+    }
+    return emit_deps(vdir, top, blocks, var);
+}
@@ -0,0 +1,324 @@
+// 仿真开销报告: 把 gprof / perf 的函数级采样归属到 Chisel 模块层次
+//
+// Verilator --prof-cfuncs 生成的函数名带有来源语句的模块和行号 (..._PROF__<module>__l<line>),
+// 行号指向 Chisel 生成的单个 .v 文件. 本工具读取该 .v 文件, 按 module ... endmodule 的行范围
+// 确定每条语句所在的 Verilog 模块, 去掉 Chisel 去重时加的 _<n> 后缀得到 Chisel 类名,
+// 再按 .v 中的例化关系建立实例层次, 输出按自身开销排序的表和带累计开销的层次树
+//
+// 用法: prof_report --verilog=top.v --top=top [--gprof=gprof.txt] [--perf=perf.txt] [--limit=N]
+//   gprof.txt: gprof -b -p 的 flat profile;  perf.txt: perf report --stdio --no-children -g none --sort symbol
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+// ===================================================================
+// Verilog 模块和例化关系
+// ===================================================================
+
+struct VModule {
+    string name;
+    size_t first_line = 0, last_line = 0;
+    vector<pair<string, string>> children; // (模块名, 实例名)
+};
+
+struct Design {
+    map<string, VModule> modules;
+    vector<const VModule*> by_line; // 按行号查找所在模块
+
+    const VModule* module_at(size_t line) const {
+        for (const VModule* m : by_line) {
+            if (line >= m->first_line && line <= m->last_line) return m;
+        }
+        return nullptr;
+    }
+
+    // Chisel 对同一个类的不同参数化生成 Foo, Foo_1, Foo_2 ...; 只在去掉后缀的名字也是模块时才去掉
+    string chisel_class(const string& vname) const {
+        static const regex suffix("^(.*)_[0-9]+$");
+        smatch m;
+        if (regex_match(vname, m, suffix) && modules.count(m[1].str())) return m[1].str();
+        return vname;
+    }
+};
+
+static bool load_design(const string& path, Design& d) {
+    ifstream f(path);
+    if (!f) {
+        printf("ERROR: cannot open %s\n", path.c_str());
+        return false;
+    }
+    static const regex mod_re("^\\s*module\\s+(\\w+)");
+    static const regex inst_re("^\\s*(\\w+)\\s+(\\w+)\\s*\\(");
+    string line, cur;
+    size_t lineno = 0;
+    // 形如 "Name inst (" 的行, 读完全部模块后只保留 Name 为模块的 (父模块, 子模块, 实例名)
+    vector<tuple<string, string, string>> insts;
+    while (getline(f, line)) {
+        lineno++;
+        smatch m;
+        if (regex_search(line, m, mod_re)) {
+            cur = m[1].str();
+            d.modules[cur].name = cur;
+            d.modules[cur].first_line = lineno;
+        } else if (!cur.empty() && line.find("endmodule") != string::npos) {
+            d.modules[cur].last_line = lineno;
+            cur.clear();
+        } else if (!cur.empty() && regex_search(line, m, inst_re)) {
+            insts.emplace_back(cur, m[1].str(), m[2].str());
+        }
+    }
+    for (const auto& [parent, child, inst] : insts) {
+        if (d.modules.count(child)) d.modules[parent].children.emplace_back(child, inst);
+    }
+    for (const auto& [name, m] : d.modules) d.by_line.push_back(&m);
+    if (d.modules.empty()) {
+        printf("ERROR: no modules in %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ===================================================================
+// 采样: 函数名 -> 开销 (gprof 为秒, perf 为百分比)
+// ===================================================================
+
+struct Sample {
+    string func;
+    double cost;
+};
+
+// gprof flat profile: "%time cumulative self [calls self/call total/call] name"
+static bool load_gprof(const string& path, vector<Sample>& out) {
+    ifstream f(path);
+    if (!f) {
+        printf("ERROR: cannot open %s\n", path.c_str());
+        return false;
+    }
+    string line;
+    bool in_table = false;
+    while (getline(f, line)) {
+        if (line.find("cumulative") != string::npos && line.find("self") != string::npos) {
+            in_table = true;
+            getline(f, line); // 第二行表头
+            continue;
+        }
+        if (!in_table) continue;
+        if (line.find_first_not_of(" \t") == string::npos) break;
+        istringstream ls(line);
+        double pct, cum, self;
+        if (!(ls >> pct >> cum >> self)) continue;
+        // 可选的 calls, self/call, total/call 三列, 其后都是函数名 (C++ 名字中可能有空格)
+        string rest, tok;
+        getline(ls, rest);
+        istringstream rs(rest);
+        size_t pos = 0;
+        for (int i = 0; i < 3 && rs >> tok && strspn(tok.c_str(), "0123456789.") == tok.size(); ++i) {
+            pos = rest.find(tok, pos) + tok.size();
+        }
+        string name = rest.substr(pos);
+        name.erase(0, name.find_first_not_of(" \t"));
+        if (!name.empty()) out.push_back({name, self});
+    }
+    return true;
+}
+
+// perf report --stdio: "  12.34%  [.] name" (可能还有 command / dso 列)
+static bool load_perf(const string& path, vector<Sample>& out) {
+    ifstream f(path);
+    if (!f) {
+        printf("ERROR: cannot open %s\n", path.c_str());
+        return false;
+    }
+    string line;
+    while (getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        double pct;
+        if (sscanf(line.c_str(), " %lf%%", &pct) != 1) continue;
+        size_t sym = line.find("] ");
+        if (sym == string::npos) continue;
+        out.push_back({line.substr(sym + 2), pct});
+    }
+    return true;
+}
+
+// ===================================================================
+// 归属和报告
+// ===================================================================
+
+struct ModuleCost {
+    double self = 0;
+    size_t funcs = 0;
+    size_t instances = 0;
+    double incl = 0;
+};
+
+struct Report {
+    map<string, ModuleCost> by_class;  // Chisel 类名 -> 开销
+    map<string, double> by_vmodule;    // Verilog 模块名 -> 自身开销
+    double model_glue = 0;             // 模型中没有行号的函数 (eval 调度, 端口拷贝)
+    double outside = 0;                // 测试平台, Verilator 运行库, libc
+    double total = 0;
+};
+
+static void attribute(const Design& d, const vector<Sample>& samples, const string& top, Report& r) {
+    static const regex prof_re("__PROF__(\\w+?)__l([0-9]+)");
+    const string model_prefix = "V" + top;
+    for (const Sample& s : samples) {
+        r.total += s.cost;
+        smatch m;
+        if (regex_search(s.func, m, prof_re)) {
+            // 优先按行号定位 (内联后函数名中的模块可能是外层模块), 行号不在 .v 范围内时用函数名中的模块
+            const VModule* vm = d.module_at(strtoull(m[2].str().c_str(), nullptr, 10));
+            string vname = vm ? vm->name : m[1].str();
+            r.by_vmodule[vname] += s.cost;
+            ModuleCost& c = r.by_class[d.chisel_class(vname)];
+            c.self += s.cost;
+            c.funcs++;
+        } else if (s.func.find(model_prefix) != string::npos) {
+            r.model_glue += s.cost;
+        } else {
+            r.outside += s.cost;
+        }
+    }
+}
+
+// 实例层次: 每个实例分得其 Verilog 模块自身开销的 1/实例数 (同一模块的代码无法区分实例)
+struct Node {
+    string vmodule, inst;
+    double self = 0, incl = 0;
+    vector<Node> children;
+};
+
+static void count_instances(const Design& d, const string& vname, map<string, size_t>& n) {
+    n[vname]++;
+    for (const auto& [child, inst] : d.modules.at(vname).children) count_instances(d, child, n);
+}
+
+static Node build_tree(const Design& d, const Report& r, const map<string, size_t>& n, const string& vname,
+                       const string& inst) {
+    Node node;
+    node.vmodule = vname;
+    node.inst = inst;
+    auto it = r.by_vmodule.find(vname);
+    node.self = it == r.by_vmodule.end() ? 0 : it->second / n.at(vname);
+    node.incl = node.self;
+    for (const auto& [child, cinst] : d.modules.at(vname).children) {
+        node.children.push_back(build_tree(d, r, n, child, cinst));
+        node.incl += node.children.back().incl;
+    }
+    return node;
+}
+
+static void print_tree(const Design& d, const Node& node, double total, int depth, int max_depth, double min_pct) {
+    const double pct = total > 0 ? 100.0 * node.incl / total : 0.0;
+    if (depth > 0 && pct < min_pct) return;
+    string label = string(2 * depth, ' ') + d.chisel_class(node.vmodule) + (node.inst.empty() ? "" : " " + node.inst);
+    printf("  %-56s %7.2f%% %7.2f%%\n", label.c_str(), pct, total > 0 ? 100.0 * node.self / total : 0.0);
+    if (depth >= max_depth) return;
+    vector<const Node*> kids;
+    for (const Node& c : node.children) kids.push_back(&c);
+    stable_sort(kids.begin(), kids.end(), [](const Node* a, const Node* b) { return a->incl > b->incl; });
+    for (const Node* c : kids) print_tree(d, *c, total, depth + 1, max_depth, min_pct);
+}
+
+static void report(const Design& d, const string& top, const string& source, const vector<Sample>& samples,
+                   size_t limit) {
+    Report r;
+    attribute(d, samples, top, r);
+    if (!d.modules.count(top)) {
+        printf("ERROR: top module %s not found in the Verilog\n", top.c_str());
+        return;
+    }
+    map<string, size_t> n;
+    count_instances(d, top, n);
+    Node root = build_tree(d, r, n, top, "");
+
+    // 每个 Chisel 类的实例数和累计开销 (各实例子树之和)
+    for (const auto& [vname, cnt] : n) r.by_class[d.chisel_class(vname)].instances += cnt;
+    vector<const Node*> stack = {&root};
+    while (!stack.empty()) {
+        const Node* x = stack.back();
+        stack.pop_back();
+        r.by_class[d.chisel_class(x->vmodule)].incl += x->incl;
+        for (const Node& c : x->children) stack.push_back(&c);
+    }
+
+    const double attributed = r.total - r.model_glue - r.outside;
+    const char* unit = source == "gprof" ? "s" : "%";
+    printf("\n=== Simulation cost of %s by Chisel module (%s, %.2f%s sampled) ===\n", top.c_str(), source.c_str(),
+           r.total, unit);
+    if (r.total <= 0) {
+        printf("No samples.\n");
+        return;
+    }
+    if (attributed <= 0) {
+        printf("No __PROF__ functions in the profile: was the model built with --prof-cfuncs (make prof*)?\n");
+    }
+
+    vector<pair<string, ModuleCost>> rows(r.by_class.begin(), r.by_class.end());
+    stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.second.self > b.second.self; });
+    const string self_col = string("self ") + unit;
+    printf("%4s  %-40s %5s %8s %8s %10s %6s\n", "rank", "module", "inst", "self", "incl", self_col.c_str(), "funcs");
+    size_t rank = 0;
+    for (const auto& [name, c] : rows) {
+        if (c.self <= 0 && c.incl <= 0) continue;
+        if (++rank > limit) break;
+        printf("%4zu  %-40s %5zu %7.2f%% %7.2f%% %10.3f %6zu\n", rank, name.c_str(), c.instances,
+               100.0 * c.self / r.total, 100.0 * c.incl / r.total, c.self, c.funcs);
+    }
+    printf("      %-40s %5s %7.2f%%\n", "(model glue: eval, port copies)", "", 100.0 * r.model_glue / r.total);
+    printf("      %-40s %5s %7.2f%%\n", "(harness, Verilator runtime, libc)", "", 100.0 * r.outside / r.total);
+
+    printf("Hierarchy (inclusive, self; instances of one module share its cost equally, below 0.5%% omitted):\n");
+    print_tree(d, root, r.total, 0, 8, 0.5);
+}
+
+int main(int argc, char* argv[]) {
+    string verilog, top, gprof, perf;
+    size_t limit = 30;
+    for (int i = 1; i < argc; ++i) {
+        if (!strncmp(argv[i], "--verilog=", 10)) {
+            verilog = argv[i] + 10;
+        } else if (!strncmp(argv[i], "--top=", 6)) {
+            top = argv[i] + 6;
+        } else if (!strncmp(argv[i], "--gprof=", 8)) {
+            gprof = argv[i] + 8;
+        } else if (!strncmp(argv[i], "--perf=", 7)) {
+            perf = argv[i] + 7;
+        } else if (!strncmp(argv[i], "--limit=", 8)) {
+            limit = strtoul(argv[i] + 8, nullptr, 0);
+        } else {
+            printf("ERROR: unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (verilog.empty() || top.empty() || (gprof.empty() && perf.empty())) {
+        printf("usage: prof_report --verilog=top.v --top=NAME [--gprof=gprof.txt] [--perf=perf.txt] [--limit=N]\n");
+        return 2;
+    }
+
+    Design d;
+    if (!load_design(verilog, d)) return 1;
+    if (!gprof.empty()) {
+        vector<Sample> s;
+        if (!load_gprof(gprof, s)) return 1;
+        report(d, top, "gprof", s, limit);
+    }
+    if (!perf.empty()) {
+        vector<Sample> s;
+        if (!load_perf(perf, s)) return 1;
+        report(d, top, "perf", s, limit);
+    }
+    return 0;
+}